@@ -0,0 +1,23 @@
+// Runs the microbenchmarks of the core, see m2uCoreBench.h
+//
+// m2uCoreBench [Scale] [Filter]
+// Scale multiplies the iterations of every benchmark, 1 takes a few seconds.
+
+#include <cstdlib>
+#include <cstring>
+
+#include "m2uCoreBench.h"
+
+int main( int argc, char** argv )
+{
+	const double Scale = argc > 1 ? std::atof(argv[1]) : 1.0;
+	const char* Filter = argc > 2 ? argv[2] : NULL;
+	for( const Fm2uBenchCase& Benchmark : m2uBench::GetBenchmarks() )
+	{
+		if( Filter != NULL && std::strstr(Benchmark.Name, Filter) == NULL )
+			continue;
+		int64_t Iterations = (int64_t)(1000000 * Scale);
+		Benchmark.Function(Iterations > 0 ? Iterations : 1);
+	}
+	return 0;
+}
@@ -0,0 +1,96 @@
+#pragma once
+// A minimal harness for the microbenchmarks of the core
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+   M2U_BENCHMARK(Name) { ... } defines a benchmark that gets the number of
+   Iterations it should do. It times itself with Fm2uBenchTimer and reports
+   what it measured with m2uBench::Report. m2uCoreBench.cpp runs all of them.
+ */
+typedef void (*Fm2uBenchFunction)( int64_t Iterations );
+
+struct Fm2uBenchCase
+{
+	const char* Name;
+	Fm2uBenchFunction Function;
+};
+
+class Fm2uBenchTimer
+{
+public:
+
+	Fm2uBenchTimer()
+		:StartTime(std::chrono::steady_clock::now())
+	{}
+
+	double GetSeconds() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	}
+
+private:
+
+	std::chrono::steady_clock::time_point StartTime;
+};
+
+namespace m2uBench
+{
+	inline std::vector<Fm2uBenchCase>& GetBenchmarks()
+	{
+		static std::vector<Fm2uBenchCase> Benchmarks;
+		return Benchmarks;
+	}
+
+	/**
+	 * Results are added to this, so the compiler can't drop the work that
+	 * produced them.
+	 */
+	inline volatile uint64_t& GetSink()
+	{
+		static volatile uint64_t Sink = 0;
+		return Sink;
+	}
+
+	inline void Consume( uint64_t Value )
+	{
+		GetSink() = GetSink() + Value;
+	}
+
+	/** print one line: what was measured, the time per operation, and the throughput */
+	inline void Report( const char* Name, int64_t NumOperations, double Seconds, int64_t NumBytes = 0 )
+	{
+		const double Ns = NumOperations > 0 ? Seconds * 1e9 / NumOperations : 0.0;
+		if( NumBytes > 0 )
+		{
+			std::printf("%-44s %10.1f ns/op %10.1f MB/s\n", Name, Ns, Seconds > 0.0 ? NumBytes / Seconds / 1e6 : 0.0);
+		}
+		else
+		{
+			std::printf("%-44s %10.1f ns/op %10.2f Mops/s\n", Name, Ns, Seconds > 0.0 ? NumOperations / Seconds / 1e6 : 0.0);
+		}
+	}
+
+	/** the UTF-16 text TCHARs hold in the editor */
+	inline std::u16string Widen( const std::string& Str )
+	{
+		return std::u16string(Str.begin(), Str.end());
+	}
+
+	struct FRegistrar
+	{
+		FRegistrar( const char* Name, Fm2uBenchFunction Function )
+		{
+			GetBenchmarks().push_back(Fm2uBenchCase{Name, Function});
+		}
+	};
+}
+
+#define M2U_BENCHMARK(Name) \
+	static void m2uBench_##Name( int64_t Iterations ); \
+	static m2uBench::FRegistrar m2uBenchRegistrar_##Name(#Name, &m2uBench_##Name); \
+	static void m2uBench_##Name( int64_t Iterations )
@@ -0,0 +1,510 @@
+// Benchmarks of the command text parsing and dispatch
+
+#include <cstdlib>
+#include <random>
+
+#include "m2uCoreActorRecords.h"
+#include "m2uCoreBench.h"
+#include "m2uCoreFraming.h"
+#include "m2uCoreKeywordTable.h"
+#include "m2uCoreParse.h"
+#include "m2uCoreTokenizer.h"
+
+#if M2U_TOKENIZER_SIMD >= 2
+	#define M2U_BENCH_SIMD_NAME "AVX2"
+#elif M2U_TOKENIZER_SIMD >= 1
+	#define M2U_BENCH_SIMD_NAME "SSE2"
+#else
+	#define M2U_BENCH_SIMD_NAME "no SIMD"
+#endif
+
+namespace
+{
+	// the keywords of the built-in operations
+	const char* const Keywords[] = {
+		"ExportAsset", "ImportAssets", "ImportAssetsBatch", "TransformCamera", "Exec",
+		"FetchSelected", "HelloWorld", "AddObjectsToLayer", "RemoveObjectsFromAllLayers",
+		"HideLayer", "UnhideLayer", "DeleteLayer", "RenameLayer", "TransformObject",
+		"GetActorHandles", "GetFreeName", "RenameObject", "DeleteSelected", "DeleteObject",
+		"DuplicateObject", "AddActor", "AddActorBatch", "ParentChildTo", "SelectByNames",
+		"DeselectAll", "DeselectByNames", "GetStats", "ResetStats", "Undo", "Redo",
+		"HideSelected", "UnhideSelected", "IsolateSelected", "UnhideAll", "HideByNames"
+	};
+	const int32_t NumKeywords = sizeof(Keywords) / sizeof(Keywords[0]);
+
+	std::u16string MakeTransformCommand( int32_t Idx )
+	{
+		char Buffer[160];
+		std::snprintf(Buffer, sizeof(Buffer), "TransformObject Actor_%d T=(%d.125 -%d.5 %d.75) R=(0.0 %d.25 -90.0) S=(1.0 1.0 %d.5)",
+			Idx, Idx, Idx * 3, Idx % 100, Idx % 360, Idx % 4 + 1);
+		return m2uBench::Widen(Buffer);
+	}
+}
+
+
+M2U_BENCHMARK(Dispatch)
+{
+	std::vector<std::u16string> Commands;
+	for( int32_t Idx = 0; Idx < NumKeywords; ++Idx )
+	{
+		Commands.push_back(m2uBench::Widen(std::string(Keywords[Idx]) + " Actor_1 T=(0 0 0)"));
+	}
+	Commands.push_back(m2uBench::Widen("m2uUnknownCommand Actor_1"));
+	const int64_t Rounds = Iterations / (int64_t)Commands.size() + 1;
+	const int64_t NumOperations = Rounds * (int64_t)Commands.size();
+
+	// every keyword compared one after the other, as the operations did
+	Fm2uBenchTimer LinearTimer;
+	uint64_t Found = 0;
+	for( int64_t Round = 0; Round < Rounds; ++Round )
+	{
+		for( const std::u16string& Cmd : Commands )
+		{
+			for( int32_t Idx = 0; Idx < NumKeywords; ++Idx )
+			{
+				const char16_t* Str = Cmd.c_str();
+				if( m2uParse::Command(Str, Keywords[Idx]) )
+				{
+					Found += Idx;
+					break;
+				}
+			}
+		}
+	}
+	m2uBench::Report("Dispatch/compare keywords", NumOperations, LinearTimer.GetSeconds());
+
+	Tm2uKeywordTable<int32_t> Table;
+	for( int32_t Idx = 0; Idx < NumKeywords; ++Idx )
+	{
+		Table.Add(Keywords[Idx], Idx);
+	}
+	Fm2uBenchTimer TableTimer;
+	for( int64_t Round = 0; Round < Rounds; ++Round )
+	{
+		for( const std::u16string& Cmd : Commands )
+		{
+			const int32_t* Value = Table.Find(Cmd.c_str());
+			Found += Value != NULL ? *Value : 0;
+		}
+	}
+	m2uBench::Report("Dispatch/keyword table", NumOperations, TableTimer.GetSeconds());
+	m2uBench::Consume(Found);
+}
+
+
+M2U_BENCHMARK(Token)
+{
+	const std::u16string Cmd = m2uBench::Widen("/Game/Meshes/SM_Rock_01 Rock_01_123 \"Layer With Spaces\" EditIfExists=true T=(1 2 3)");
+	Fm2uBenchTimer Timer;
+	uint64_t Total = 0;
+	for( int64_t Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		const char16_t* Str = Cmd.c_str();
+		Tm2uTextView<char16_t> Token;
+		while( m2uParse::Token(Str, Token) )
+		{
+			Total += Token.Len;
+		}
+	}
+	m2uBench::Report("Token/all tokens of an AddActor", Iterations, Timer.GetSeconds(), Iterations * (int64_t)Cmd.size() * 2);
+	m2uBench::Consume(Total);
+}
+
+
+namespace
+{
+	/** the transform parsing before the token table: a search for every part */
+	void ParseTransformBySearching( const char16_t* Str, Fm2uTransformText& Out )
+	{
+		Out.Parts = 0;
+		const char16_t* Found;
+		if( (Found = m2uParse::Strfind(Str, "T=")) != NULL )
+		{
+			m2uParse::ParseFloats(Found + 3, Out.Location, 3);
+			Out.Parts |= M2U_TRANSFORM_LOCATION;
+		}
+		if( (Found = m2uParse::Strfind(Str, "R=")) != NULL )
+		{
+			m2uParse::ParseFloats(Found + 3, Out.Rotation, 3);
+			Out.Parts |= M2U_TRANSFORM_ROTATION;
+		}
+		if( (Found = m2uParse::Strfind(Str, "S=")) != NULL )
+		{
+			m2uParse::ParseFloats(Found + 3, Out.Scale, 3);
+			Out.Parts |= M2U_TRANSFORM_SCALE;
+		}
+	}
+
+	/** an AddActorBatch of Num lines */
+	std::u16string MakeAddActorBatch( int32_t Num )
+	{
+		std::string Batch;
+		char Line[200];
+		for( int32_t Idx = 0; Idx < Num; ++Idx )
+		{
+			std::snprintf(Line, sizeof(Line), "/Game/Environment/Meshes/SM_Rock_%02d Rock_%d T=(%d.125 -%d.5 %d.75) R=(0.0 %d.25 -90.0) S=(1.0 1.0 %d.5)\n",
+				Idx % 40, Idx, Idx, Idx * 3, Idx % 100, Idx % 360, Idx % 4 + 1);
+			Batch += Line;
+		}
+		return m2uBench::Widen(Batch);
+	}
+}
+
+
+M2U_BENCHMARK(TransformText)
+{
+	std::vector<std::u16string> Commands;
+	for( int32_t Idx = 0; Idx < 1024; ++Idx )
+	{
+		Commands.push_back(MakeTransformCommand(Idx));
+	}
+	int64_t NumBytes = 0;
+	for( int64_t Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		NumBytes += (int64_t)Commands[Iteration & 1023].size() * 2;
+	}
+
+	Fm2uBenchTimer SearchTimer;
+	float Total = 0.0f;
+	for( int64_t Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		const char16_t* Str = Commands[Iteration & 1023].c_str();
+		m2uParse::Command(Str, "TransformObject");
+		Tm2uTextView<char16_t> Name;
+		m2uParse::Token(Str, Name);
+		Fm2uTransformText Transform;
+		ParseTransformBySearching(Str, Transform);
+		Total += Transform.Location[0] + Transform.Rotation[1] + Transform.Scale[2];
+	}
+	m2uBench::Report("TransformText/search T= R= S=", Iterations, SearchTimer.GetSeconds(), NumBytes);
+
+	Fm2uBenchTimer TokenTimer;
+	for( int64_t Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		const std::u16string& Cmd = Commands[Iteration & 1023];
+		Tm2uTokenTable<char16_t> Tokens;
+		Tokens.Tokenize(Cmd.c_str(), (int32_t)Cmd.size());
+		Fm2uTransformText Transform;
+		m2uParse::ParseTransform(Tokens, Transform, 2);
+		Total += Transform.Location[0] + Transform.Rotation[1] + Transform.Scale[2] + (Tokens.Num() > 1 ? Tokens.Get(1).Len : 0);
+	}
+	m2uBench::Report("TransformText/token table", Iterations, TokenTimer.GetSeconds(), NumBytes);
+	m2uBench::Consume((uint64_t)Total);
+}
+
+
+namespace
+{
+	/** the float parsing before m2uCoreFloat.h */
+	float AtofByStrtod( const char16_t* Str, const char16_t* End )
+	{
+		char Buffer[64];
+		while( Str < End && m2uParse::IsWhitespace(*Str) )
+		{
+			++Str;
+		}
+		int32_t Len = 0;
+		while( Len < (int32_t)sizeof(Buffer) - 1 && Str < End && (uint32_t)*Str < 128 && ! m2uParse::IsWhitespace(*Str) )
+		{
+			Buffer[Len++] = (char)*Str++;
+		}
+		Buffer[Len] = 0;
+		return (float)std::strtod(Buffer, NULL);
+	}
+
+	/** the numbers of "(x y z)" */
+	template<typename AtofT>
+	int32_t ParseTriplet( Tm2uTextView<char16_t> Value, float* Out, AtofT Atof )
+	{
+		const char16_t* Str = Value.Data + 1;
+		const char16_t* End = Value.Data + Value.Len - 1;
+		int32_t Num = 0;
+		while( Num < 3 && Str < End )
+		{
+			Out[Num++] = Atof(Str, End);
+			while( Str < End && *Str != ' ' )
+			{
+				++Str;
+			}
+			++Str;
+		}
+		return Num;
+	}
+
+	/**
+	 * T=, R= and S= values the way clients print them: with 6 decimals like
+	 * python's %f, or all 17 digits of the double like its repr
+	 */
+	std::u16string MakeTransformValues( std::mt19937& Random )
+	{
+		std::uniform_real_distribution<double> Location(-5000.0, 5000.0);
+		std::uniform_real_distribution<double> Rotation(-180.0, 180.0);
+		std::uniform_real_distribution<double> Scale(0.1, 4.0);
+		const char* Format = (Random() % 2) ? "%.6f" : "%.17g";
+		std::string Values;
+		char Number[32];
+		for( int32_t Part = 0; Part < 3; ++Part )
+		{
+			Values += Part == 0 ? "(" : " (";
+			for( int32_t Axis = 0; Axis < 3; ++Axis )
+			{
+				const double Value = Part == 0 ? Location(Random) : (Part == 1 ? Rotation(Random) : Scale(Random));
+				std::snprintf(Number, sizeof(Number), Format, Value);
+				Values += (Axis > 0 ? " " : "") + std::string(Number);
+			}
+			Values += ")";
+		}
+		return m2uBench::Widen(Values);
+	}
+}
+
+
+M2U_BENCHMARK(Float)
+{
+	// Iterations transforms of 9 numbers each, cycling through this many
+	// different ones so they don't all sit in the cache
+	const int32_t NumDistinct = 65536;
+	std::mt19937 Random(7);
+	std::vector<std::u16string> Corpus;
+	std::vector<Tm2uTextView<char16_t>> Triplets;
+	for( int32_t Idx = 0; Idx < NumDistinct; ++Idx )
+	{
+		Corpus.push_back(MakeTransformValues(Random));
+	}
+	for( const std::u16string& Values : Corpus )
+	{
+		Tm2uTokenTable<char16_t> Tokens;
+		Tokens.Tokenize(Values.c_str(), (int32_t)Values.size());
+		for( int32_t Idx = 0; Idx < 3; ++Idx )
+		{
+			Triplets.push_back(Tokens.Get(Idx));
+		}
+	}
+	int64_t NumBytes = 0;
+	for( int64_t Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		NumBytes += (int64_t)Corpus[Iteration % NumDistinct].size() * 2;
+	}
+
+	Fm2uBenchTimer StrtodTimer;
+	float Total = 0.0f;
+	for( int64_t Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		const int32_t First = (int32_t)(Iteration % NumDistinct) * 3;
+		float Values[9];
+		for( int32_t Part = 0; Part < 3; ++Part )
+		{
+			ParseTriplet(Triplets[First + Part], Values + Part * 3, AtofByStrtod);
+		}
+		Total += Values[0] + Values[4] + Values[8];
+	}
+	m2uBench::Report("Float/9 per transform, strtod", Iterations, StrtodTimer.GetSeconds(), NumBytes);
+
+	Fm2uBenchTimer ExactTimer;
+	for( int64_t Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		const int32_t First = (int32_t)(Iteration % NumDistinct) * 3;
+		float Values[9];
+		for( int32_t Part = 0; Part < 3; ++Part )
+		{
+			ParseTriplet(Triplets[First + Part], Values + Part * 3, m2uParse::Atof<char16_t>);
+		}
+		Total += Values[0] + Values[4] + Values[8];
+	}
+	m2uBench::Report("Float/9 per transform, m2uParse::Atof", Iterations, ExactTimer.GetSeconds(), NumBytes);
+	m2uBench::Consume((uint64_t)Total);
+}
+
+
+M2U_BENCHMARK(Tokenizer)
+{
+	const std::u16string Batch = MakeAddActorBatch(1000);
+	const int64_t Rounds = Iterations / 1000 + 1;
+	const Em2uTokenizerPath Paths[] = { Em2uTokenizerPath::Scalar, Em2uTokenizerPath::Best };
+	const char* Names[] = { "Tokenizer/AddActorBatch line, scalar", "Tokenizer/AddActorBatch line, " M2U_BENCH_SIMD_NAME };
+	for( int32_t PathIdx = 0; PathIdx < 2; ++PathIdx )
+	{
+		Fm2uBenchTimer Timer;
+		uint64_t Total = 0;
+		Tm2uTokenTable<char16_t> Tokens;
+		for( int64_t Round = 0; Round < Rounds; ++Round )
+		{
+			// every line is split where it is, like AddActorBatch does
+			const char16_t* Line = Batch.c_str();
+			const char16_t* End = Line + Batch.size();
+			while( Line < End )
+			{
+				const char16_t* LineEnd = Line;
+				while( LineEnd < End && *LineEnd != '\n' )
+				{
+					++LineEnd;
+				}
+				Tokens.Tokenize(Line, (int32_t)(LineEnd - Line), Paths[PathIdx]);
+				Total += Tokens.Num();
+				Line = LineEnd + 1;
+			}
+		}
+		m2uBench::Report(Names[PathIdx], Rounds * 1000, Timer.GetSeconds(), Rounds * (int64_t)Batch.size() * 2);
+		m2uBench::Consume(Total);
+	}
+
+	// finding the keyword of the whole batch before it is dispatched
+	const std::u16string Command = u"AddActorBatch\n" + Batch;
+	const int64_t Dispatches = Rounds / 10 + 1;
+	uint64_t Total = 0;
+	Tm2uTokenTable<char16_t> Tokens;
+	Fm2uBenchTimer AllTimer;
+	for( int64_t Round = 0; Round < Dispatches; ++Round )
+	{
+		Tokens.Tokenize(Command.c_str(), (int32_t)Command.size());
+		Total += Tokens.GetKeyword().Len;
+	}
+	m2uBench::Report("Tokenizer/1k line batch keyword, all split", Dispatches, AllTimer.GetSeconds(), Dispatches * (int64_t)Command.size() * 2);
+	Fm2uBenchTimer FirstTimer;
+	for( int64_t Round = 0; Round < Dispatches; ++Round )
+	{
+		Tokens.TokenizeFirst(Command.c_str(), (int32_t)Command.size(), 1);
+		Total += Tokens.GetKeyword().Len;
+	}
+	m2uBench::Report("Tokenizer/1k line batch keyword, first only", Dispatches, FirstTimer.GetSeconds());
+	m2uBench::Consume(Total);
+}
+
+
+M2U_BENCHMARK(ActorRecords)
+{
+	// a level push of 50k actors, as AddActorBatch lines and as binary records
+	const int32_t NumActors = 50000;
+	const std::u16string Batch = MakeAddActorBatch(NumActors);
+	Fm2uActorRecordsWriter Writer(9);
+	for( int32_t Idx = 0; Idx < NumActors; ++Idx )
+	{
+		char Asset[64];
+		std::snprintf(Asset, sizeof(Asset), "/Game/Environment/Meshes/SM_Rock_%02d", Idx % 40);
+		const float Values[9] = { Idx + 0.125f, -Idx * 3 - 0.5f, Idx % 100 + 0.75f, 0.0f, Idx % 360 + 0.25f, -90.0f, 1.0f, 1.0f, Idx % 4 + 1.5f };
+		Writer.Add(Writer.AddAsset(Asset), "Rock_" + std::to_string(Idx), Values);
+	}
+	std::vector<uint8_t> Records;
+	Writer.Write(Records);
+	const int64_t Rounds = Iterations / NumActors + 1;
+
+	Fm2uBenchTimer TextTimer;
+	float Total = 0.0f;
+	Tm2uTokenTable<char16_t> Tokens;
+	for( int64_t Round = 0; Round < Rounds; ++Round )
+	{
+		const char16_t* Line = Batch.c_str();
+		const char16_t* End = Line + Batch.size();
+		while( Line < End )
+		{
+			const char16_t* LineEnd = Line;
+			while( LineEnd < End && *LineEnd != '\n' )
+			{
+				++LineEnd;
+			}
+			Tokens.Tokenize(Line, (int32_t)(LineEnd - Line));
+			Fm2uTransformText Transform;
+			m2uParse::ParseTransform(Tokens, Transform, 2);
+			Total += Transform.Location[0] + Transform.Scale[2] + Tokens.Get(1).Len;
+			Line = LineEnd + 1;
+		}
+	}
+	m2uBench::Report("ActorRecords/50k AddActorBatch lines, per actor", Rounds * NumActors, TextTimer.GetSeconds(), Rounds * (int64_t)Batch.size() * 2);
+
+	Fm2uBenchTimer BinaryTimer;
+	std::vector<float> Values(NumActors * 9);
+	for( int64_t Round = 0; Round < Rounds; ++Round )
+	{
+		Fm2uActorRecordsReader Reader;
+		if( Reader.Init(Records.data(), (int32_t)Records.size()) != Em2uActorRecordsError::None )
+			break;
+		int32_t Offset = Reader.GetNamesOffset();
+		for( int32_t Idx = 0; Idx < Reader.GetNumRecords(); ++Idx )
+		{
+			Total += Reader.ReadString(Offset).Len + Reader.GetAssetIndex(Idx);
+		}
+		// all transforms in one go
+		Reader.GetValues(0, Reader.GetNumRecords(), Values.data());
+		Total += Values[0] + Values[NumActors * 9 - 1];
+	}
+	m2uBench::Report("ActorRecords/50k binary records, per actor", Rounds * NumActors, BinaryTimer.GetSeconds(), Rounds * (int64_t)Records.size());
+	std::printf("%-44s %10.1f MB text, %.1f MB binary\n", "ActorRecords/size", Batch.size() / 1e6, Records.size() / 1e6);
+	m2uBench::Consume((uint64_t)Total);
+}
+
+
+M2U_BENCHMARK(List)
+{
+	// a SelectByNames of 10k actors
+	std::string Names = "[";
+	for( int32_t Idx = 0; Idx < 10000; ++Idx )
+	{
+		Names += (Idx > 0 ? ",Actor_" : "Actor_") + std::to_string(Idx);
+	}
+	Names += "]";
+	const std::u16string List = m2uBench::Widen(Names);
+	const int64_t Rounds = Iterations / 10000 + 1;
+	Fm2uBenchTimer Timer;
+	uint64_t Total = 0;
+	for( int64_t Round = 0; Round < Rounds; ++Round )
+	{
+		Tm2uListParser<char16_t> Parser(List.c_str(), (int32_t)List.size());
+		Tm2uTextView<char16_t> Item;
+		while( Parser.Next(Item) )
+		{
+			Total += Item.Len;
+		}
+	}
+	m2uBench::Report("List/10k names, per name", Rounds * 10000, Timer.GetSeconds(), Rounds * (int64_t)List.size() * 2);
+
+	// copied into a name buffer, what the operations do
+	Fm2uBenchTimer CopyTimer;
+	for( int64_t Round = 0; Round < Rounds; ++Round )
+	{
+		Tm2uListParser<char16_t> Parser(List.c_str(), (int32_t)List.size());
+		char16_t Name[1024];
+		while( Parser.Next(Name, 1024) )
+		{
+			Total += Name[0];
+		}
+	}
+	m2uBench::Report("List/10k names copied, per name", Rounds * 10000, CopyTimer.GetSeconds(), Rounds * (int64_t)List.size() * 2);
+
+	// a string per name, like the old ParseList
+	Fm2uBenchTimer StringTimer;
+	for( int64_t Round = 0; Round < Rounds; ++Round )
+	{
+		std::vector<std::u16string> Strings;
+		Tm2uListParser<char16_t> Parser(List.c_str(), (int32_t)List.size());
+		Tm2uTextView<char16_t> Item;
+		while( Parser.Next(Item) )
+		{
+			Strings.emplace_back(Item.Data, Item.Len);
+		}
+		Total += Strings.size();
+	}
+	m2uBench::Report("List/10k names as strings, per name", Rounds * 10000, StringTimer.GetSeconds(), Rounds * (int64_t)List.size() * 2);
+	m2uBench::Consume(Total);
+}
+
+
+M2U_BENCHMARK(FrameHeader)
+{
+	std::vector<uint8_t> Headers(M2U_FRAME_HEADER_SIZE * 256);
+	for( int32_t Idx = 0; Idx < 256; ++Idx )
+	{
+		m2uFraming::WriteHeader(&Headers[Idx * M2U_FRAME_HEADER_SIZE], Idx * 100, Idx, Idx & M2U_FRAME_KNOWN_FLAGS);
+	}
+	Fm2uBenchTimer Timer;
+	uint64_t Total = 0;
+	for( int64_t Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		Fm2uFrameHeader Header;
+		if( m2uFraming::ReadHeader(&Headers[(Iteration & 255) * M2U_FRAME_HEADER_SIZE], Header) == Em2uFrameHeaderError::None )
+		{
+			Total += Header.PayloadLength + Header.RequestId;
+		}
+	}
+	m2uBench::Report("FrameHeader/read", Iterations, Timer.GetSeconds());
+	m2uBench::Consume(Total);
+}
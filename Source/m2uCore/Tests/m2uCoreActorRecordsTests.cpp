@@ -0,0 +1,104 @@
+// Tests of the binary actor records
+
+#include "m2uCoreActorRecords.h"
+#include "m2uCoreTest.h"
+
+namespace
+{
+	std::vector<uint8_t> MakeRecords()
+	{
+		Fm2uActorRecordsWriter Writer(9);
+		const uint32_t Rock = Writer.AddAsset("/Game/Meshes/SM_Rock");
+		const uint32_t Tree = Writer.AddAsset("/Game/Meshes/SM_Tree");
+		const float First[9] = { 1.0f, 2.0f, 3.0f, 0.0f, 90.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+		const float Second[9] = { -100.5f, 0.25f, 1e6f, 10.0f, 20.0f, 30.0f, 2.0f, 2.0f, 0.5f };
+		const float Third[9] = { 0.1f, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+		Writer.Add(Rock, "Rock_1", First);
+		Writer.Add(Tree, "Tree_1", Second);
+		Writer.Add(Writer.AddAsset("/Game/Meshes/SM_Rock"), "Rock_2", Third);
+		std::vector<uint8_t> Data;
+		Writer.Write(Data);
+		return Data;
+	}
+}
+
+
+M2U_TEST(ActorRecordsRoundTrip)
+{
+	const std::vector<uint8_t> Data = MakeRecords();
+	Fm2uActorRecordsReader Reader;
+	M2U_CHECK(Reader.Init(Data.data(), (int32_t)Data.size()) == Em2uActorRecordsError::None);
+	M2U_CHECK(Reader.GetFloatsPerRecord() == 9);
+	M2U_CHECK(Reader.GetNumAssets() == 2);
+	M2U_CHECK(Reader.GetNumRecords() == 3);
+
+	int32_t Offset = Reader.GetAssetsOffset();
+	M2U_CHECK(Reader.ReadString(Offset).Equals("/Game/Meshes/SM_Rock"));
+	M2U_CHECK(Reader.ReadString(Offset).Equals("/Game/Meshes/SM_Tree"));
+	Offset = Reader.GetNamesOffset();
+	M2U_CHECK(Reader.ReadString(Offset).Equals("Rock_1"));
+	M2U_CHECK(Reader.ReadString(Offset).Equals("Tree_1"));
+	M2U_CHECK(Reader.ReadString(Offset).Equals("Rock_2"));
+
+	M2U_CHECK(Reader.GetAssetIndex(0) == 0);
+	M2U_CHECK(Reader.GetAssetIndex(1) == 1);
+	M2U_CHECK(Reader.GetAssetIndex(2) == 0);
+
+	// floats come back bit for bit
+	float Values[27];
+	Reader.GetValues(0, 3, Values);
+	M2U_CHECK(Values[4] == 90.0f);
+	M2U_CHECK(Values[9] == -100.5f && Values[11] == 1e6f && Values[17] == 0.5f);
+	M2U_CHECK(Values[18] == 0.1f && Values[20] == 0.3f);
+	Reader.GetValues(1, 1, Values);
+	M2U_CHECK(Values[0] == -100.5f);
+}
+
+M2U_TEST(ActorRecordsKeepQuaternions)
+{
+	Fm2uActorRecordsWriter Writer(10);
+	const float Values[10] = { 1.0f, 2.0f, 3.0f, 0.0f, 0.0f, 0.70710677f, 0.70710677f, 1.0f, 1.0f, 1.0f };
+	Writer.Add(M2U_ACTOR_RECORD_NO_ASSET, "Existing_1", Values);
+	std::vector<uint8_t> Data;
+	Writer.Write(Data);
+
+	Fm2uActorRecordsReader Reader;
+	M2U_CHECK(Reader.Init(Data.data(), (int32_t)Data.size()) == Em2uActorRecordsError::None);
+	M2U_CHECK(Reader.GetFloatsPerRecord() == 10);
+	M2U_CHECK(Reader.GetAssetIndex(0) == M2U_ACTOR_RECORD_NO_ASSET);
+	float Read[10];
+	Reader.GetValues(0, 1, Read);
+	M2U_CHECK(Read[5] == 0.70710677f && Read[9] == 1.0f);
+}
+
+M2U_TEST(ActorRecordsRejectBrokenPayloads)
+{
+	const std::vector<uint8_t> Data = MakeRecords();
+	Fm2uActorRecordsReader Reader;
+	// cut off anywhere
+	for( size_t Num = 0; Num < Data.size(); ++Num )
+	{
+		M2U_CHECK(Reader.Init(Data.data(), (int32_t)Num) != Em2uActorRecordsError::None);
+	}
+
+	std::vector<uint8_t> Layout = Data;
+	Layout[0] = 12;
+	M2U_CHECK(Reader.Init(Layout.data(), (int32_t)Layout.size()) == Em2uActorRecordsError::UnknownLayout);
+
+	// a count far beyond the data
+	std::vector<uint8_t> Count = Data;
+	Count[11] = 0x7F;
+	M2U_CHECK(Reader.Init(Count.data(), (int32_t)Count.size()) == Em2uActorRecordsError::Truncated);
+
+	// the asset index of the first record is the first aligned word after the names
+	std::vector<uint8_t> Index = Data;
+	int32_t Offset = 0;
+	M2U_CHECK(Reader.Init(Data.data(), (int32_t)Data.size()) == Em2uActorRecordsError::None);
+	Offset = Reader.GetNamesOffset();
+	for( int32_t Idx = 0; Idx < 3; ++Idx )
+	{
+		Reader.ReadString(Offset);
+	}
+	Index[(Offset + 3) & ~3] = 2;
+	M2U_CHECK(Reader.Init(Index.data(), (int32_t)Index.size()) == Em2uActorRecordsError::InvalidAssetIndex);
+}
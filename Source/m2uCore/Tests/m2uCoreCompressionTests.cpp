@@ -0,0 +1,60 @@
+// Tests of the LZ4 block codec
+
+#include <string>
+#include <vector>
+
+#include "m2uCoreCompression.h"
+#include "m2uCoreTest.h"
+
+namespace
+{
+	std::vector<uint8_t> CompressText( const std::string& Text )
+	{
+		std::vector<uint8_t> Compressed(m2uCompression::CompressBound((int32_t)Text.size()));
+		std::vector<int32_t> HashTable(m2uCompression::HashTableSize);
+		const int32_t Len = m2uCompression::Compress((const uint8_t*)Text.data(), (int32_t)Text.size(), Compressed.data(), HashTable.data());
+		Compressed.resize(Len);
+		return Compressed;
+	}
+}
+
+
+M2U_TEST(CompressionRoundTrips)
+{
+	std::string Text;
+	for( int32_t Idx = 0; Idx < 2000; ++Idx )
+	{
+		Text += "AddActor /Game/Meshes/SM_Rock Rock_" + std::to_string(Idx) + " T=(1 2 3) R=(0 90 0) S=(1 1 1)\n";
+	}
+	const std::vector<uint8_t> Compressed = CompressText(Text);
+	M2U_CHECK(Compressed.size() < Text.size() / 4);
+
+	std::vector<uint8_t> Decompressed(Text.size());
+	M2U_CHECK(m2uCompression::Decompress(Compressed.data(), (int32_t)Compressed.size(), Decompressed.data(), (int32_t)Decompressed.size()));
+	M2U_CHECK(std::string(Decompressed.begin(), Decompressed.end()) == Text);
+
+	// a wrong size or a cut off block fails
+	M2U_CHECK(!m2uCompression::Decompress(Compressed.data(), (int32_t)Compressed.size(), Decompressed.data(), (int32_t)Decompressed.size() - 1));
+	M2U_CHECK(!m2uCompression::Decompress(Compressed.data(), (int32_t)Compressed.size() - 1, Decompressed.data(), (int32_t)Decompressed.size()));
+}
+
+M2U_TEST(CompressionRejectsEndlessLengths)
+{
+	uint8_t Dest[64];
+	// a literal length of 255 bytes 0xFF, about 8.4 MB of them would overflow
+	std::vector<uint8_t> Literals(9 * 1024 * 1024, 0xFF);
+	Literals[0] = 0xF0;
+	M2U_CHECK(!m2uCompression::Decompress(Literals.data(), (int32_t)Literals.size(), Dest, sizeof(Dest)));
+
+	// the same for the match length, after one literal and its offset
+	std::vector<uint8_t> Match(9 * 1024 * 1024, 0xFF);
+	Match[0] = 0x1F;
+	Match[1] = 'a';
+	Match[2] = 1;
+	Match[3] = 0;
+	M2U_CHECK(!m2uCompression::Decompress(Match.data(), (int32_t)Match.size(), Dest, sizeof(Dest)));
+
+	// a run of length bytes that just ends early
+	const uint8_t Truncated[] = { 0xF0, 0xFF, 0xFF };
+	M2U_CHECK(!m2uCompression::Decompress(Truncated, sizeof(Truncated), Dest, sizeof(Dest)));
+}
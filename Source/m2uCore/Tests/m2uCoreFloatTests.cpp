@@ -0,0 +1,158 @@
+// Tests of the float parsing, against strtof which rounds correctly too
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "m2uCoreFloat.h"
+#include "m2uCoreParse.h"
+#include "m2uCoreTest.h"
+
+namespace
+{
+	/** parse all of Str, which has to be a number */
+	bool ParsesTo( const char* Str, float Expected )
+	{
+		float Value = 0.0f;
+		const char* End = m2uParse::ParseFloat(Str, (const char*)NULL, Value);
+		return End != NULL && *End == 0 && m2uFloat::BitsFromFloat(Value) == m2uFloat::BitsFromFloat(Expected);
+	}
+
+	/** parse Str like strtof does, to the last bit */
+	bool ParsesLikeStrtof( const std::string& Str )
+	{
+		const float Expected = std::strtof(Str.c_str(), NULL);
+		const bool bSame = ParsesTo(Str.c_str(), Expected);
+		if( ! bSame )
+		{
+			std::printf("  %s\n", Str.c_str());
+		}
+		return bSame;
+	}
+}
+
+
+M2U_TEST(FloatParsesTheNumberFormats)
+{
+	M2U_CHECK(ParsesTo("0", 0.0f));
+	M2U_CHECK(ParsesTo("-0", -0.0f));
+	M2U_CHECK(ParsesTo("12.5", 12.5f));
+	M2U_CHECK(ParsesTo("+12.5", 12.5f));
+	M2U_CHECK(ParsesTo("-.5", -0.5f));
+	M2U_CHECK(ParsesTo("5.", 5.0f));
+	M2U_CHECK(ParsesTo("1e3", 1000.0f));
+	M2U_CHECK(ParsesTo("1E+3", 1000.0f));
+	M2U_CHECK(ParsesTo("25e-2", 0.25f));
+	M2U_CHECK(ParsesTo("0.1", 0.1f));
+	M2U_CHECK(ParsesTo("000000000000000000000000001.5", 1.5f));
+	M2U_CHECK(ParsesTo("3.4028234663852886e38", 3.4028234663852886e38f));
+	M2U_CHECK(ParsesTo("1e39", std::strtof("1e39", NULL)));
+	M2U_CHECK(ParsesTo("1e-50", 0.0f));
+	M2U_CHECK(ParsesTo("1.401298464324817e-45", 1.401298464324817e-45f));
+
+	float Value = 7.0f;
+	M2U_CHECK(m2uParse::ParseFloat("abc", (const char*)NULL, Value) == NULL);
+	M2U_CHECK(m2uParse::ParseFloat("-", (const char*)NULL, Value) == NULL);
+	M2U_CHECK(m2uParse::ParseFloat(".", (const char*)NULL, Value) == NULL);
+	M2U_CHECK(Value == 7.0f);
+
+	// an 'e' without digits isn't part of the number
+	const char* Str = "2e)";
+	M2U_CHECK(m2uParse::ParseFloat(Str, (const char*)NULL, Value) == Str + 1);
+	M2U_CHECK(Value == 2.0f);
+
+	// nothing is read beyond End
+	const char16_t* Wide = u"1.25e2";
+	M2U_CHECK(m2uParse::ParseFloat(Wide, Wide + 4, Value) == Wide + 4);
+	M2U_CHECK(Value == 1.25f);
+}
+
+M2U_TEST(FloatRoundTripsPrintedFloats)
+{
+	char Buffer[64];
+	int32_t NumWrong = 0;
+	// a sample of all finite floats, normal and denormal
+	for( uint64_t Bits = 1; Bits < 0x7F800000; Bits += 4093 )
+	{
+		const float Original = m2uFloat::FloatFromBits((uint32_t)Bits);
+		std::snprintf(Buffer, sizeof(Buffer), "%.9g", Original);
+		NumWrong += ParsesTo(Buffer, Original) ? 0 : 1;
+		// what a client holding doubles sends
+		std::snprintf(Buffer, sizeof(Buffer), "%.17g", (double)Original);
+		NumWrong += ParsesTo(Buffer, Original) ? 0 : 1;
+	}
+	M2U_CHECK(NumWrong == 0);
+}
+
+M2U_TEST(FloatRoundsMiddlesLikeStrtof)
+{
+	std::mt19937 Random(23);
+	char Buffer[256];
+	int32_t NumWrong = 0;
+	for( int32_t Iteration = 0; Iteration < 20000; ++Iteration )
+	{
+		// exactly between a float and the next one, all digits of it
+		const uint32_t Bits = Random() % 0x7F7FFFFF;
+		const double Middle = ((double)m2uFloat::FloatFromBits(Bits) + (double)m2uFloat::FloatFromBits(Bits + 1)) * 0.5;
+		std::snprintf(Buffer, sizeof(Buffer), "%.150e", Middle);
+		std::string Exact = Buffer;
+		const size_t ExponentAt = Exact.find('e');
+		std::string Digits = Exact.substr(0, ExponentAt);
+		const std::string Exponent = Exact.substr(ExponentAt);
+		while( Digits.back() == '0' )
+		{
+			Digits.pop_back();
+		}
+		// a tie, barely above it, and above it by a digit beyond MaxExactDigits
+		NumWrong += ParsesLikeStrtof(Digits + Exponent) ? 0 : 1;
+		NumWrong += ParsesLikeStrtof(Digits + "1" + Exponent) ? 0 : 1;
+		NumWrong += ParsesLikeStrtof(Digits + std::string(200, '0') + "1" + Exponent) ? 0 : 1;
+		// barely below it
+		std::string Below = Digits;
+		size_t Last = Below.size() - 1;
+		--Below[Last];
+		NumWrong += ParsesLikeStrtof(Below + "9999" + Exponent) ? 0 : 1;
+	}
+	M2U_CHECK(NumWrong == 0);
+}
+
+M2U_TEST(FloatMatchesStrtofOnRandomDecimals)
+{
+	std::mt19937 Random(42);
+	int32_t NumWrong = 0;
+	for( int32_t Iteration = 0; Iteration < 200000; ++Iteration )
+	{
+		std::string Str;
+		if( Random() % 2 )
+		{
+			Str += '-';
+		}
+		const int32_t NumDigits = 1 + Random() % 25;
+		const int32_t Point = Random() % (NumDigits + 1);
+		for( int32_t Idx = 0; Idx < NumDigits; ++Idx )
+		{
+			if( Idx == Point )
+			{
+				Str += '.';
+			}
+			Str += (char)('0' + Random() % 10);
+		}
+		if( Random() % 2 )
+		{
+			Str += 'e' + std::to_string((int32_t)(Random() % 100) - 60);
+		}
+		NumWrong += ParsesLikeStrtof(Str) ? 0 : 1;
+	}
+	M2U_CHECK(NumWrong == 0);
+}
+
+M2U_TEST(AtofSkipsWhitespaceAndStopsAtTheEnd)
+{
+	M2U_CHECK(m2uParse::Atof("  \t-12.25 3") == -12.25f);
+	M2U_CHECK(m2uParse::Atof(u"0.1)") == 0.1f);
+	M2U_CHECK(m2uParse::Atof("x") == 0.0f);
+	const char* Str = "1.5e10";
+	M2U_CHECK(m2uParse::Atof(Str, Str + 3) == 1.5f);
+}
@@ -0,0 +1,36 @@
+// Tests of the frame header encoding
+
+#include "m2uCoreFraming.h"
+#include "m2uCoreTest.h"
+
+M2U_TEST(FrameHeaderRoundTrips)
+{
+	uint8_t Data[M2U_FRAME_HEADER_SIZE];
+	m2uFraming::WriteHeader(Data, 1234567, 0xDEADBEEF, M2U_FRAME_FLAG_ASYNC | M2U_FRAME_FLAG_COMPRESSED);
+	// little-endian on the wire
+	M2U_CHECK(Data[0] == 0x87 && Data[1] == 0xD6 && Data[2] == 0x12 && Data[3] == 0x00);
+	M2U_CHECK(Data[4] == 0xEF && Data[7] == 0xDE);
+
+	Fm2uFrameHeader Header;
+	M2U_CHECK(m2uFraming::ReadHeader(Data, Header) == Em2uFrameHeaderError::None);
+	M2U_CHECK(Header.PayloadLength == 1234567);
+	M2U_CHECK(Header.RequestId == 0xDEADBEEF);
+	M2U_CHECK(Header.Flags == (M2U_FRAME_FLAG_ASYNC | M2U_FRAME_FLAG_COMPRESSED));
+}
+
+M2U_TEST(FrameHeaderRejectsBrokenStreams)
+{
+	uint8_t Data[M2U_FRAME_HEADER_SIZE];
+	Fm2uFrameHeader Header;
+	m2uFraming::WriteHeader(Data, M2U_FRAME_MAX_PAYLOAD + 1, 1, 0);
+	M2U_CHECK(m2uFraming::ReadHeader(Data, Header) == Em2uFrameHeaderError::InvalidLength);
+	m2uFraming::WriteHeader(Data, 10, 1, 0x100);
+	M2U_CHECK(m2uFraming::ReadHeader(Data, Header) == Em2uFrameHeaderError::UnknownFlags);
+}
+
+M2U_TEST(BinaryPayloadSplitsAtTheFirstZero)
+{
+	const uint8_t Payload[] = { 'A', 'd', 'd', 0, 9, 0, 0, 0 };
+	M2U_CHECK(m2uFraming::GetBinaryCommandLength(Payload, sizeof(Payload)) == 3);
+	M2U_CHECK(m2uFraming::GetBinaryCommandLength(Payload, 3) == -1);
+}
@@ -0,0 +1,41 @@
+// Tests of the keyword dispatch table
+
+#include "m2uCoreKeywordTable.h"
+#include "m2uCoreTest.h"
+
+M2U_TEST(KeywordTableFindsTheFirstWordIgnoringCase)
+{
+	Tm2uKeywordTable<int> Table;
+	Table.Add("TransformObject", 1);
+	Table.Add(u"SelectByNames", 2);
+	M2U_CHECK(Table.Num() == 2);
+
+	const int* Value = Table.Find("  transformOBJECT Cube_1 T=(1 2 3)");
+	M2U_CHECK(Value != NULL && *Value == 1);
+	Value = Table.Find(u"SelectByNames [a,b]");
+	M2U_CHECK(Value != NULL && *Value == 2);
+
+	M2U_CHECK(Table.Find("TransformObjects Cube_1") == NULL);
+	M2U_CHECK(Table.Find("Transform") == NULL);
+	M2U_CHECK(Table.Find("") == NULL);
+	M2U_CHECK(Table.Find(u"TränsformObject") == NULL);
+}
+
+M2U_TEST(KeywordTableReplacesAndGrows)
+{
+	Tm2uKeywordTable<int> Table;
+	char Keyword[16];
+	for( int Idx = 0; Idx < 100; ++Idx )
+	{
+		std::snprintf(Keyword, sizeof(Keyword), "Command%d", Idx);
+		Table.Add(Keyword, Idx);
+	}
+	Table.Add("command7", 700);
+	M2U_CHECK(Table.Num() == 100);
+	for( int Idx = 0; Idx < 100; ++Idx )
+	{
+		std::snprintf(Keyword, sizeof(Keyword), "COMMAND%d x", Idx);
+		const int* Value = Table.Find(Keyword);
+		M2U_CHECK(Value != NULL && *Value == (Idx == 7 ? 700 : Idx));
+	}
+}
@@ -0,0 +1,152 @@
+// Tests of the command text parsing
+
+#include <cstring>
+
+#include "m2uCoreParse.h"
+#include "m2uCoreTest.h"
+
+M2U_TEST(CommandMatchesWholeWordIgnoringCase)
+{
+	const char* Str = "  transformobject\tCube_1 T=(1 2 3)";
+	M2U_CHECK(m2uParse::Command(Str, "TransformObject"));
+	M2U_CHECK(*Str == 'C');
+
+	const char* Longer = "TransformObjects Cube_1";
+	M2U_CHECK(!m2uParse::Command(Longer, "TransformObject"));
+	M2U_CHECK(Longer[0] == 'T');
+
+	const char* Underscore = "TransformObject_2";
+	M2U_CHECK(!m2uParse::Command(Underscore, "TransformObject"));
+
+	const char* Exact = "UnhideAll";
+	M2U_CHECK(m2uParse::Command(Exact, "UnhideAll"));
+	M2U_CHECK(*Exact == 0);
+}
+
+M2U_TEST(CommandWorksOnWideCharacters)
+{
+	const char16_t* Str = u"SelectByNames [a,b]";
+	M2U_CHECK(m2uParse::Command(Str, "SelectByNames"));
+	M2U_CHECK(*Str == u'[');
+}
+
+M2U_TEST(FirstWordIsTheKeyword)
+{
+	M2U_CHECK(m2uParse::FirstWord(" \tAddActor /Game/Cube Cube_1").Equals("AddActor"));
+	M2U_CHECK(m2uParse::FirstWord("Undo").Equals("Undo"));
+	M2U_CHECK(m2uParse::FirstWord("").IsEmpty());
+	M2U_CHECK(m2uParse::FirstWord("[a,b]").IsEmpty());
+}
+
+M2U_TEST(TokenSplitsAtWhitespaceOrQuotes)
+{
+	const char* Str = "  Cube_1 \"My Layer\" [a,b]\n";
+	Tm2uTextView<char> Token;
+	M2U_CHECK(m2uParse::Token(Str, Token) && Token.Equals("Cube_1"));
+	M2U_CHECK(m2uParse::Token(Str, Token) && Token.Equals("My Layer"));
+	M2U_CHECK(m2uParse::Token(Str, Token) && Token.Equals("[a,b]"));
+	M2U_CHECK(!m2uParse::Token(Str, Token));
+
+	// an unterminated quote runs to the end
+	const char* Open = "\"abc def";
+	M2U_CHECK(m2uParse::Token(Open, Token) && Token.Equals("abc def"));
+	M2U_CHECK(*Open == 0);
+
+	char Buffer[4];
+	M2U_CHECK(Tm2uTextView<char>("abcdef", 6).CopyTo(Buffer, sizeof(Buffer)) == 3);
+	M2U_CHECK(Buffer[0] == 'a' && Buffer[2] == 'c' && Buffer[3] == 0);
+}
+
+M2U_TEST(StrfindNeedsNonAlnumLeadIn)
+{
+	const char* Str = "Cube_1 ST=(1 2 3) t=(4 5 6)";
+	const char* Found = m2uParse::Strfind(Str, "T=");
+	M2U_CHECK(Found == Str + 18);
+	M2U_CHECK(m2uParse::Strfind(Str, "R=") == NULL);
+	// '_' is no letter or digit
+	M2U_CHECK(m2uParse::Strfind("a_T=(1 1 1)", "T=") != NULL);
+}
+
+M2U_TEST(ParseFloatsLikeGetFVECTORSpaceDelimited)
+{
+	float Values[3] = { 0.0f, 0.0f, 0.0f };
+	const char* End = m2uParse::ParseFloats("1.5 -2 3e2)", Values, 3);
+	M2U_CHECK(End != NULL && *End == '3');
+	M2U_CHECK_NEAR(Values[0], 1.5f);
+	M2U_CHECK_NEAR(Values[1], -2.0f);
+	M2U_CHECK_NEAR(Values[2], 300.0f);
+
+	float Partial[3] = { 9.0f, 9.0f, 9.0f };
+	M2U_CHECK(m2uParse::ParseFloats("4 5", Partial, 3) == NULL);
+	M2U_CHECK_NEAR(Partial[0], 4.0f);
+	M2U_CHECK_NEAR(Partial[1], 5.0f);
+	M2U_CHECK_NEAR(Partial[2], 9.0f);
+
+	M2U_CHECK_NEAR(m2uParse::Atof(u"  -0.25)"), -0.25f);
+	M2U_CHECK_NEAR(m2uParse::Atof("abc"), 0.0f);
+	const char* Bounded = "12345";
+	M2U_CHECK_NEAR(m2uParse::Atof(Bounded, Bounded + 2), 12.0f);
+}
+
+M2U_TEST(ListParserSplitsLikeParseList)
+{
+	const char* Str = "[a,b,,Cube_1]";
+	Tm2uListParser<char> List(Str, 13);
+	Tm2uTextView<char> Item;
+	M2U_CHECK(List.Next(Item) && Item.Equals("a"));
+	M2U_CHECK(List.Next(Item) && Item.Equals("b"));
+	M2U_CHECK(List.Next(Item) && Item.IsEmpty());
+	M2U_CHECK(List.Next(Item) && Item.Equals("Cube_1"));
+	M2U_CHECK(!List.Next(Item));
+
+	Tm2uListParser<char> Empty("[]", 2);
+	M2U_CHECK(!Empty.Next(Item));
+	Tm2uListParser<char> Nothing("", 0);
+	M2U_CHECK(!Nothing.Next(Item));
+
+	Tm2uListParser<char16_t> Trailing(u"[a,]", 4);
+	Tm2uTextView<char16_t> WideItem;
+	M2U_CHECK(Trailing.Next(WideItem) && WideItem.Equals("a"));
+	M2U_CHECK(Trailing.Next(WideItem) && WideItem.IsEmpty());
+	M2U_CHECK(!Trailing.Next(WideItem));
+}
+
+M2U_TEST(ListParserHandlesQuotesAndEscapes)
+{
+	const char* Str = " [ a , \"Wall, north\" ,\"say \\\"hi\\\"\",b c ] Other=1";
+	Tm2uListParser<char> List(Str, (int32_t)std::strlen(Str));
+	Tm2uTextView<char> Item;
+	M2U_CHECK(List.Next(Item) && Item.Equals("a"));
+	M2U_CHECK(List.Next(Item) && Item.Equals("Wall, north") && !List.HasEscapes());
+	M2U_CHECK(List.Next(Item) && Item.Equals("say \\\"hi\\\"") && List.HasEscapes());
+	M2U_CHECK(List.Next(Item) && Item.Equals("b c"));
+	M2U_CHECK(!List.Next(Item));
+
+	// copied without the escapes, and cut off
+	Tm2uListParser<char> Copies(Str, (int32_t)std::strlen(Str));
+	char Buffer[8];
+	M2U_CHECK(Copies.Next(Buffer, 8) && std::strcmp(Buffer, "a") == 0);
+	M2U_CHECK(Copies.Next(Buffer, 8) && std::strcmp(Buffer, "Wall, n") == 0);
+	M2U_CHECK(Copies.Next(Buffer, 8) && std::strcmp(Buffer, "say \"hi") == 0);
+
+	// a bracket in quotes doesn't end the list
+	const char* Bracket = "[\"x]\",y]";
+	Tm2uListParser<char> Quoted(Bracket, 8);
+	M2U_CHECK(Quoted.Next(Item) && Item.Equals("x]"));
+	M2U_CHECK(Quoted.Next(Item) && Item.Equals("y"));
+	M2U_CHECK(!Quoted.Next(Item));
+
+	// without brackets the list ends like a token
+	const char* Bare = "a,b c";
+	Tm2uListParser<char> Unbracketed(Bare, 5);
+	M2U_CHECK(Unbracketed.Next(Item) && Item.Equals("a"));
+	M2U_CHECK(Unbracketed.Next(Item) && Item.Equals("b"));
+	M2U_CHECK(!Unbracketed.Next(Item));
+
+	Tm2uListParser<char> Blank("[  ]", 4);
+	M2U_CHECK(!Blank.Next(Item));
+	// an unterminated quote runs to the end
+	Tm2uListParser<char> Open("[\"a,b", 5);
+	M2U_CHECK(Open.Next(Item) && Item.Equals("a,b"));
+	M2U_CHECK(!Open.Next(Item));
+}
@@ -0,0 +1,58 @@
+#pragma once
+// A minimal test harness for the native tests of the core
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+/**
+   M2U_TEST(Name) { ... } defines a test, M2U_CHECK fails it without
+   stopping. m2uCoreTests.cpp runs all of them and returns non-zero if any
+   check failed, which is all ctest needs.
+ */
+typedef void (*Fm2uTestFunction)();
+
+struct Fm2uTestCase
+{
+	const char* Name;
+	Fm2uTestFunction Function;
+};
+
+namespace m2uTest
+{
+	inline std::vector<Fm2uTestCase>& GetTests()
+	{
+		static std::vector<Fm2uTestCase> Tests;
+		return Tests;
+	}
+
+	inline int& GetNumFailures()
+	{
+		static int NumFailures = 0;
+		return NumFailures;
+	}
+
+	inline void Fail( const char* File, int Line, const char* Expression )
+	{
+		std::printf("%s:%d: check failed: %s\n", File, Line, Expression);
+		++GetNumFailures();
+	}
+
+	struct FRegistrar
+	{
+		FRegistrar( const char* Name, Fm2uTestFunction Function )
+		{
+			GetTests().push_back(Fm2uTestCase{Name, Function});
+		}
+	};
+}
+
+#define M2U_TEST(Name) \
+	static void m2uTest_##Name(); \
+	static m2uTest::FRegistrar m2uTestRegistrar_##Name(#Name, &m2uTest_##Name); \
+	static void m2uTest_##Name()
+
+#define M2U_CHECK(Expression) \
+	do { if( !(Expression) ) m2uTest::Fail(__FILE__, __LINE__, #Expression); } while( 0 )
+
+#define M2U_CHECK_NEAR(A, B) M2U_CHECK(std::fabs((double)(A) - (double)(B)) <= 1e-5 * (1.0 + std::fabs((double)(B))))
@@ -0,0 +1,23 @@
+// Runs all native tests of the core, see m2uCoreTest.h
+
+#include <cstring>
+
+#include "m2uCoreTest.h"
+
+int main( int argc, char** argv )
+{
+	// an argument runs only the tests whose name contains it
+	const char* Filter = argc > 1 ? argv[1] : NULL;
+	int NumRun = 0;
+	for( const Fm2uTestCase& Test : m2uTest::GetTests() )
+	{
+		if( Filter != NULL && std::strstr(Test.Name, Filter) == NULL )
+			continue;
+		const int FailuresBefore = m2uTest::GetNumFailures();
+		Test.Function();
+		std::printf("%s %s\n", m2uTest::GetNumFailures() == FailuresBefore ? "ok  " : "FAIL", Test.Name);
+		++NumRun;
+	}
+	std::printf("%d tests, %d failed checks\n", NumRun, m2uTest::GetNumFailures());
+	return m2uTest::GetNumFailures() == 0 && NumRun > 0 ? 0 : 1;
+}
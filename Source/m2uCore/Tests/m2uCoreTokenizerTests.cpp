@@ -0,0 +1,176 @@
+// Tests of the command tokenizer
+
+#include <random>
+#include <string>
+
+#include "m2uCoreTokenizer.h"
+#include "m2uCoreTest.h"
+
+M2U_TEST(TokenizerSplitsLikeFParseToken)
+{
+	const char* Cmd = "  AddActor /Game/Cube \"Cube One\" EditIfExists=false\t T=(1 2 3)  ";
+	Tm2uTokenTable<char> Tokens(Cmd);
+	M2U_CHECK(Tokens.Num() == 5);
+	M2U_CHECK(Tokens.GetKeyword().Equals("AddActor"));
+	M2U_CHECK(Tokens.Get(1).Equals("/Game/Cube"));
+	M2U_CHECK(Tokens.Get(2).Equals("Cube One"));
+	M2U_CHECK(Tokens.GetToken(2).bQuoted);
+	M2U_CHECK(Tokens.GetKey(3).Equals("EditIfExists"));
+	M2U_CHECK(Tokens.GetValue(3).Equals("false"));
+	// whitespace inside brackets doesn't split
+	M2U_CHECK(Tokens.Get(4).Equals("T=(1 2 3)"));
+	M2U_CHECK(Tokens.GetValue(4).Equals("(1 2 3)"));
+	M2U_CHECK(Tokens.Find("editifexists") == 3);
+	M2U_CHECK(Tokens.Find("S") == -1);
+	M2U_CHECK(!m2uParse::ToBool(Tokens.GetValue(3)));
+}
+
+M2U_TEST(TokenizerHandlesQuotesAndBrackets)
+{
+	Tm2uTokenTable<char16_t> Tokens(u"SelectByNames [a, b,c] Name=\"x y\" \"\" \"open quote");
+	M2U_CHECK(Tokens.Num() == 5);
+	M2U_CHECK(Tokens.Get(1).Equals("[a, b,c]"));
+	M2U_CHECK(Tokens.GetKey(2).Equals("Name"));
+	M2U_CHECK(Tokens.GetValue(2).Equals("x y"));
+	M2U_CHECK(Tokens.Get(3).IsEmpty() && Tokens.GetToken(3).bQuoted);
+	M2U_CHECK(Tokens.Get(4).Equals("open quote"));
+
+	// a closing bracket too many doesn't confuse it
+	Tm2uTokenTable<char> Unbalanced("a) b");
+	M2U_CHECK(Unbalanced.Num() == 2);
+
+	Tm2uTokenTable<char> Empty("   ");
+	M2U_CHECK(Empty.Num() == 0);
+	M2U_CHECK(Empty.GetKeyword().IsEmpty());
+}
+
+M2U_TEST(TokenizerSplitsALineWithoutTerminator)
+{
+	const char* Batch = "AddActor /Game/A A_1\nAddActor /Game/B B_1";
+	Tm2uTokenTable<char> Tokens;
+	Tokens.Tokenize(Batch, 20);
+	M2U_CHECK(Tokens.Num() == 3);
+	M2U_CHECK(Tokens.Get(2).Equals("A_1"));
+}
+
+M2U_TEST(TokenizerKeepsManyTokens)
+{
+	std::string Cmd = "HideByNames";
+	for( int Idx = 0; Idx < 100; ++Idx )
+	{
+		Cmd += " Actor_" + std::to_string(Idx);
+	}
+	Tm2uTokenTable<char> Tokens(Cmd.c_str());
+	M2U_CHECK(Tokens.Num() == 101);
+	M2U_CHECK(Tokens.Get(100).Equals("Actor_99"));
+	M2U_CHECK(Tokens.Get(40).Equals("Actor_39"));
+}
+
+M2U_TEST(TokenizerSplitsTheFirstTokensOnly)
+{
+	std::string Batch = "AddActorBatch";
+	for( int Idx = 0; Idx < 1000; ++Idx )
+	{
+		Batch += "\nAddActor /Game/Rock \"Rock " + std::to_string(Idx) + "\" T=(1 2 3)";
+	}
+	Tm2uTokenTable<char> Tokens;
+	Tokens.TokenizeFirst(Batch.c_str(), (int32_t)Batch.size(), 1);
+	M2U_CHECK(Tokens.Num() == 1);
+	M2U_CHECK(Tokens.GetKeyword().Equals("AddActorBatch"));
+	M2U_CHECK(Tokens.GetTextLen() == (int32_t)Batch.size());
+
+	// the rest comes out the same as splitting all at once
+	Tokens.TokenizeRest();
+	const Tm2uTokenTable<char> All(Batch.c_str());
+	M2U_CHECK(Tokens.Num() == All.Num() && All.Num() == 4001);
+	for( int32_t Idx = 0; Idx < All.Num() && Idx < Tokens.Num(); ++Idx )
+	{
+		M2U_CHECK(Tokens.GetToken(Idx).Start == All.GetToken(Idx).Start);
+		M2U_CHECK(Tokens.GetToken(Idx).Len == All.GetToken(Idx).Len);
+	}
+	Tokens.TokenizeRest();
+	M2U_CHECK(Tokens.Num() == 4001);
+
+	// stopping behind a quoted token, or at the very end
+	Tm2uTokenTable<char> Quoted;
+	Quoted.TokenizeFirst("\"a b\"c d", 8, 1);
+	M2U_CHECK(Quoted.Num() == 1 && Quoted.Get(0).Equals("a b"));
+	Quoted.TokenizeRest();
+	M2U_CHECK(Quoted.Num() == 3 && Quoted.Get(1).Equals("c") && Quoted.Get(2).Equals("d"));
+	Tm2uTokenTable<char> Short;
+	Short.TokenizeFirst("Ok", 2, 3);
+	M2U_CHECK(Short.Num() == 1);
+	Short.TokenizeRest();
+	M2U_CHECK(Short.Num() == 1);
+}
+
+M2U_TEST(TokenizerSimdMatchesScalar)
+{
+	// random text of the interesting characters, long enough for several blocks
+	const char Alphabet[] = " \t\r\n\"()[]=abcXYZ019_/.,-";
+	std::mt19937 Random(1234);
+	for( int Round = 0; Round < 200; ++Round )
+	{
+		std::u16string Text;
+		std::string Narrow;
+		const int Len = (int)(Random() % 300);
+		for( int Idx = 0; Idx < Len; ++Idx )
+		{
+			const char C = Alphabet[Random() % (sizeof(Alphabet) - 1)];
+			Narrow += C;
+			// characters beyond a byte must not be mistaken for ASCII
+			Text += (Random() % 17 == 0) ? (char16_t)(0x2000 | (uint8_t)C) : (char16_t)C;
+		}
+		Tm2uTokenTable<char16_t> Simd, Scalar;
+		Simd.Tokenize(Text.data(), (int32_t)Text.size(), Em2uTokenizerPath::Best);
+		Scalar.Tokenize(Text.data(), (int32_t)Text.size(), Em2uTokenizerPath::Scalar);
+		Tm2uTokenTable<char> SimdNarrow, ScalarNarrow;
+		SimdNarrow.Tokenize(Narrow.data(), (int32_t)Narrow.size(), Em2uTokenizerPath::Best);
+		ScalarNarrow.Tokenize(Narrow.data(), (int32_t)Narrow.size(), Em2uTokenizerPath::Scalar);
+
+		M2U_CHECK(Simd.Num() == Scalar.Num());
+		M2U_CHECK(SimdNarrow.Num() == ScalarNarrow.Num());
+		for( int32_t Idx = 0; Idx < Simd.Num() && Idx < Scalar.Num(); ++Idx )
+		{
+			M2U_CHECK(Simd.GetToken(Idx).Start == Scalar.GetToken(Idx).Start);
+			M2U_CHECK(Simd.GetToken(Idx).Len == Scalar.GetToken(Idx).Len);
+			M2U_CHECK(Simd.GetToken(Idx).KeyLen == Scalar.GetToken(Idx).KeyLen);
+		}
+		for( int32_t Idx = 0; Idx < SimdNarrow.Num() && Idx < ScalarNarrow.Num(); ++Idx )
+		{
+			M2U_CHECK(SimdNarrow.GetToken(Idx).Start == ScalarNarrow.GetToken(Idx).Start);
+			M2U_CHECK(SimdNarrow.GetToken(Idx).Len == ScalarNarrow.GetToken(Idx).Len);
+		}
+	}
+}
+
+M2U_TEST(ParseTransformReadsOnlyTheGivenParts)
+{
+	Tm2uTokenTable<char16_t> Tokens(u"TransformObject Cube_1 R=(10 20 30) T=(1 2 3)");
+	Fm2uTransformText Transform;
+	m2uParse::ParseTransform(Tokens, Transform, 2);
+	M2U_CHECK(Transform.Parts == (M2U_TRANSFORM_LOCATION | M2U_TRANSFORM_ROTATION));
+	M2U_CHECK_NEAR(Transform.Location[0], 1.0f);
+	M2U_CHECK_NEAR(Transform.Location[2], 3.0f);
+	M2U_CHECK_NEAR(Transform.Rotation[1], 20.0f);
+	M2U_CHECK_NEAR(Transform.Scale[0], 1.0f);
+	M2U_CHECK(m2uParse::GetTransformParts(Tokens, 2) == (M2U_TRANSFORM_LOCATION | M2U_TRANSFORM_ROTATION));
+
+	Tm2uTokenTable<char> Scale("TransformObject Cube_1 s=(2 2 2)");
+	M2U_CHECK(m2uParse::GetTransformParts(Scale, 2) == M2U_TRANSFORM_SCALE);
+	Tm2uTokenTable<char> None("TransformObject Cube_1");
+	M2U_CHECK(m2uParse::GetTransformParts(None, 2) == 0);
+
+	// missing numbers are left as they were, nothing after the part is read
+	Tm2uTokenTable<char> Short("AddActor /Game/Cube Cube_1 T=(5 6) R=(7 8 9)");
+	Fm2uTransformText ShortTransform;
+	m2uParse::ParseTransform(Short, ShortTransform, 3);
+	M2U_CHECK_NEAR(ShortTransform.Location[0], 5.0f);
+	M2U_CHECK_NEAR(ShortTransform.Location[1], 6.0f);
+	M2U_CHECK_NEAR(ShortTransform.Location[2], 0.0f);
+	M2U_CHECK_NEAR(ShortTransform.Rotation[0], 7.0f);
+
+	Tm2uTokenTable<char> Cut("TransformObject Cube_1 S=");
+	m2uParse::ParseTransform(Cut, Transform, 2);
+	M2U_CHECK(Transform.Parts == M2U_TRANSFORM_SCALE);
+}
@@ -0,0 +1,259 @@
+#pragma once
+// Binary actor records for batch commands, independent of the engine
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "m2uCoreFraming.h"
+#include "m2uCoreParse.h"
+
+/**
+   Instead of one text line per actor, "AddActorBatch" and "TransformObject"
+   can be sent as binary commands (see M2U_FRAME_FLAG_BINARY in m2uFraming.h)
+   with the actors as records. All values are little-endian:
+
+   | uint16 FloatsPerRecord | uint16 Reserved | uint32 NumAssets | uint32 NumRecords |
+   | Asset path ... |       NumAssets strings, every asset only once
+   | Actor name ... |       NumRecords strings
+   | zero padding to a multiple of 4 bytes from the start |
+   | uint32 AssetIndex ... | NumRecords indices into the assets, or M2U_ACTOR_RECORD_NO_ASSET
+   | float Values ... |     NumRecords * FloatsPerRecord floats
+
+   Strings are a uint16 byte count followed by that many UTF-8 bytes. The
+   values of a record are a transform, the same as in the transform stream:
+   9:  T(x y z) R(pitch yaw roll in degrees) S(x y z), like the text commands
+   10: T(x y z) Q(x y z w) S(x y z), rotation as quaternion
+
+   The floats are one aligned block, so they can be copied as they are.
+ */
+
+#define M2U_ACTOR_RECORDS_HEADER_SIZE 12
+// the record has no asset, only an existing actor can be changed
+#define M2U_ACTOR_RECORD_NO_ASSET 0xFFFFFFFFu
+
+
+enum class Em2uActorRecordsError
+{
+	None,
+	Truncated,
+	UnknownLayout,
+	InvalidAssetIndex
+};
+
+
+/**
+ * Reads the records of a payload without copying it. Init checks all of it,
+ * after that nothing can be out of bounds.
+ */
+class Fm2uActorRecordsReader
+{
+public:
+
+	Fm2uActorRecordsReader()
+		:Data(NULL),
+		 FloatsPerRecord(0),
+		 NumAssets(0),
+		 NumRecords(0),
+		 AssetsOffset(0),
+		 NamesOffset(0),
+		 IndicesOffset(0),
+		 ValuesOffset(0)
+	{}
+
+	Em2uActorRecordsError Init( const uint8_t* InData, int32_t Num )
+	{
+		Data = InData;
+		if( Num < M2U_ACTOR_RECORDS_HEADER_SIZE )
+			return Em2uActorRecordsError::Truncated;
+		FloatsPerRecord = (int32_t)(Data[0] | (Data[1] << 8));
+		if( FloatsPerRecord != 9 && FloatsPerRecord != 10 )
+			return Em2uActorRecordsError::UnknownLayout;
+		const uint32_t InNumAssets = m2uFraming::ReadUInt32(Data + 4);
+		const uint32_t InNumRecords = m2uFraming::ReadUInt32(Data + 8);
+		// every string takes at least 2 bytes, this keeps the counts sane
+		if( InNumAssets > (uint32_t)Num / 2 || InNumRecords > (uint32_t)Num / 2 )
+			return Em2uActorRecordsError::Truncated;
+		NumAssets = (int32_t)InNumAssets;
+		NumRecords = (int32_t)InNumRecords;
+
+		int32_t Offset = M2U_ACTOR_RECORDS_HEADER_SIZE;
+		AssetsOffset = Offset;
+		if( ! SkipStrings(NumAssets, Num, Offset) )
+			return Em2uActorRecordsError::Truncated;
+		NamesOffset = Offset;
+		if( ! SkipStrings(NumRecords, Num, Offset) )
+			return Em2uActorRecordsError::Truncated;
+		IndicesOffset = (Offset + 3) & ~3;
+		ValuesOffset = IndicesOffset + NumRecords * 4;
+		if( (int64_t)ValuesOffset + (int64_t)NumRecords * FloatsPerRecord * 4 != Num )
+			return Em2uActorRecordsError::Truncated;
+
+		for( int32_t Idx = 0; Idx < NumRecords; ++Idx )
+		{
+			const uint32_t AssetIndex = GetAssetIndex(Idx);
+			if( AssetIndex >= (uint32_t)NumAssets && AssetIndex != M2U_ACTOR_RECORD_NO_ASSET )
+				return Em2uActorRecordsError::InvalidAssetIndex;
+		}
+		return Em2uActorRecordsError::None;
+	}
+
+	int32_t GetFloatsPerRecord() const
+	{
+		return FloatsPerRecord;
+	}
+
+	int32_t GetNumAssets() const
+	{
+		return NumAssets;
+	}
+
+	int32_t GetNumRecords() const
+	{
+		return NumRecords;
+	}
+
+	/**
+	 * The strings are read one after the other, start with Offset at
+	 * GetAssetsOffset or GetNamesOffset.
+	 * @return the UTF-8 bytes of the string, Offset is moved behind it
+	 */
+	Tm2uTextView<char> ReadString( int32_t& Offset ) const
+	{
+		const int32_t Len = Data[Offset] | (Data[Offset + 1] << 8);
+		const Tm2uTextView<char> String((const char*)Data + Offset + 2, Len);
+		Offset += 2 + Len;
+		return String;
+	}
+
+	int32_t GetAssetsOffset() const
+	{
+		return AssetsOffset;
+	}
+
+	int32_t GetNamesOffset() const
+	{
+		return NamesOffset;
+	}
+
+	uint32_t GetAssetIndex( int32_t Record ) const
+	{
+		return m2uFraming::ReadUInt32(Data + IndicesOffset + Record * 4);
+	}
+
+	/** copy the values of Count records from First on to Out */
+	void GetValues( int32_t First, int32_t Count, float* Out ) const
+	{
+		// little-endian like everything else on the wire, and like every
+		// platform the editor runs on
+		std::memcpy(Out, Data + ValuesOffset + First * FloatsPerRecord * 4, Count * FloatsPerRecord * 4);
+	}
+
+private:
+
+	bool SkipStrings( int32_t Count, int32_t Num, int32_t& Offset ) const
+	{
+		for( int32_t Idx = 0; Idx < Count; ++Idx )
+		{
+			if( Offset + 2 > Num )
+				return false;
+			Offset += 2 + (Data[Offset] | (Data[Offset + 1] << 8));
+			if( Offset > Num )
+				return false;
+		}
+		return true;
+	}
+
+	const uint8_t* Data;
+	int32_t FloatsPerRecord;
+	int32_t NumAssets;
+	int32_t NumRecords;
+	int32_t AssetsOffset;
+	int32_t NamesOffset;
+	int32_t IndicesOffset;
+	int32_t ValuesOffset;
+};
+
+
+/**
+ * Builds the records, what a client does. The plugin only reads them, this is
+ * for the tests and benchmarks, and as reference.
+ */
+class Fm2uActorRecordsWriter
+{
+public:
+
+	explicit Fm2uActorRecordsWriter( int32_t InFloatsPerRecord = 9 )
+		:FloatsPerRecord(InFloatsPerRecord)
+	{}
+
+	/** @return the index of the asset, added if it is new */
+	uint32_t AddAsset( const std::string& Path )
+	{
+		for( size_t Idx = 0; Idx < Assets.size(); ++Idx )
+		{
+			if( Assets[Idx] == Path )
+				return (uint32_t)Idx;
+		}
+		Assets.push_back(Path);
+		return (uint32_t)Assets.size() - 1;
+	}
+
+	/** add a record with FloatsPerRecord Values */
+	void Add( uint32_t AssetIndex, const std::string& Name, const float* Values )
+	{
+		Names.push_back(Name);
+		AssetIndices.push_back(AssetIndex);
+		RecordValues.insert(RecordValues.end(), Values, Values + FloatsPerRecord);
+	}
+
+	void Write( std::vector<uint8_t>& Out ) const
+	{
+		Out.clear();
+		uint8_t Header[M2U_ACTOR_RECORDS_HEADER_SIZE] = {};
+		Header[0] = (uint8_t)FloatsPerRecord;
+		m2uFraming::WriteUInt32(Header + 4, (uint32_t)Assets.size());
+		m2uFraming::WriteUInt32(Header + 8, (uint32_t)Names.size());
+		Out.insert(Out.end(), Header, Header + sizeof(Header));
+		for( const std::string& Asset : Assets )
+		{
+			WriteString(Asset, Out);
+		}
+		for( const std::string& Name : Names )
+		{
+			WriteString(Name, Out);
+		}
+		Out.resize((Out.size() + 3) & ~(size_t)3, 0);
+		for( uint32_t AssetIndex : AssetIndices )
+		{
+			uint8_t Bytes[4];
+			m2uFraming::WriteUInt32(Bytes, AssetIndex);
+			Out.insert(Out.end(), Bytes, Bytes + 4);
+		}
+		for( float Value : RecordValues )
+		{
+			uint32_t Bits;
+			std::memcpy(&Bits, &Value, sizeof(Bits));
+			uint8_t Bytes[4];
+			m2uFraming::WriteUInt32(Bytes, Bits);
+			Out.insert(Out.end(), Bytes, Bytes + 4);
+		}
+	}
+
+private:
+
+	static void WriteString( const std::string& String, std::vector<uint8_t>& Out )
+	{
+		const size_t Len = String.size() < 0xFFFF ? String.size() : 0xFFFF;
+		Out.push_back((uint8_t)(Len & 0xFF));
+		Out.push_back((uint8_t)(Len >> 8));
+		Out.insert(Out.end(), String.begin(), String.begin() + Len);
+	}
+
+	int32_t FloatsPerRecord;
+	std::vector<std::string> Assets;
+	std::vector<std::string> Names;
+	std::vector<uint32_t> AssetIndices;
+	std::vector<float> RecordValues;
+};
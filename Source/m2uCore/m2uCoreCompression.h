@@ -0,0 +1,196 @@
+#pragma once
+// Fast payload compression for the framed protocol, independent of the engine
+
+#include <cstdint>
+#include <cstring>
+
+/**
+   An in-tree implementation of the LZ4 block format. It is not the strongest
+   codec, but compression and decompression are cheap enough to be worth it
+   even on a local network, and the highly repetitive text of batch commands
+   (asset paths, "T=( R=( S=(" fragments) compresses very well.
+
+   A compressed frame payload is the uint32 little-endian size of the
+   uncompressed data followed by one LZ4 block, which is what lz4.block.compress
+   of the python lz4 package produces by default.
+ */
+namespace m2uCompression
+{
+	// minimum match length and end-of-block rules of the LZ4 block format
+	const int32_t MinMatch = 4;
+	const int32_t LastLiterals = 5;
+	const int32_t MatchFindLimit = 12;
+	const int32_t MaxOffset = 65535;
+	const int32_t HashLog = 12;
+	const int32_t HashTableSize = 1 << HashLog;
+
+	inline uint32_t Read32( const uint8_t* Data )
+	{
+		uint32_t Value;
+		std::memcpy( &Value, Data, sizeof(Value) );
+		return Value;
+	}
+
+	inline uint32_t Hash( uint32_t Sequence )
+	{
+		return (Sequence * 2654435761U) >> (32 - HashLog);
+	}
+
+	/** the largest size Compress can produce for SrcLen bytes */
+	inline int32_t CompressBound( int32_t SrcLen )
+	{
+		return SrcLen + SrcLen / 255 + 16;
+	}
+
+	inline uint8_t* WriteLength( uint8_t* Dest, int32_t Length )
+	{
+		while( Length >= 255 )
+		{
+			*Dest++ = 255;
+			Length -= 255;
+		}
+		*Dest++ = (uint8_t)Length;
+		return Dest;
+	}
+
+	/**
+	   Compress SrcLen bytes into Dest, which must hold CompressBound(SrcLen) bytes.
+	   HashTable is scratch space of HashTableSize entries, pass the same one
+	   every time to not allocate.
+
+	   @return the compressed size
+	 */
+	inline int32_t Compress( const uint8_t* Src, int32_t SrcLen, uint8_t* Dest, int32_t* HashTable )
+	{
+		for( int32_t Idx = 0; Idx < HashTableSize; ++Idx )
+			HashTable[Idx] = -1;
+
+		uint8_t* Out = Dest;
+		int32_t Pos = 0;
+		int32_t Anchor = 0;
+		const int32_t MatchLimit = SrcLen - LastLiterals;
+
+		while( Pos + MatchFindLimit <= SrcLen )
+		{
+			const uint32_t Sequence = Read32( Src + Pos );
+			const uint32_t H = Hash( Sequence );
+			const int32_t Ref = HashTable[H];
+			HashTable[H] = Pos;
+
+			if( Ref < 0 || Pos - Ref > MaxOffset || Read32( Src + Ref ) != Sequence )
+			{
+				++Pos;
+				continue;
+			}
+
+			int32_t MatchLen = MinMatch;
+			while( Pos + MatchLen < MatchLimit && Src[Ref + MatchLen] == Src[Pos + MatchLen] )
+				++MatchLen;
+
+			// token, literal length, literals, offset, match length
+			const int32_t LiteralLen = Pos - Anchor;
+			uint8_t* Token = Out++;
+			*Token = (uint8_t)((LiteralLen >= 15 ? 15 : LiteralLen) << 4);
+			if( LiteralLen >= 15 )
+				Out = WriteLength( Out, LiteralLen - 15 );
+			std::memcpy( Out, Src + Anchor, LiteralLen );
+			Out += LiteralLen;
+
+			const int32_t Offset = Pos - Ref;
+			*Out++ = (uint8_t)(Offset & 0xFF);
+			*Out++ = (uint8_t)(Offset >> 8);
+
+			const int32_t ExtraMatch = MatchLen - MinMatch;
+			*Token |= (uint8_t)(ExtraMatch >= 15 ? 15 : ExtraMatch);
+			if( ExtraMatch >= 15 )
+				Out = WriteLength( Out, ExtraMatch - 15 );
+
+			Pos += MatchLen;
+			Anchor = Pos;
+		}
+
+		// the rest is literals only
+		const int32_t LiteralLen = SrcLen - Anchor;
+		uint8_t* Token = Out++;
+		*Token = (uint8_t)((LiteralLen >= 15 ? 15 : LiteralLen) << 4);
+		if( LiteralLen >= 15 )
+			Out = WriteLength( Out, LiteralLen - 15 );
+		std::memcpy( Out, Src + Anchor, LiteralLen );
+		Out += LiteralLen;
+
+		return Out - Dest;
+	}
+
+	/**
+	   Decompress one block into exactly DestLen bytes. Broken or malicious
+	   input only makes it fail: every length is checked against what is left
+	   of Src or Dest before it is used, a long run of 255 length bytes already
+	   while it is added up, so it can't overflow.
+
+	   @return true if the block decoded to exactly DestLen bytes
+	 */
+	inline bool Decompress( const uint8_t* Src, int32_t SrcLen, uint8_t* Dest, int32_t DestLen )
+	{
+		int32_t In = 0;
+		int32_t Out = 0;
+		while( In < SrcLen )
+		{
+			const uint8_t Token = Src[In++];
+
+			int32_t LiteralLen = Token >> 4;
+			if( LiteralLen == 15 )
+			{
+				uint8_t Byte;
+				do
+				{
+					if( In >= SrcLen )
+						return false;
+					Byte = Src[In++];
+					LiteralLen += Byte;
+					if( LiteralLen > SrcLen - In )
+						return false;
+				} while( Byte == 255 );
+			}
+			if( LiteralLen > SrcLen - In || LiteralLen > DestLen - Out )
+				return false;
+			std::memcpy( Dest + Out, Src + In, LiteralLen );
+			In += LiteralLen;
+			Out += LiteralLen;
+
+			if( In == SrcLen )
+				break; // the last sequence has no match
+
+			if( In + 2 > SrcLen )
+				return false;
+			const int32_t Offset = Src[In] | (Src[In + 1] << 8);
+			In += 2;
+			if( Offset == 0 || Offset > Out )
+				return false;
+
+			int32_t MatchLen = Token & 15;
+			if( MatchLen == 15 )
+			{
+				uint8_t Byte;
+				do
+				{
+					if( In >= SrcLen )
+						return false;
+					Byte = Src[In++];
+					MatchLen += Byte;
+					if( MatchLen > DestLen - Out )
+						return false;
+				} while( Byte == 255 );
+			}
+			MatchLen += MinMatch;
+			if( MatchLen > DestLen - Out )
+				return false;
+
+			// byte-wise, the match may overlap what it is producing
+			const uint8_t* Match = Dest + Out - Offset;
+			for( int32_t Idx = 0; Idx < MatchLen; ++Idx )
+				Dest[Out + Idx] = Match[Idx];
+			Out += MatchLen;
+		}
+		return Out == DestLen;
+	}
+}
@@ -0,0 +1,426 @@
+#pragma once
+// Reading decimal numbers into floats, independent of the engine and locale
+
+#include <cstdint>
+#include <cstring>
+
+/**
+   The numbers of a command, like the 9 of "T=(1.5 -20 3e2) R=... S=...",
+   are read into the float nearest to the decimal text, ties to even. That
+   is what strtof does, so any float the client prints with enough digits
+   ("%.9g", or the shortest repr) comes back as exactly the same float.
+   Unlike strtof the decimal point is always '.', whatever the locale.
+
+   The decimal is first approximated in double, which is correct to a few
+   double ulps. Only when that lands so close to the middle between two
+   floats that it could fall on either side, the decimal is compared with
+   the middle exactly, in big integer arithmetic. That happens for roughly
+   one in ten million random decimals, and not for printed floats.
+ */
+
+namespace m2uFloat
+{
+	/** as many significant digits as fit into a uint64_t */
+	enum { MaxFastDigits = 19 };
+
+	/**
+	 * More digits than any middle between two floats has (those have at most
+	 * 113), so the digits behind them can only tip a tie.
+	 */
+	enum { MaxExactDigits = 128 };
+
+	/** 10^0 to 10^22 are exact in double */
+	inline double PowerOfTen( int32_t Exponent )
+	{
+		static const double Powers[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		return Powers[Exponent];
+	}
+
+	inline float FloatFromBits( uint32_t Bits )
+	{
+		float Value;
+		std::memcpy(&Value, &Bits, sizeof(Value));
+		return Value;
+	}
+
+	inline uint32_t BitsFromFloat( float Value )
+	{
+		uint32_t Bits;
+		std::memcpy(&Bits, &Value, sizeof(Bits));
+		return Bits;
+	}
+
+	/** the positive float with these bits as double, infinity as 2^128 */
+	inline double ValueOfBits( uint32_t Bits )
+	{
+		return Bits == 0x7F800000 ? 340282366920938463463374607431768211456.0 : (double)FloatFromBits(Bits);
+	}
+
+	/**
+	 * An unsigned integer of up to 1536 bits, just enough to compare a decimal
+	 * of MaxExactDigits digits with the middle between two floats.
+	 */
+	class FBigInt
+	{
+	public:
+
+		FBigInt( uint64_t Value = 0 )
+			:NumLimbs(0)
+		{
+			while( Value != 0 )
+			{
+				Limbs[NumLimbs++] = (uint32_t)Value;
+				Value >>= 32;
+			}
+		}
+
+		void MultiplyAdd( uint32_t Factor, uint32_t Addend )
+		{
+			uint64_t Carry = Addend;
+			for( int32_t Idx = 0; Idx < NumLimbs; ++Idx )
+			{
+				const uint64_t Product = (uint64_t)Limbs[Idx] * Factor + Carry;
+				Limbs[Idx] = (uint32_t)Product;
+				Carry = Product >> 32;
+			}
+			if( Carry != 0 )
+			{
+				Limbs[NumLimbs++] = (uint32_t)Carry;
+			}
+		}
+
+		void MultiplyPowerOfFive( int32_t Exponent )
+		{
+			for( ; Exponent >= 13; Exponent -= 13 )
+			{
+				MultiplyAdd(1220703125u, 0); // 5^13
+			}
+			uint32_t Factor = 1;
+			for( ; Exponent > 0; --Exponent )
+			{
+				Factor *= 5;
+			}
+			MultiplyAdd(Factor, 0);
+		}
+
+		void ShiftLeft( int32_t Bits )
+		{
+			if( NumLimbs == 0 )
+				return;
+			const int32_t LimbShift = Bits / 32;
+			const int32_t BitShift = Bits % 32;
+			Limbs[NumLimbs] = 0;
+			for( int32_t Idx = NumLimbs; Idx >= 0; --Idx )
+			{
+				uint32_t Value = Limbs[Idx] << BitShift;
+				if( BitShift != 0 && Idx > 0 )
+				{
+					Value |= Limbs[Idx - 1] >> (32 - BitShift);
+				}
+				Limbs[Idx + LimbShift] = Value;
+			}
+			for( int32_t Idx = 0; Idx < LimbShift; ++Idx )
+			{
+				Limbs[Idx] = 0;
+			}
+			NumLimbs += LimbShift + 1;
+			while( NumLimbs > 0 && Limbs[NumLimbs - 1] == 0 )
+			{
+				--NumLimbs;
+			}
+		}
+
+		/** -1, 0 or 1 */
+		int32_t Compare( const FBigInt& Other ) const
+		{
+			if( NumLimbs != Other.NumLimbs )
+				return NumLimbs < Other.NumLimbs ? -1 : 1;
+			for( int32_t Idx = NumLimbs - 1; Idx >= 0; --Idx )
+			{
+				if( Limbs[Idx] != Other.Limbs[Idx] )
+					return Limbs[Idx] < Other.Limbs[Idx] ? -1 : 1;
+			}
+			return 0;
+		}
+
+	private:
+
+		uint32_t Limbs[48];
+		int32_t NumLimbs;
+	};
+
+	/** the digits of a decimal, where they are in the text */
+	template<typename CharT>
+	struct TDecimal
+	{
+		// the first MaxFastDigits significant digits
+		uint64_t Mantissa;
+		int32_t NumMantissaDigits;
+		// Mantissa * 10^Exponent is the decimal, but for the digits cut off
+		int32_t Exponent;
+		// digits were cut off from Mantissa
+		bool bTruncated;
+		// all digits, maybe with a '.' in between, and the exponent
+		const CharT* Digits;
+		const CharT* DigitsEnd;
+		int32_t ExplicitExponent;
+
+		/** add the next significant digit, one after the point or before it */
+		void AddDigit( uint32_t Digit, bool bFraction )
+		{
+			if( NumMantissaDigits < MaxFastDigits )
+			{
+				Mantissa = Mantissa * 10 + Digit;
+				++NumMantissaDigits;
+				Exponent -= bFraction ? 1 : 0;
+			}
+			else
+			{
+				bTruncated |= Digit != 0;
+				Exponent += bFraction ? 0 : 1;
+			}
+		}
+	};
+
+	/**
+	 * Compare the decimal exactly with Middle * 2^MiddleExponent.
+	 * @return -1, 0 or 1
+	 */
+	template<typename CharT>
+	inline int32_t CompareWithMiddle( const TDecimal<CharT>& Decimal, uint64_t Middle, int32_t MiddleExponent )
+	{
+		// read the digits again, up to MaxExactDigits of them
+		FBigInt Digits;
+		int32_t Exponent = Decimal.ExplicitExponent;
+		int32_t NumDigits = 0;
+		bool bSticky = false;
+		bool bAfterPoint = false;
+		for( const CharT* Str = Decimal.Digits; Str < Decimal.DigitsEnd; ++Str )
+		{
+			if( *Str == '.' )
+			{
+				bAfterPoint = true;
+				continue;
+			}
+			const uint32_t Digit = (uint32_t)*Str - '0';
+			if( NumDigits == 0 && Digit == 0 )
+			{
+				if( bAfterPoint )
+				{
+					--Exponent;
+				}
+				continue;
+			}
+			if( NumDigits < MaxExactDigits )
+			{
+				Digits.MultiplyAdd(10, Digit);
+				++NumDigits;
+				if( bAfterPoint )
+				{
+					--Exponent;
+				}
+			}
+			else
+			{
+				bSticky |= Digit != 0;
+				if( ! bAfterPoint )
+				{
+					++Exponent;
+				}
+			}
+		}
+
+		// Digits * 5^Exponent * 2^Exponent against Middle * 2^MiddleExponent
+		FBigInt Other(Middle);
+		if( Exponent >= 0 )
+		{
+			Digits.MultiplyPowerOfFive(Exponent);
+		}
+		else
+		{
+			Other.MultiplyPowerOfFive(-Exponent);
+		}
+		if( Exponent > MiddleExponent )
+		{
+			Digits.ShiftLeft(Exponent - MiddleExponent);
+		}
+		else
+		{
+			Other.ShiftLeft(MiddleExponent - Exponent);
+		}
+		const int32_t Result = Digits.Compare(Other);
+		return (Result == 0 && bSticky) ? 1 : Result;
+	}
+
+	/** the float nearest to the positive decimal, ties to even */
+	template<typename CharT>
+	inline float ToFloat( const TDecimal<CharT>& Decimal )
+	{
+		if( Decimal.Mantissa == 0 )
+			return 0.0f;
+		// the decimal is below 10^Magnitude and at least a tenth of that
+		const int32_t Magnitude = Decimal.Exponent + Decimal.NumMantissaDigits;
+		if( Magnitude < -46 )
+			return 0.0f; // below half the smallest float
+		if( Magnitude > 40 )
+			return FloatFromBits(0x7F800000);
+
+		// Clinger's fast path: a mantissa and a power of ten that are exact in
+		// double give the correctly rounded double. Rounding that to float is
+		// only wrong if it lands exactly in the middle of two normal floats,
+		// where the low 29 bits are 1 followed by zeros.
+		if( Decimal.Mantissa <= (1ull << 53) && ! Decimal.bTruncated && Decimal.Exponent >= -22 && Decimal.Exponent <= 22 )
+		{
+			const double Value = Decimal.Exponent >= 0 ? (double)Decimal.Mantissa * PowerOfTen(Decimal.Exponent) : (double)Decimal.Mantissa / PowerOfTen(-Decimal.Exponent);
+			uint64_t ValueBits;
+			std::memcpy(&ValueBits, &Value, sizeof(ValueBits));
+			if( Value >= 1.1754943508222875e-38 && (ValueBits & 0x1FFFFFFF) != 0x10000000 )
+				return (float)Value;
+		}
+
+		// at most 4 roundings, each off by half a double ulp
+		double Approximation = (double)Decimal.Mantissa;
+		int32_t Exponent = Decimal.Exponent;
+		for( ; Exponent > 22; Exponent -= 22 )
+		{
+			Approximation *= PowerOfTen(22);
+		}
+		for( ; Exponent < -22; Exponent += 22 )
+		{
+			Approximation /= PowerOfTen(22);
+		}
+		if( Exponent >= 0 )
+		{
+			Approximation *= PowerOfTen(Exponent);
+		}
+		else
+		{
+			Approximation /= PowerOfTen(-Exponent);
+		}
+
+		// the float nearest to the approximation, and its neighbour on the
+		// other side of it
+		const uint32_t Bits = BitsFromFloat((float)Approximation);
+		const double Value = ValueOfBits(Bits);
+		if( Value == Approximation || (Bits == 0x7F800000 && Value < Approximation) )
+			return FloatFromBits(Bits);
+		const uint32_t Lower = Value < Approximation ? Bits : Bits - 1;
+		const double Middle = (ValueOfBits(Lower) + ValueOfBits(Lower + 1)) * 0.5;
+		const double Distance = Approximation > Middle ? Approximation - Middle : Middle - Approximation;
+		if( Distance > Approximation * (1.0 / (1ull << 48)) )
+			return FloatFromBits(Bits);
+
+		// too close to tell, compare with (2 * Lower + 1) * 2^(LowerExponent - 1)
+		const uint32_t LowerExponent = Lower >> 23;
+		const uint64_t LowerMantissa = LowerExponent == 0 ? (Lower & 0x7FFFFF) : ((Lower & 0x7FFFFF) | 0x800000);
+		const int32_t MiddleExponent = (LowerExponent == 0 ? -149 : (int32_t)LowerExponent - 150) - 1;
+		const int32_t Result = CompareWithMiddle(Decimal, 2 * LowerMantissa + 1, MiddleExponent);
+		if( Result < 0 || (Result == 0 && (Lower & 1) == 0) )
+			return FloatFromBits(Lower);
+		return FloatFromBits(Lower + 1);
+	}
+}
+
+
+namespace m2uParse
+{
+	/**
+	 * Read a decimal number like "-12.5", "3e-2" or ".5" at Str, not further
+	 * than End (NULL for the end of the string). There must be no whitespace
+	 * before it.
+	 *
+	 * @return the end of the number, or NULL if there is none, Out is left
+	 * untouched then
+	 */
+	template<typename CharT>
+	inline const CharT* ParseFloat( const CharT* Str, const CharT* End, float& Out )
+	{
+		// with an End there is no zero to stop at, this makes sure it is never
+		// read beyond
+		auto At = [End]( const CharT* Ptr ) -> uint32_t
+		{
+			return (End == NULL || Ptr < End) ? (uint32_t)*Ptr : 0u;
+		};
+
+		bool bNegative = false;
+		if( At(Str) == '-' || At(Str) == '+' )
+		{
+			bNegative = *Str == '-';
+			++Str;
+		}
+
+		m2uFloat::TDecimal<CharT> Decimal;
+		Decimal.Mantissa = 0;
+		Decimal.NumMantissaDigits = 0;
+		Decimal.Exponent = 0;
+		Decimal.bTruncated = false;
+		Decimal.Digits = Str;
+		Decimal.ExplicitExponent = 0;
+
+		// leading zeros only move the point
+		const CharT* IntegerStart = Str;
+		while( At(Str) == '0' )
+		{
+			++Str;
+		}
+		for( uint32_t Digit; (Digit = At(Str) - '0') <= 9; ++Str )
+		{
+			Decimal.AddDigit(Digit, false);
+		}
+		bool bAnyDigits = Str != IntegerStart;
+		if( At(Str) == '.' )
+		{
+			const CharT* FractionStart = ++Str;
+			if( Decimal.NumMantissaDigits == 0 )
+			{
+				for( ; At(Str) == '0'; ++Str )
+				{
+					--Decimal.Exponent;
+				}
+			}
+			for( uint32_t Digit; (Digit = At(Str) - '0') <= 9; ++Str )
+			{
+				Decimal.AddDigit(Digit, true);
+			}
+			bAnyDigits |= Str != FractionStart;
+		}
+		if( ! bAnyDigits )
+			return NULL;
+		Decimal.DigitsEnd = Str;
+
+		const uint32_t E = At(Str);
+		if( E == 'e' || E == 'E' )
+		{
+			// only an exponent if there are digits
+			const CharT* ExponentStr = Str + 1;
+			bool bNegativeExponent = false;
+			if( At(ExponentStr) == '-' || At(ExponentStr) == '+' )
+			{
+				bNegativeExponent = *ExponentStr == '-';
+				++ExponentStr;
+			}
+			if( At(ExponentStr) - '0' <= 9 )
+			{
+				int32_t Exponent = 0;
+				for( uint32_t Digit; (Digit = At(ExponentStr) - '0') <= 9; ++ExponentStr )
+				{
+					// anything beyond this is zero or infinity anyway
+					if( Exponent < 100000 )
+					{
+						Exponent = Exponent * 10 + (int32_t)Digit;
+					}
+				}
+				Decimal.ExplicitExponent = bNegativeExponent ? -Exponent : Exponent;
+				Decimal.Exponent += Decimal.ExplicitExponent;
+				Str = ExponentStr;
+			}
+		}
+
+		const float Value = m2uFloat::ToFloat(Decimal);
+		Out = bNegative ? -Value : Value;
+		return Str;
+	}
+}
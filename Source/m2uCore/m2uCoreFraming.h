@@ -0,0 +1,97 @@
+#pragma once
+// Frame headers of the wire protocol, independent of the engine
+
+#include <cstdint>
+#include <cstring>
+
+/**
+   The layout of a frame, see m2uFraming.h in the plugin for the protocol:
+   | uint32 PayloadLength | uint32 RequestId | uint32 Flags | Payload ... |
+   All header values are little-endian.
+
+   The payload of a frame with M2U_FRAME_FLAG_BINARY is a command whose
+   arguments are binary:
+   | UTF-8 command text | 0 | binary data ... |
+ */
+
+// the handshake a framed client sends before the first frame
+#define M2U_FRAME_MAGIC "m2uF"
+#define M2U_FRAME_MAGIC_SIZE 4
+#define M2U_FRAME_HEADER_SIZE 12
+// frames larger than this are considered a broken stream
+#define M2U_FRAME_MAX_PAYLOAD (64*1024*1024)
+
+#define M2U_FRAME_FLAG_COMPRESSED 0x1
+#define M2U_FRAME_FLAG_CONTROL 0x2
+#define M2U_FRAME_FLAG_ASYNC 0x4
+#define M2U_FRAME_FLAG_TRANSFORMS 0x8
+#define M2U_FRAME_FLAG_BINARY 0x10
+#define M2U_FRAME_KNOWN_FLAGS (M2U_FRAME_FLAG_COMPRESSED | M2U_FRAME_FLAG_CONTROL | M2U_FRAME_FLAG_ASYNC | M2U_FRAME_FLAG_TRANSFORMS | M2U_FRAME_FLAG_BINARY)
+
+
+struct Fm2uFrameHeader
+{
+	uint32_t PayloadLength;
+	uint32_t RequestId;
+	uint32_t Flags;
+};
+
+
+enum class Em2uFrameHeaderError
+{
+	None,
+	InvalidLength,
+	UnknownFlags
+};
+
+
+namespace m2uFraming
+{
+	inline uint32_t ReadUInt32( const uint8_t* Data )
+	{
+		return (uint32_t)Data[0] | ((uint32_t)Data[1] << 8) | ((uint32_t)Data[2] << 16) | ((uint32_t)Data[3] << 24);
+	}
+
+	inline void WriteUInt32( uint8_t* Data, uint32_t Value )
+	{
+		Data[0] = (uint8_t)(Value & 0xFF);
+		Data[1] = (uint8_t)((Value >> 8) & 0xFF);
+		Data[2] = (uint8_t)((Value >> 16) & 0xFF);
+		Data[3] = (uint8_t)((Value >> 24) & 0xFF);
+	}
+
+	/** write the M2U_FRAME_HEADER_SIZE bytes of a frame header to Dest */
+	inline void WriteHeader( uint8_t* Dest, int32_t PayloadLength, uint32_t RequestId, uint32_t Flags )
+	{
+		WriteUInt32( Dest, (uint32_t)PayloadLength );
+		WriteUInt32( Dest + 4, RequestId );
+		WriteUInt32( Dest + 8, Flags );
+	}
+
+	/**
+	   Read the M2U_FRAME_HEADER_SIZE bytes of a frame header from Data.
+	   @return why the header can't be valid, in which case the stream is broken
+	 */
+	inline Em2uFrameHeaderError ReadHeader( const uint8_t* Data, Fm2uFrameHeader& OutHeader )
+	{
+		OutHeader.PayloadLength = ReadUInt32( Data );
+		OutHeader.RequestId = ReadUInt32( Data + 4 );
+		OutHeader.Flags = ReadUInt32( Data + 8 );
+		if( OutHeader.PayloadLength > M2U_FRAME_MAX_PAYLOAD )
+			return Em2uFrameHeaderError::InvalidLength;
+		if( (OutHeader.Flags & ~M2U_FRAME_KNOWN_FLAGS) != 0 )
+			return Em2uFrameHeaderError::UnknownFlags;
+		return Em2uFrameHeaderError::None;
+	}
+
+	/**
+	   The length of the command text of a M2U_FRAME_FLAG_BINARY payload, the
+	   binary data starts behind the zero that ends it.
+	   @return -1 if the zero is missing
+	 */
+	inline int32_t GetBinaryCommandLength( const uint8_t* Payload, int32_t PayloadLength )
+	{
+		const void* Zero = std::memchr( Payload, 0, PayloadLength );
+		return Zero != NULL ? (int32_t)((const uint8_t*)Zero - Payload) : -1;
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+// Finding the handler of a command by its keyword, independent of the engine
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "m2uCoreParse.h"
+
+/**
+ * Maps command keywords like "TransformObject" to a value, ignoring case like
+ * FParse::Command does. Looking up the keyword of a command hashes its first
+ * word once and compares with at most a few keywords, nothing is allocated.
+ * Keywords have to be ASCII.
+ */
+template<typename ValueT>
+class Tm2uKeywordTable
+{
+public:
+
+	Tm2uKeywordTable()
+		:NumKeywords(0),
+		 MaxKeywordLen(0)
+	{}
+
+	/** add a keyword, one that is already there gets the new Value */
+	template<typename CharT>
+	void Add( const CharT* Keyword, ValueT Value )
+	{
+		if( (NumKeywords + 1) * 2 > (int32_t)Slots.size() )
+		{
+			Grow();
+		}
+		std::string Upper;
+		for( ; *Keyword; ++Keyword )
+		{
+			Upper += (char)m2uParse::ToUpper(*Keyword);
+		}
+		if( Upper.empty() || (int32_t)Upper.size() >= (int32_t)MaxLookupLen )
+			return;
+		const uint32_t Hash = HashUpper(Upper.data(), (int32_t)Upper.size());
+		FSlot* Slot = FindSlot(Upper.data(), (int32_t)Upper.size(), Hash);
+		if( ! Slot->bUsed )
+		{
+			Slot->bUsed = true;
+			Slot->Keyword = Upper;
+			Slot->Hash = Hash;
+			++NumKeywords;
+			if( (int32_t)Upper.size() > MaxKeywordLen )
+			{
+				MaxKeywordLen = (int32_t)Upper.size();
+			}
+		}
+		Slot->Value = Value;
+	}
+
+	/** the value of the keyword Word, NULL if it isn't one */
+	template<typename CharT>
+	const ValueT* FindWord( Tm2uTextView<CharT> Word ) const
+	{
+		if( NumKeywords == 0 || Word.Len == 0 || Word.Len > MaxKeywordLen )
+			return NULL;
+		char Upper[MaxLookupLen];
+		for( int32_t Idx = 0; Idx < Word.Len; ++Idx )
+		{
+			const uint32_t C = m2uParse::ToUpper(Word.Data[Idx]);
+			if( C > 127 )
+				return NULL; // can't be a keyword
+			Upper[Idx] = (char)C;
+		}
+		const FSlot* Slot = FindSlot(Upper, Word.Len, HashUpper(Upper, Word.Len));
+		return Slot->bUsed ? &Slot->Value : NULL;
+	}
+
+	/** the value of the first word of the command Cmd, NULL if there is none */
+	template<typename CharT>
+	const ValueT* Find( const CharT* Cmd ) const
+	{
+		return FindWord(m2uParse::FirstWord(Cmd));
+	}
+
+	int32_t Num() const
+	{
+		return NumKeywords;
+	}
+
+private:
+
+	enum { MaxLookupLen = 256 };
+
+	struct FSlot
+	{
+		std::string Keyword; // upper case
+		uint32_t Hash;
+		ValueT Value;
+		bool bUsed;
+
+		FSlot()
+			:Hash(0),
+			 Value(),
+			 bUsed(false)
+		{}
+	};
+
+	/** FNV-1a */
+	static uint32_t HashUpper( const char* Upper, int32_t Len )
+	{
+		uint32_t Hash = 2166136261u;
+		for( int32_t Idx = 0; Idx < Len; ++Idx )
+		{
+			Hash = (Hash ^ (uint8_t)Upper[Idx]) * 16777619u;
+		}
+		return Hash;
+	}
+
+	/** the slot of the keyword, or the free one where it would go */
+	FSlot* FindSlot( const char* Upper, int32_t Len, uint32_t Hash )
+	{
+		return const_cast<FSlot*>(static_cast<const Tm2uKeywordTable*>(this)->FindSlot(Upper, Len, Hash));
+	}
+
+	const FSlot* FindSlot( const char* Upper, int32_t Len, uint32_t Hash ) const
+	{
+		// the table is never more than half full, there always is a free slot
+		const uint32_t Mask = (uint32_t)Slots.size() - 1;
+		for( uint32_t Idx = Hash & Mask; ; Idx = (Idx + 1) & Mask )
+		{
+			const FSlot& Slot = Slots[Idx];
+			if( ! Slot.bUsed )
+				return &Slot;
+			if( Slot.Hash == Hash && (int32_t)Slot.Keyword.size() == Len && Slot.Keyword.compare(0, Len, Upper, Len) == 0 )
+				return &Slot;
+		}
+	}
+
+	void Grow()
+	{
+		std::vector<FSlot> Old;
+		Old.swap(Slots);
+		Slots.resize(Old.empty() ? 16 : Old.size() * 2);
+		for( FSlot& Slot : Old )
+		{
+			if( Slot.bUsed )
+			{
+				*FindSlot(Slot.Keyword.data(), (int32_t)Slot.Keyword.size(), Slot.Hash) = Slot;
+			}
+		}
+	}
+
+	std::vector<FSlot> Slots;
+	int32_t NumKeywords;
+	// longer words can't be keywords, and fit into the lookup buffer
+	int32_t MaxKeywordLen;
+};
@@ -0,0 +1,479 @@
+#pragma once
+// Parsing of command text, independent of the engine
+
+#include <cstddef>
+#include <cstdint>
+
+#include "m2uCoreFloat.h"
+
+/**
+   Commands are plain text like "TransformObject Cube_1 T=(0 0 10)". These
+   functions are what every command goes through. They are templates on the
+   character type, so they work on TCHARs in the editor and on plain chars in
+   the native tests and benchmarks (see CMakeLists.txt in the root).
+
+   They behave like the FParse and FCString functions the operations used
+   before, so commands are understood exactly as they were, but none of them
+   allocates. Results are views into the command text.
+ */
+
+// which parts of a transform a command sets
+#define M2U_TRANSFORM_LOCATION 1
+#define M2U_TRANSFORM_ROTATION 2
+#define M2U_TRANSFORM_SCALE 4
+#define M2U_TRANSFORM_ALL 7
+
+
+/**
+ * A piece of a command, not zero terminated.
+ */
+template<typename CharT>
+struct Tm2uTextView
+{
+	const CharT* Data;
+	int32_t Len;
+
+	Tm2uTextView()
+		:Data(NULL),
+		 Len(0)
+	{}
+
+	Tm2uTextView( const CharT* InData, int32_t InLen )
+		:Data(InData),
+		 Len(InLen)
+	{}
+
+	bool IsEmpty() const
+	{
+		return Len == 0;
+	}
+
+	/** compare with an ASCII string, case sensitive */
+	bool Equals( const char* Other ) const
+	{
+		int32_t Idx = 0;
+		for( ; Idx < Len; ++Idx )
+		{
+			if( Other[Idx] == 0 || (uint32_t)Data[Idx] != (uint32_t)(unsigned char)Other[Idx] )
+				return false;
+		}
+		return Other[Idx] == 0;
+	}
+
+	/** compare with an ASCII string, ignoring case */
+	bool EqualsIgnoreCase( const char* Other ) const;
+
+	/**
+	 * Copy to Dest as zero terminated string, cut off to fit DestSize.
+	 * @return the number of characters copied, without the zero
+	 */
+	int32_t CopyTo( CharT* Dest, int32_t DestSize ) const
+	{
+		if( DestSize <= 0 )
+			return 0;
+		const int32_t Count = Len < DestSize - 1 ? Len : DestSize - 1;
+		for( int32_t Idx = 0; Idx < Count; ++Idx )
+		{
+			Dest[Idx] = Data[Idx];
+		}
+		Dest[Count] = 0;
+		return Count;
+	}
+};
+
+
+/**
+ * What the T=, R= and S= of a transform command set. Parts tells which of
+ * them were there, the others are left untouched.
+ */
+struct Fm2uTransformText
+{
+	uint32_t Parts;
+	float Location[3];
+	// pitch, yaw and roll in degrees
+	float Rotation[3];
+	float Scale[3];
+
+	Fm2uTransformText()
+		:Parts(0)
+	{
+		for( int32_t Idx = 0; Idx < 3; ++Idx )
+		{
+			Location[Idx] = 0.0f;
+			Rotation[Idx] = 0.0f;
+			Scale[Idx] = 1.0f;
+		}
+	}
+};
+
+
+namespace m2uParse
+{
+	/** what FChar::IsWhitespace is for ASCII */
+	template<typename CharT>
+	inline bool IsWhitespace( CharT C )
+	{
+		return C == ' ' || (C >= '\t' && C <= '\r');
+	}
+
+	/**
+	 * Letters, digits and '_'. Anything beyond ASCII counts too, so a word
+	 * never ends in the middle of a name.
+	 */
+	template<typename CharT>
+	inline bool IsWordChar( CharT C )
+	{
+		return (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') || (C >= '0' && C <= '9') || C == '_' || (uint32_t)C > 127;
+	}
+
+	template<typename CharT>
+	inline bool IsAlnum( CharT C )
+	{
+		return (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') || (C >= '0' && C <= '9');
+	}
+
+	template<typename CharT>
+	inline uint32_t ToUpper( CharT C )
+	{
+		return (C >= 'a' && C <= 'z') ? (uint32_t)C - 'a' + 'A' : (uint32_t)C;
+	}
+
+	template<typename CharT>
+	inline int32_t Strlen( const CharT* Str )
+	{
+		const CharT* End = Str;
+		while( *End )
+		{
+			++End;
+		}
+		return (int32_t)(End - Str);
+	}
+
+	template<typename CharT>
+	inline const CharT* SkipWhitespace( const CharT* Str )
+	{
+		while( IsWhitespace(*Str) )
+		{
+			++Str;
+		}
+		return Str;
+	}
+
+	/** compare the first characters of Str with the ASCII Match, ignoring case */
+	template<typename CharT>
+	inline bool StartsWith( const CharT* Str, const char* Match )
+	{
+		for( ; *Match; ++Str, ++Match )
+		{
+			if( ToUpper(*Str) != ToUpper(*Match) )
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Like FParse::Command: if Str starts with the word Match, ignoring case,
+	 * advance Str behind it and the following spaces.
+	 */
+	template<typename CharT>
+	inline bool Command( const CharT*& Str, const char* Match )
+	{
+		const CharT* Cursor = Str;
+		while( *Cursor == ' ' || *Cursor == '\t' )
+		{
+			++Cursor;
+		}
+		if( ! StartsWith(Cursor, Match) )
+			return false;
+		Cursor += Strlen(Match);
+		if( IsWordChar(*Cursor) )
+			return false; // only the beginning of a longer word
+		while( *Cursor == ' ' || *Cursor == '\t' )
+		{
+			++Cursor;
+		}
+		Str = Cursor;
+		return true;
+	}
+
+	/** the first word of Str, the command keyword */
+	template<typename CharT>
+	inline Tm2uTextView<CharT> FirstWord( const CharT* Str )
+	{
+		Str = SkipWhitespace(Str);
+		int32_t Len = 0;
+		while( IsWordChar(Str[Len]) )
+		{
+			++Len;
+		}
+		return Tm2uTextView<CharT>(Str, Len);
+	}
+
+	/**
+	 * Like FParse::Token without escapes: the next run of non-whitespace, or
+	 * everything between double quotes. Str is advanced behind it.
+	 * @return false if there was no token
+	 */
+	template<typename CharT>
+	inline bool Token( const CharT*& Str, Tm2uTextView<CharT>& OutToken )
+	{
+		Str = SkipWhitespace(Str);
+		const CharT* Start;
+		if( *Str == '"' )
+		{
+			Start = ++Str;
+			while( *Str && *Str != '"' )
+			{
+				++Str;
+			}
+			OutToken = Tm2uTextView<CharT>(Start, (int32_t)(Str - Start));
+			if( *Str == '"' )
+			{
+				++Str;
+			}
+		}
+		else
+		{
+			Start = Str;
+			while( *Str && ! IsWhitespace(*Str) )
+			{
+				++Str;
+			}
+			OutToken = Tm2uTextView<CharT>(Start, (int32_t)(Str - Start));
+		}
+		return OutToken.Len != 0;
+	}
+
+	/**
+	 * Like FCString::Strfind: the first place Find is in Str, ignoring case,
+	 * that isn't preceded by a letter or digit. NULL if there is none.
+	 */
+	template<typename CharT>
+	inline const CharT* Strfind( const CharT* Str, const char* Find )
+	{
+		bool bAfterAlnum = false;
+		for( ; *Str; ++Str )
+		{
+			if( ! bAfterAlnum && StartsWith(Str, Find) )
+				return Str;
+			bAfterAlnum = IsAlnum(*Str);
+		}
+		return NULL;
+	}
+
+	/**
+	 * Like FCString::Atof, the number at the beginning of Str, 0 if there is
+	 * none. Reads no further than End, or the end of the string if End is
+	 * NULL. Exact and independent of the locale, see m2uCoreFloat.h.
+	 */
+	template<typename CharT>
+	inline float Atof( const CharT* Str, const CharT* End = NULL )
+	{
+		while( (End == NULL || Str < End) && IsWhitespace(*Str) )
+		{
+			++Str;
+		}
+		float Value = 0.0f;
+		ParseFloat(Str, End, Value);
+		return Value;
+	}
+
+	/**
+	 * Read Count numbers separated by single spaces, like "1.0 2.5 -3", the
+	 * way GetFVECTORSpaceDelimited does.
+	 *
+	 * @return the beginning of the last number, or NULL if there are less
+	 * than Count numbers. The numbers up to there are read anyway.
+	 */
+	template<typename CharT>
+	inline const CharT* ParseFloats( const CharT* Str, float* Out, int32_t Count )
+	{
+		if( Str == NULL )
+			return NULL;
+		for( int32_t Idx = 0; Idx < Count; ++Idx )
+		{
+			if( Idx > 0 )
+			{
+				while( *Str && *Str != ' ' )
+				{
+					++Str;
+				}
+				if( *Str == 0 )
+					return NULL;
+				++Str;
+			}
+			Out[Idx] = Atof(Str);
+		}
+		return Str;
+	}
+}
+
+
+template<typename CharT>
+inline bool Tm2uTextView<CharT>::EqualsIgnoreCase( const char* Other ) const
+{
+	int32_t Idx = 0;
+	for( ; Idx < Len; ++Idx )
+	{
+		if( Other[Idx] == 0 || m2uParse::ToUpper(Data[Idx]) != m2uParse::ToUpper(Other[Idx]) )
+			return false;
+	}
+	return Other[Idx] == 0;
+}
+
+
+/**
+ * Iterates over the items of a python-style list "[name1, name2, name3]", one
+ * at a time, as views into the text. Nothing is allocated or copied.
+ *
+ * The list ends at its closing bracket, the text may go on behind it. Without
+ * an opening bracket it ends at the first whitespace instead, like a token.
+ * Whitespace around the items is dropped, empty items are kept, "[]" has no
+ * items at all. An item in double quotes may contain commas, brackets and
+ * whitespace, and a backslash in it escapes the next character:
+ * ["Wall, north", "say \"hi\""]. The views keep the backslashes, the
+ * Next that copies removes them.
+ */
+template<typename CharT>
+class Tm2uListParser
+{
+public:
+
+	Tm2uListParser( const CharT* Str, int32_t Len )
+		:Cursor(Str),
+		 End(Str + (Len > 0 ? Len : 0)),
+		 bBracketed(false),
+		 bDone(false),
+		 bEscaped(false)
+	{
+		SkipWhitespace();
+		bBracketed = (Cursor < End && *Cursor == '[');
+		if( bBracketed )
+		{
+			++Cursor;
+			SkipWhitespace();
+			bDone = (Cursor == End || *Cursor == ']');
+		}
+		else
+		{
+			bDone = (Cursor == End);
+		}
+	}
+
+	bool Next( Tm2uTextView<CharT>& OutItem )
+	{
+		if( bDone )
+			return false;
+		if( bBracketed )
+		{
+			SkipWhitespace();
+		}
+		bEscaped = false;
+		const CharT* Start = Cursor;
+		const CharT* ItemEnd = Cursor;
+		if( Cursor < End && *Cursor == '"' )
+		{
+			Start = ++Cursor;
+			while( Cursor < End && *Cursor != '"' )
+			{
+				if( *Cursor == '\\' && Cursor + 1 < End )
+				{
+					bEscaped = true;
+					++Cursor;
+				}
+				++Cursor;
+			}
+			ItemEnd = Cursor;
+			// anything between the closing quote and the comma is ignored
+			while( Cursor < End && ! IsSeparator(*Cursor) )
+			{
+				++Cursor;
+			}
+		}
+		else
+		{
+			while( Cursor < End && ! IsSeparator(*Cursor) )
+			{
+				++Cursor;
+			}
+			ItemEnd = Cursor;
+			while( ItemEnd > Start && IsWhitespace(ItemEnd[-1]) )
+			{
+				--ItemEnd;
+			}
+		}
+		OutItem = Tm2uTextView<CharT>(Start, (int32_t)(ItemEnd - Start));
+		if( Cursor < End && *Cursor == ',' )
+		{
+			++Cursor;
+		}
+		else
+		{
+			bDone = true;
+		}
+		return true;
+	}
+
+	/**
+	 * The next item copied to Dest as zero terminated string without its
+	 * escapes, cut off to fit DestSize.
+	 */
+	bool Next( CharT* Dest, int32_t DestSize )
+	{
+		Tm2uTextView<CharT> Item;
+		if( ! Next(Item) )
+			return false;
+		if( ! bEscaped )
+		{
+			Item.CopyTo(Dest, DestSize);
+			return true;
+		}
+		int32_t Count = 0;
+		for( int32_t Idx = 0; Idx < Item.Len && Count < DestSize - 1; ++Idx )
+		{
+			if( Item.Data[Idx] == '\\' && Idx + 1 < Item.Len )
+			{
+				++Idx;
+			}
+			Dest[Count++] = Item.Data[Idx];
+		}
+		if( DestSize > 0 )
+		{
+			Dest[Count] = 0;
+		}
+		return true;
+	}
+
+	/** whether the last item had escapes, which its view still contains */
+	bool HasEscapes() const
+	{
+		return bEscaped;
+	}
+
+private:
+
+	static bool IsWhitespace( CharT C )
+	{
+		return (uint32_t)C <= ' ';
+	}
+
+	bool IsSeparator( CharT C ) const
+	{
+		return C == ',' || (bBracketed ? C == ']' : IsWhitespace(C));
+	}
+
+	void SkipWhitespace()
+	{
+		while( Cursor < End && IsWhitespace(*Cursor) )
+		{
+			++Cursor;
+		}
+	}
+
+	const CharT* Cursor;
+	const CharT* End;
+	bool bBracketed;
+	bool bDone;
+	// the last item had backslash escapes
+	bool bEscaped;
+};
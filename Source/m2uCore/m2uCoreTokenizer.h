@@ -0,0 +1,679 @@
+#pragma once
+// Splitting a command into tokens in one pass, independent of the engine
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "m2uCoreParse.h"
+
+// which instructions classify the characters: 2 AVX2, 1 SSE2, 0 plain C++.
+// The best the compiler targets is used unless it is defined beforehand.
+#ifndef M2U_TOKENIZER_SIMD
+	#if defined(__AVX2__)
+		#define M2U_TOKENIZER_SIMD 2
+	#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define M2U_TOKENIZER_SIMD 1
+	#else
+		#define M2U_TOKENIZER_SIMD 0
+	#endif
+#endif
+
+#if M2U_TOKENIZER_SIMD >= 2
+	#include <immintrin.h>
+#elif M2U_TOKENIZER_SIMD >= 1
+	#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+// tokens up to this many are kept without allocating
+#define M2U_INLINE_TOKENS 32
+
+/**
+   Tm2uTokenTable splits a command once into all of its tokens, so the
+   operations don't have to scan the text again for every value they read.
+
+   A token is what FParse::Token would read: a run of characters up to the
+   next whitespace, or everything between double quotes. Unlike FParse::Token
+   whitespace inside brackets doesn't end a token, so "T=(1 2 3)" and
+   "[a, b]" are one token each. The first '=' of an unquoted token splits it
+   into key and value. All control characters count as whitespace.
+
+   The characters are classified 64 at a time with SSE2 or AVX2, into
+   whitespace and the few that mean something: quotes, brackets and '='. Only
+   at those and at the beginnings of tokens the state machine has to look, a
+   name or number in between is skipped as a whole.
+ */
+struct Fm2uToken
+{
+	// where the token is in the text, without the quotes of a quoted one
+	int32_t Start;
+	int32_t Len;
+	// the length of Key in Key=Value, -1 if there is no '='
+	int32_t KeyLen;
+	bool bQuoted;
+};
+
+
+enum class Em2uTokenizerPath
+{
+	// the SIMD instructions the compiler targets, see M2U_TOKENIZER_SIMD
+	Best,
+	// one character after the other, for comparing
+	Scalar
+};
+
+
+namespace m2uTokenizer
+{
+	/** one bit per character of a block of 64 */
+	struct FBlockMasks
+	{
+		// every character up to ' ', control characters and zeros included
+		uint64_t Whitespace;
+		// quotes, brackets and '='
+		uint64_t Special;
+	};
+
+	inline int32_t CountTrailingZeros( uint64_t Value )
+	{
+#if defined(_MSC_VER)
+		unsigned long Index;
+		_BitScanForward64(&Index, Value);
+		return (int32_t)Index;
+#else
+		return __builtin_ctzll(Value);
+#endif
+	}
+
+	template<typename CharT>
+	inline bool IsSpecial( CharT C )
+	{
+		return C == '"' || C == '(' || C == ')' || C == '[' || C == ']' || C == '=';
+	}
+
+	template<typename CharT>
+	inline void ClassifyScalar( const CharT* Block, FBlockMasks& Out )
+	{
+		Out.Whitespace = 0;
+		Out.Special = 0;
+		for( int32_t Idx = 0; Idx < 64; ++Idx )
+		{
+			const uint32_t C = (uint32_t)Block[Idx];
+			if( C <= ' ' )
+			{
+				Out.Whitespace |= 1ull << Idx;
+			}
+			else if( IsSpecial(C) )
+			{
+				Out.Special |= 1ull << Idx;
+			}
+		}
+	}
+
+#if M2U_TOKENIZER_SIMD >= 2
+	/** one bit per byte of 32 bytes */
+	inline void ClassifyBytes( const uint8_t* Chars, uint32_t& OutWhitespace, uint32_t& OutSpecial )
+	{
+		const __m256i V = _mm256_loadu_si256((const __m256i*)Chars);
+		const __m256i Whitespace = _mm256_cmpeq_epi8(_mm256_subs_epu8(V, _mm256_set1_epi8(' ')), _mm256_setzero_si256());
+		// '(' and ')' only differ in the lowest bit
+		__m256i Special = _mm256_cmpeq_epi8(_mm256_or_si256(V, _mm256_set1_epi8(1)), _mm256_set1_epi8(')'));
+		Special = _mm256_or_si256(Special, _mm256_cmpeq_epi8(V, _mm256_set1_epi8('"')));
+		Special = _mm256_or_si256(Special, _mm256_cmpeq_epi8(V, _mm256_set1_epi8('[')));
+		Special = _mm256_or_si256(Special, _mm256_cmpeq_epi8(V, _mm256_set1_epi8(']')));
+		Special = _mm256_or_si256(Special, _mm256_cmpeq_epi8(V, _mm256_set1_epi8('=')));
+		OutWhitespace = (uint32_t)_mm256_movemask_epi8(Whitespace);
+		OutSpecial = (uint32_t)_mm256_movemask_epi8(Special);
+	}
+
+	inline void ClassifyWords( const __m256i V, __m256i& OutWhitespace, __m256i& OutSpecial )
+	{
+		OutWhitespace = _mm256_cmpeq_epi16(_mm256_subs_epu16(V, _mm256_set1_epi16(' ')), _mm256_setzero_si256());
+		OutSpecial = _mm256_cmpeq_epi16(_mm256_or_si256(V, _mm256_set1_epi16(1)), _mm256_set1_epi16(')'));
+		OutSpecial = _mm256_or_si256(OutSpecial, _mm256_cmpeq_epi16(V, _mm256_set1_epi16('"')));
+		OutSpecial = _mm256_or_si256(OutSpecial, _mm256_cmpeq_epi16(V, _mm256_set1_epi16('[')));
+		OutSpecial = _mm256_or_si256(OutSpecial, _mm256_cmpeq_epi16(V, _mm256_set1_epi16(']')));
+		OutSpecial = _mm256_or_si256(OutSpecial, _mm256_cmpeq_epi16(V, _mm256_set1_epi16('=')));
+	}
+
+	/** one bit per 16 bit character of 32 characters */
+	inline void ClassifyWords( const uint16_t* Chars, uint32_t& OutWhitespace, uint32_t& OutSpecial )
+	{
+		__m256i Whitespace0, Special0, Whitespace1, Special1;
+		ClassifyWords(_mm256_loadu_si256((const __m256i*)Chars), Whitespace0, Special0);
+		ClassifyWords(_mm256_loadu_si256((const __m256i*)(Chars + 16)), Whitespace1, Special1);
+		// packing works per 128 bit lane, put the quarters back in order
+		const __m256i Whitespace = _mm256_permute4x64_epi64(_mm256_packs_epi16(Whitespace0, Whitespace1), 0xD8);
+		const __m256i Special = _mm256_permute4x64_epi64(_mm256_packs_epi16(Special0, Special1), 0xD8);
+		OutWhitespace = (uint32_t)_mm256_movemask_epi8(Whitespace);
+		OutSpecial = (uint32_t)_mm256_movemask_epi8(Special);
+	}
+
+	inline void ClassifySimd( const uint8_t* Block, FBlockMasks& Out )
+	{
+		uint32_t Whitespace[2], Special[2];
+		ClassifyBytes(Block, Whitespace[0], Special[0]);
+		ClassifyBytes(Block + 32, Whitespace[1], Special[1]);
+		Out.Whitespace = (uint64_t)Whitespace[0] | ((uint64_t)Whitespace[1] << 32);
+		Out.Special = (uint64_t)Special[0] | ((uint64_t)Special[1] << 32);
+	}
+
+	inline void ClassifySimd( const uint16_t* Block, FBlockMasks& Out )
+	{
+		uint32_t Whitespace[2], Special[2];
+		ClassifyWords(Block, Whitespace[0], Special[0]);
+		ClassifyWords(Block + 32, Whitespace[1], Special[1]);
+		Out.Whitespace = (uint64_t)Whitespace[0] | ((uint64_t)Whitespace[1] << 32);
+		Out.Special = (uint64_t)Special[0] | ((uint64_t)Special[1] << 32);
+	}
+
+#elif M2U_TOKENIZER_SIMD >= 1
+	/** one bit per byte of 16 bytes */
+	inline void ClassifyBytes( const uint8_t* Chars, uint32_t& OutWhitespace, uint32_t& OutSpecial )
+	{
+		const __m128i V = _mm_loadu_si128((const __m128i*)Chars);
+		const __m128i Whitespace = _mm_cmpeq_epi8(_mm_subs_epu8(V, _mm_set1_epi8(' ')), _mm_setzero_si128());
+		// '(' and ')' only differ in the lowest bit
+		__m128i Special = _mm_cmpeq_epi8(_mm_or_si128(V, _mm_set1_epi8(1)), _mm_set1_epi8(')'));
+		Special = _mm_or_si128(Special, _mm_cmpeq_epi8(V, _mm_set1_epi8('"')));
+		Special = _mm_or_si128(Special, _mm_cmpeq_epi8(V, _mm_set1_epi8('[')));
+		Special = _mm_or_si128(Special, _mm_cmpeq_epi8(V, _mm_set1_epi8(']')));
+		Special = _mm_or_si128(Special, _mm_cmpeq_epi8(V, _mm_set1_epi8('=')));
+		OutWhitespace = (uint32_t)_mm_movemask_epi8(Whitespace);
+		OutSpecial = (uint32_t)_mm_movemask_epi8(Special);
+	}
+
+	inline void ClassifyWords( const __m128i V, __m128i& OutWhitespace, __m128i& OutSpecial )
+	{
+		OutWhitespace = _mm_cmpeq_epi16(_mm_subs_epu16(V, _mm_set1_epi16(' ')), _mm_setzero_si128());
+		OutSpecial = _mm_cmpeq_epi16(_mm_or_si128(V, _mm_set1_epi16(1)), _mm_set1_epi16(')'));
+		OutSpecial = _mm_or_si128(OutSpecial, _mm_cmpeq_epi16(V, _mm_set1_epi16('"')));
+		OutSpecial = _mm_or_si128(OutSpecial, _mm_cmpeq_epi16(V, _mm_set1_epi16('[')));
+		OutSpecial = _mm_or_si128(OutSpecial, _mm_cmpeq_epi16(V, _mm_set1_epi16(']')));
+		OutSpecial = _mm_or_si128(OutSpecial, _mm_cmpeq_epi16(V, _mm_set1_epi16('=')));
+	}
+
+	/** one bit per 16 bit character of 16 characters */
+	inline void ClassifyWords( const uint16_t* Chars, uint32_t& OutWhitespace, uint32_t& OutSpecial )
+	{
+		__m128i Whitespace0, Special0, Whitespace1, Special1;
+		ClassifyWords(_mm_loadu_si128((const __m128i*)Chars), Whitespace0, Special0);
+		ClassifyWords(_mm_loadu_si128((const __m128i*)(Chars + 8)), Whitespace1, Special1);
+		// the lanes are all ones or zeros, packing keeps that
+		OutWhitespace = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(Whitespace0, Whitespace1));
+		OutSpecial = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(Special0, Special1));
+	}
+
+	inline void ClassifySimd( const uint8_t* Block, FBlockMasks& Out )
+	{
+		Out.Whitespace = 0;
+		Out.Special = 0;
+		for( int32_t Offset = 0; Offset < 64; Offset += 16 )
+		{
+			uint32_t Whitespace, Special;
+			ClassifyBytes(Block + Offset, Whitespace, Special);
+			Out.Whitespace |= (uint64_t)Whitespace << Offset;
+			Out.Special |= (uint64_t)Special << Offset;
+		}
+	}
+
+	inline void ClassifySimd( const uint16_t* Block, FBlockMasks& Out )
+	{
+		Out.Whitespace = 0;
+		Out.Special = 0;
+		for( int32_t Offset = 0; Offset < 64; Offset += 16 )
+		{
+			uint32_t Whitespace, Special;
+			ClassifyWords(Block + Offset, Whitespace, Special);
+			Out.Whitespace |= (uint64_t)Whitespace << Offset;
+			Out.Special |= (uint64_t)Special << Offset;
+		}
+	}
+#endif
+
+	/** classify 64 characters, with SIMD where there is a version for the character size */
+	template<typename CharT>
+	inline void Classify( const CharT* Block, FBlockMasks& Out, Em2uTokenizerPath Path )
+	{
+#if M2U_TOKENIZER_SIMD >= 1
+		if( Path == Em2uTokenizerPath::Best )
+		{
+			if( sizeof(CharT) == 1 )
+			{
+				ClassifySimd((const uint8_t*)Block, Out);
+				return;
+			}
+			if( sizeof(CharT) == 2 )
+			{
+				ClassifySimd((const uint16_t*)Block, Out);
+				return;
+			}
+		}
+#else
+		(void)Path;
+#endif
+		ClassifyScalar(Block, Out);
+	}
+}
+
+
+template<typename CharT>
+class Tm2uTokenTable
+{
+public:
+
+	Tm2uTokenTable()
+		:Text(NULL),
+		 TextLen(0),
+		 SplitEnd(0),
+		 NumTokens(0)
+	{}
+
+	/** split the zero terminated Str */
+	explicit Tm2uTokenTable( const CharT* Str )
+		:Tm2uTokenTable()
+	{
+		Tokenize(Str, m2uParse::Strlen(Str));
+	}
+
+	/**
+	 * Split the first Len characters of Str, the text has to stay around as
+	 * long as the tokens are used. It doesn't need to be zero terminated, so
+	 * a line of a bigger text can be split without copying it.
+	 */
+	void Tokenize( const CharT* Str, int32_t Len, Em2uTokenizerPath Path = Em2uTokenizerPath::Best )
+	{
+		Reset(Str, Len);
+		Split(Path, INT32_MAX);
+	}
+
+	/**
+	 * Split only up to the first MaxTokens tokens of Str, the text behind
+	 * them isn't looked at until TokenizeRest. Enough to find the keyword of
+	 * a command that may be megabytes long.
+	 */
+	void TokenizeFirst( const CharT* Str, int32_t Len, int32_t MaxTokens )
+	{
+		Reset(Str, Len);
+		Split(Em2uTokenizerPath::Best, MaxTokens > 0 ? MaxTokens : 1);
+	}
+
+	/** split what TokenizeFirst left, does nothing if all is split already */
+	void TokenizeRest()
+	{
+		Split(Em2uTokenizerPath::Best, INT32_MAX);
+	}
+
+	int32_t Num() const
+	{
+		return NumTokens;
+	}
+
+	const Fm2uToken& GetToken( int32_t Idx ) const
+	{
+		return Idx < M2U_INLINE_TOKENS ? InlineTokens[Idx] : MoreTokens[Idx - M2U_INLINE_TOKENS];
+	}
+
+	/** the whole token, a quoted one without the quotes */
+	Tm2uTextView<CharT> Get( int32_t Idx ) const
+	{
+		const Fm2uToken& Token = GetToken(Idx);
+		return Tm2uTextView<CharT>(Text + Token.Start, Token.Len);
+	}
+
+	/** Key of a Key=Value token, empty if it has no '=' */
+	Tm2uTextView<CharT> GetKey( int32_t Idx ) const
+	{
+		const Fm2uToken& Token = GetToken(Idx);
+		return Tm2uTextView<CharT>(Text + Token.Start, Token.KeyLen > 0 ? Token.KeyLen : 0);
+	}
+
+	/** Value of a Key=Value token, without quotes around it */
+	Tm2uTextView<CharT> GetValue( int32_t Idx ) const
+	{
+		const Fm2uToken& Token = GetToken(Idx);
+		if( Token.KeyLen < 0 )
+			return Tm2uTextView<CharT>();
+		const CharT* Value = Text + Token.Start + Token.KeyLen + 1;
+		int32_t ValueLen = Token.Len - Token.KeyLen - 1;
+		if( ValueLen > 0 && *Value == '"' )
+		{
+			++Value;
+			--ValueLen;
+			if( ValueLen > 0 && Value[ValueLen - 1] == '"' )
+			{
+				--ValueLen;
+			}
+		}
+		return Tm2uTextView<CharT>(Value, ValueLen);
+	}
+
+	/**
+	 * Find the first Key=Value token from FirstToken on with the key Key,
+	 * ignoring case, like FParse::Value does.
+	 * @return the index of the token, or -1
+	 */
+	int32_t Find( const char* Key, int32_t FirstToken = 0 ) const
+	{
+		for( int32_t Idx = FirstToken; Idx < NumTokens; ++Idx )
+		{
+			const Fm2uToken& Token = GetToken(Idx);
+			if( Token.KeyLen > 0 && GetKey(Idx).EqualsIgnoreCase(Key) )
+				return Idx;
+		}
+		return -1;
+	}
+
+	/** the command keyword, the word at the beginning of the first token */
+	Tm2uTextView<CharT> GetKeyword() const
+	{
+		if( NumTokens == 0 || GetToken(0).bQuoted )
+			return Tm2uTextView<CharT>();
+		const Tm2uTextView<CharT> First = Get(0);
+		int32_t Len = 0;
+		while( Len < First.Len && m2uParse::IsWordChar(First.Data[Len]) )
+		{
+			++Len;
+		}
+		return Tm2uTextView<CharT>(First.Data, Len);
+	}
+
+	/** the text that was split */
+	const CharT* GetText() const
+	{
+		return Text;
+	}
+
+	int32_t GetTextLen() const
+	{
+		return TextLen;
+	}
+
+private:
+
+	void Reset( const CharT* Str, int32_t Len )
+	{
+		Text = Str;
+		TextLen = Len;
+		SplitEnd = 0;
+		NumTokens = 0;
+		MoreTokens.clear();
+	}
+
+	/**
+	 * Continue at SplitEnd until MaxTokens tokens are there. A token is
+	 * always complete when it stops, so nothing of the state is carried over.
+	 */
+	void Split( Em2uTokenizerPath Path, int32_t MaxTokens )
+	{
+		const CharT* Str = Text;
+		const int32_t Len = TextLen;
+		FState State;
+		for( int32_t BlockStart = SplitEnd; BlockStart < Len && NumTokens < MaxTokens; BlockStart += 64 )
+		{
+			const int32_t BlockLen = Len - BlockStart < 64 ? Len - BlockStart : 64;
+			const CharT* Block = Str + BlockStart;
+			CharT Padded[64];
+			if( BlockLen < 64 )
+			{
+				// never read beyond the text
+				std::memcpy(Padded, Block, BlockLen * sizeof(CharT));
+				for( int32_t Idx = BlockLen; Idx < 64; ++Idx )
+				{
+					Padded[Idx] = ' ';
+				}
+				Block = Padded;
+			}
+			m2uTokenizer::FBlockMasks Masks;
+			m2uTokenizer::Classify(Block, Masks, Path);
+
+			// Jump from one character that matters to the next: between tokens
+			// that is the next non-whitespace, inside brackets or quotes the
+			// next special character, otherwise also the whitespace that ends
+			// the token.
+			const uint64_t NonWhitespace = ~Masks.Whitespace;
+			const uint64_t Ends = Masks.Whitespace | Masks.Special;
+			uint64_t Pending = BlockLen < 64 ? (1ull << BlockLen) - 1 : ~0ull;
+			for( ;; )
+			{
+				uint64_t Next;
+				if( ! State.bInToken )
+				{
+					Next = NonWhitespace & Pending;
+				}
+				else if( State.bInQuotes || State.Depth > 0 )
+				{
+					Next = Masks.Special & Pending;
+				}
+				else
+				{
+					Next = Ends & Pending;
+				}
+				if( Next == 0 )
+					break;
+				const int32_t Idx = m2uTokenizer::CountTrailingZeros(Next);
+				// forget this and everything before it
+				Pending &= ~(~0ull >> (63 - Idx));
+				Step(State, BlockStart + Idx, Str[BlockStart + Idx]);
+				if( NumTokens >= MaxTokens )
+				{
+					SplitEnd = BlockStart + Idx + 1;
+					return;
+				}
+			}
+		}
+		if( State.bInToken )
+		{
+			EndToken(State, Len);
+		}
+		SplitEnd = Len;
+	}
+
+	struct FState
+	{
+		bool bInToken;
+		bool bInQuotes;
+		int32_t Depth;
+		int32_t Start;
+		int32_t KeyLen;
+		bool bQuoted;
+
+		FState()
+			:bInToken(false),
+			 bInQuotes(false),
+			 Depth(0),
+			 Start(0),
+			 KeyLen(-1),
+			 bQuoted(false)
+		{}
+	};
+
+	/** look at the character C at Pos, which may change the state */
+	void Step( FState& State, int32_t Pos, CharT C )
+	{
+		if( State.bInQuotes )
+		{
+			if( C == '"' )
+			{
+				State.bInQuotes = false;
+				if( State.bQuoted )
+				{
+					// like FParse::Token, a quoted token ends with its quote
+					EndToken(State, Pos);
+				}
+			}
+			return;
+		}
+		if( ! State.bInToken )
+		{
+			State.bInToken = true;
+			State.Depth = 0;
+			State.KeyLen = -1;
+			State.bQuoted = (C == '"');
+			State.Start = State.bQuoted ? Pos + 1 : Pos;
+			if( State.bQuoted )
+			{
+				State.bInQuotes = true;
+				return;
+			}
+			if( ! m2uTokenizer::IsSpecial(C) )
+				return;
+		}
+		switch( C )
+		{
+		case '"':
+			State.bInQuotes = true;
+			break;
+		case '(':
+		case '[':
+			++State.Depth;
+			break;
+		case ')':
+		case ']':
+			if( State.Depth > 0 )
+			{
+				--State.Depth;
+			}
+			break;
+		case '=':
+			if( State.Depth == 0 && State.KeyLen < 0 )
+			{
+				State.KeyLen = Pos - State.Start;
+			}
+			break;
+		default:
+			// whitespace, only looked at outside of brackets
+			EndToken(State, Pos);
+			break;
+		}
+	}
+
+	void EndToken( FState& State, int32_t End )
+	{
+		Fm2uToken Token;
+		Token.Start = State.Start;
+		Token.Len = End - State.Start;
+		Token.KeyLen = State.bQuoted ? -1 : State.KeyLen;
+		Token.bQuoted = State.bQuoted;
+		if( NumTokens < M2U_INLINE_TOKENS )
+		{
+			InlineTokens[NumTokens] = Token;
+		}
+		else
+		{
+			MoreTokens.push_back(Token);
+		}
+		++NumTokens;
+		State.bInToken = false;
+	}
+
+	const CharT* Text;
+	int32_t TextLen;
+	// where splitting stopped, TextLen once everything is split
+	int32_t SplitEnd;
+	int32_t NumTokens;
+	Fm2uToken InlineTokens[M2U_INLINE_TOKENS];
+	std::vector<Fm2uToken> MoreTokens;
+};
+
+
+namespace m2uParse
+{
+	/**
+	 * Read up to Count numbers separated by whitespace from Value, which may
+	 * be in brackets: "(1.0 2.5 -3)".
+	 * @return how many there were
+	 */
+	template<typename CharT>
+	inline int32_t ParseFloats( Tm2uTextView<CharT> Value, float* Out, int32_t Count )
+	{
+		const CharT* Str = Value.Data;
+		const CharT* End = Value.Data + Value.Len;
+		if( Str < End && *Str == '(' )
+		{
+			++Str;
+		}
+		int32_t Num = 0;
+		while( Num < Count )
+		{
+			while( Str < End && IsWhitespace(*Str) )
+			{
+				++Str;
+			}
+			if( Str == End || *Str == ')' )
+				break;
+			Out[Num++] = Atof(Str, End);
+			while( Str < End && ! IsWhitespace(*Str) && *Str != ')' )
+			{
+				++Str;
+			}
+		}
+		return Num;
+	}
+
+	/** which of T=, R= and S= the tokens from FirstToken on set */
+	template<typename CharT>
+	inline uint32_t GetTransformParts( const Tm2uTokenTable<CharT>& Tokens, int32_t FirstToken = 0 )
+	{
+		uint32_t Parts = 0;
+		for( int32_t Idx = FirstToken; Idx < Tokens.Num(); ++Idx )
+		{
+			if( Tokens.GetToken(Idx).KeyLen != 1 )
+				continue;
+			switch( ToUpper(*Tokens.Get(Idx).Data) )
+			{
+			case 'T': Parts |= M2U_TRANSFORM_LOCATION; break;
+			case 'R': Parts |= M2U_TRANSFORM_ROTATION; break;
+			case 'S': Parts |= M2U_TRANSFORM_SCALE; break;
+			}
+		}
+		return Parts;
+	}
+
+	/**
+	 * Read the transform of the tokens from FirstToken on, T=(x y z)
+	 * R=(p y r) S=(x y z), each of them optional, in any order. All of them
+	 * in a single pass over the tokens.
+	 */
+	template<typename CharT>
+	inline void ParseTransform( const Tm2uTokenTable<CharT>& Tokens, Fm2uTransformText& Out, int32_t FirstToken = 0 )
+	{
+		Out.Parts = 0;
+		for( int32_t Idx = FirstToken; Idx < Tokens.Num(); ++Idx )
+		{
+			if( Tokens.GetToken(Idx).KeyLen != 1 )
+				continue;
+			const uint32_t Part = ToUpper(*Tokens.Get(Idx).Data);
+			if( Part == 'T' && ! (Out.Parts & M2U_TRANSFORM_LOCATION) )
+			{
+				ParseFloats(Tokens.GetValue(Idx), Out.Location, 3);
+				Out.Parts |= M2U_TRANSFORM_LOCATION;
+			}
+			else if( Part == 'R' && ! (Out.Parts & M2U_TRANSFORM_ROTATION) )
+			{
+				ParseFloats(Tokens.GetValue(Idx), Out.Rotation, 3);
+				Out.Parts |= M2U_TRANSFORM_ROTATION;
+			}
+			else if( Part == 'S' && ! (Out.Parts & M2U_TRANSFORM_SCALE) )
+			{
+				ParseFloats(Tokens.GetValue(Idx), Out.Scale, 3);
+				Out.Parts |= M2U_TRANSFORM_SCALE;
+			}
+		}
+	}
+
+	/** like FCString::ToBool: true, yes and on, or a number that isn't 0 */
+	template<typename CharT>
+	inline bool ToBool( Tm2uTextView<CharT> Value )
+	{
+		if( Value.EqualsIgnoreCase("True") || Value.EqualsIgnoreCase("Yes") || Value.EqualsIgnoreCase("On") )
+			return true;
+		if( Value.EqualsIgnoreCase("False") || Value.EqualsIgnoreCase("No") || Value.EqualsIgnoreCase("Off") )
+			return false;
+		return (int32_t)Atof(Value.Data, Value.Data + Value.Len) != 0;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "Commandlets/Commandlet.h"
+#include "m2uBenchCommandlet.generated.h"
+
+
+/**
+   Measures how fast the operations execute typical m2u workloads, without a
+   client and without a human driving Maya. Run it in a headless editor:
+
+     UE4Editor <Project> -run=m2uBench -nullrhi [-Scale=1.0] [-Asset=<path>]
+                         [-Output=<file>]
+
+   The commands go straight to the operation manager, so only the editor side
+   is measured, not the network. The results are written as JSON, by default
+   to Saved/Profiling/m2uBench.json, with the number of commands, ops per
+   second and latency percentiles per workload:
+
+     {"format":1,"engine":"4.12.5-...","scale":1.0,"workloads":[
+       {"name":"AddActor","count":10000,"seconds":12.3,"ops_per_sec":813.0,
+        "p50_ms":1.19,"p95_ms":1.68,"p99_ms":2.00,"max_ms":9.31}, ...]}
+
+   -Scale multiplies the number of commands of every workload.
+ */
+UCLASS()
+class Um2uBenchCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet Interface
+};
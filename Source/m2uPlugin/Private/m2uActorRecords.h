@@ -0,0 +1,113 @@
+#pragma once
+// Binary actor records of AddActorBatch and TransformObject
+
+#include "m2uUtf8.h"
+// the layout, see there
+#include "m2uCoreActorRecords.h"
+
+/**
+   A framed client can send "AddActorBatch" and "TransformObject" as binary
+   commands (M2U_FRAME_FLAG_BINARY, see m2uFraming.h), with all actors as
+   records instead of one text line per actor. The assets are only named once
+   and every transform is 9 or 10 floats, bit exact and without parsing.
+
+   "AddActorBatch" adds an actor with the name of every record from its asset,
+   or edits the existing one like "AddActor Asset Name EditIfExists=true"
+   does. Records without asset only edit. "TransformObject" sets the transform
+   of every named actor, the assets are ignored. Both answer with the list of
+   resulting names "[Name1,Name2,...]", empty names for records that failed.
+ */
+
+/** all records of one command, decoded */
+struct Fm2uActorRecords
+{
+	TArray<FString> AssetPaths;
+	// into AssetPaths, INDEX_NONE for records without asset
+	TArray<int32> AssetIndices;
+	TArray<FString> Names;
+	TArray<FTransform> Transforms;
+};
+
+
+namespace m2uActorRecords
+{
+	inline FTransform MakeTransform( const float* Values, int32 FloatsPerRecord )
+	{
+		const FVector Location( Values[0], Values[1], Values[2] );
+		FQuat Rotation;
+		if( FloatsPerRecord == 9 )
+		{
+			Rotation = FRotator( Values[3], Values[4], Values[5] ).Quaternion();
+		}
+		else
+		{
+			Rotation = FQuat( Values[3], Values[4], Values[5], Values[6] );
+			Rotation.Normalize();
+		}
+		const float* ScaleValues = Values + FloatsPerRecord - 3;
+		return FTransform( Rotation, Location, FVector( ScaleValues[0], ScaleValues[1], ScaleValues[2] ) );
+	}
+
+	/**
+	   Decode the binary data of a command into Out, replacing its contents.
+	   @return false if the data is malformed
+	 */
+	inline bool Decode( const uint8* Data, int32 Num, Fm2uActorRecords& Out )
+	{
+		Fm2uActorRecordsReader Reader;
+		const Em2uActorRecordsError Error = Reader.Init( Data, Num );
+		if( Error != Em2uActorRecordsError::None )
+		{
+			UE_LOG(LogM2U, Error, TEXT("Malformed actor records (error %i)."), (int32)Error);
+			return false;
+		}
+		const int32 NumRecords = Reader.GetNumRecords();
+		const int32 FloatsPerRecord = Reader.GetFloatsPerRecord();
+
+		Out.AssetPaths.SetNum( Reader.GetNumAssets() );
+		int32 Offset = Reader.GetAssetsOffset();
+		for( FString& Path : Out.AssetPaths )
+		{
+			const Tm2uTextView<char> Utf8 = Reader.ReadString( Offset );
+			m2uUtf8::DecodeToString( (const uint8*)Utf8.Data, Utf8.Len, Path );
+		}
+		Out.Names.SetNum( NumRecords );
+		Offset = Reader.GetNamesOffset();
+		for( FString& Name : Out.Names )
+		{
+			const Tm2uTextView<char> Utf8 = Reader.ReadString( Offset );
+			m2uUtf8::DecodeToString( (const uint8*)Utf8.Data, Utf8.Len, Name );
+		}
+
+		Out.AssetIndices.SetNumUninitialized( NumRecords );
+		Out.Transforms.SetNumUninitialized( NumRecords );
+		// the floats in chunks, straight from the payload
+		float Values[64 * 10];
+		for( int32 First = 0; First < NumRecords; First += 64 )
+		{
+			const int32 Count = FMath::Min( 64, NumRecords - First );
+			Reader.GetValues( First, Count, Values );
+			for( int32 Idx = 0; Idx < Count; ++Idx )
+			{
+				const uint32 AssetIndex = Reader.GetAssetIndex( First + Idx );
+				Out.AssetIndices[First + Idx] = AssetIndex == M2U_ACTOR_RECORD_NO_ASSET ? INDEX_NONE : (int32)AssetIndex;
+				Out.Transforms[First + Idx] = MakeTransform( Values + Idx * FloatsPerRecord, FloatsPerRecord );
+			}
+		}
+		return true;
+	}
+
+	/** the answer to a binary command, the resulting names as list */
+	inline FString MakeNameList( const TArray<FString>& Names )
+	{
+		FString Result = TEXT("[");
+		for( int32 Idx = 0; Idx < Names.Num(); ++Idx )
+		{
+			if( Idx > 0 )
+				Result += TEXT(",");
+			Result += Names[Idx];
+		}
+		Result += TEXT("]");
+		return Result;
+	}
+}
@@ -0,0 +1,161 @@
+#include "m2uPluginPrivatePCH.h"
+#include "m2uBenchCommandlet.h"
+#include "m2uInvalidation.h"
+#include "m2uStats.h"
+
+namespace
+{
+	// the engine's cube, it is there in every project
+	const TCHAR* DefaultBenchAsset = TEXT("/Engine/BasicShapes/Cube");
+
+	struct Fm2uBenchResult
+	{
+		FString Name;
+		double Seconds;
+		Fm2uLatencyHistogram Latency;
+	};
+
+	/**
+	 * Execute all Commands one after the other, like the plugin would in a tick,
+	 * and time each one. The editor is updated once at the end.
+	 */
+	Fm2uBenchResult RunWorkload( Fm2uOperationManager* Manager, const TCHAR* Name, const TArray<FString>& Commands )
+	{
+		UE_LOG(LogM2U, Display, TEXT("m2uBench: %s, %i commands"), Name, Commands.Num());
+		Fm2uBenchResult Result;
+		Result.Name = Name;
+		const double StartTime = FPlatformTime::Seconds();
+		for( const FString& Command : Commands )
+		{
+			const double CommandStartTime = FPlatformTime::Seconds();
+			Manager->Execute(*Command);
+			Result.Latency.Add(FPlatformTime::Seconds() - CommandStartTime);
+		}
+		m2uInvalidation::Get().Flush();
+		Result.Seconds = FPlatformTime::Seconds() - StartTime;
+		return Result;
+	}
+
+	/** "[m2uBench_First,...,m2uBench_First+Count-1]" */
+	FString MakeNameList( int32 First, int32 Count )
+	{
+		FString List = TEXT("[");
+		for( int32 Idx = First; Idx < First + Count; ++Idx )
+		{
+			if( Idx > First )
+				List += TEXT(",");
+			List += FString::Printf(TEXT("m2uBench_%i"), Idx);
+		}
+		List += TEXT("]");
+		return List;
+	}
+
+	FString ToJson( const TArray<Fm2uBenchResult>& Results, float Scale )
+	{
+		FString Json = FString::Printf(TEXT("{\"format\":1,\"engine\":\"%s\",\"scale\":%g,\"workloads\":["),
+			*FEngineVersion::Current().ToString(), Scale);
+		for( int32 Idx = 0; Idx < Results.Num(); ++Idx )
+		{
+			const Fm2uBenchResult& Result = Results[Idx];
+			const uint32 Count = Result.Latency.GetCount();
+			Json += FString::Printf(TEXT("%s\n  {\"name\":\"%s\",\"count\":%u,\"seconds\":%.6f,\"ops_per_sec\":%.1f,\"p50_ms\":%.4f,\"p95_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f}"),
+				Idx > 0 ? TEXT(",") : TEXT(""),
+				*Result.Name,
+				Count,
+				Result.Seconds,
+				Result.Seconds > 0.0 ? Count / Result.Seconds : 0.0,
+				Result.Latency.GetPercentile(0.50) * 1000.0,
+				Result.Latency.GetPercentile(0.95) * 1000.0,
+				Result.Latency.GetPercentile(0.99) * 1000.0,
+				Result.Latency.GetMaxSeconds() * 1000.0);
+		}
+		Json += TEXT("\n]}\n");
+		return Json;
+	}
+}
+
+
+Um2uBenchCommandlet::Um2uBenchCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 Um2uBenchCommandlet::Main(const FString& Params)
+{
+	const TCHAR* Parms = *Params;
+	float Scale = 1.0f;
+	FParse::Value(Parms, TEXT("Scale="), Scale);
+	FString Asset = DefaultBenchAsset;
+	FParse::Value(Parms, TEXT("Asset="), Asset);
+	FString Output = FPaths::ProfilingDir() / TEXT("m2uBench.json");
+	FParse::Value(Parms, TEXT("Output="), Output);
+
+	Fm2uOperationManager* Manager = Fm2uPlugin::Get().GetOperationManager();
+	if( Manager == NULL || GEditor == NULL )
+	{
+		UE_LOG(LogM2U, Error, TEXT("m2uBench needs the editor, run it with UE4Editor."));
+		return 1;
+	}
+
+	const int32 NumActors = FMath::Max(1, (int32)(10000 * Scale));
+	const int32 NumTransforms = FMath::Max(1, (int32)(100000 * Scale));
+	const int32 NumDuplicates = FMath::Max(1, (int32)(1000 * Scale));
+	// names per list command, like a selection in Maya
+	const int32 ListSize = FMath::Min(100, NumActors);
+
+	TArray<Fm2uBenchResult> Results;
+	TArray<FString> Commands;
+
+	for( int32 Idx = 0; Idx < NumActors; ++Idx )
+	{
+		Commands.Add(FString::Printf(TEXT("AddActor %s m2uBench_%i T=(%i 0 0)"), *Asset, Idx, Idx * 100));
+	}
+	Results.Add(RunWorkload(Manager, TEXT("AddActor"), Commands));
+	Commands.Reset();
+
+	FRandomStream Random(3939); // the same workload every run
+	for( int32 Idx = 0; Idx < NumTransforms; ++Idx )
+	{
+		Commands.Add(FString::Printf(TEXT("TransformObject m2uBench_%i T=(%.3f %.3f %.3f) R=(0 %.3f 0) S=(1 1 1)"),
+			Idx % NumActors, Random.FRandRange(-5000, 5000), Random.FRandRange(-5000, 5000), Random.FRandRange(0, 500), Random.FRandRange(0, 360)));
+	}
+	Results.Add(RunWorkload(Manager, TEXT("TransformObject"), Commands));
+	Commands.Reset();
+
+	for( int32 Idx = 0; Idx + ListSize <= NumActors; Idx += ListSize )
+	{
+		Commands.Add(FString::Printf(TEXT("AddObjectsToLayer m2uBenchLayer%i %s"), (Idx / ListSize) % 10, *MakeNameList(Idx, ListSize)));
+	}
+	Results.Add(RunWorkload(Manager, TEXT("AddObjectsToLayer"), Commands));
+	Commands.Reset();
+
+	for( int32 Idx = 0; Idx + ListSize <= NumActors; Idx += ListSize )
+	{
+		Commands.Add(FString::Printf(TEXT("SelectByNames %s"), *MakeNameList(Idx, ListSize)));
+		Commands.Add(FString::Printf(TEXT("DeselectByNames %s"), *MakeNameList(Idx, ListSize / 2)));
+		Commands.Add(TEXT("DeselectAll"));
+	}
+	Results.Add(RunWorkload(Manager, TEXT("SelectDeselect"), Commands));
+	Commands.Reset();
+
+	for( int32 Idx = 0; Idx < NumDuplicates; ++Idx )
+	{
+		Commands.Add(FString::Printf(TEXT("DuplicateObject m2uBench_%i m2uBenchDup_%i T=(%i 500 0)"), Idx % NumActors, Idx, Idx * 100));
+	}
+	Results.Add(RunWorkload(Manager, TEXT("DuplicateObject"), Commands));
+	Commands.Reset();
+
+	const FString Json = ToJson(Results, Scale);
+	UE_LOG(LogM2U, Display, TEXT("m2uBench results:\n%s"), *Json);
+	if( ! FFileHelper::SaveStringToFile(Json, *Output) )
+	{
+		UE_LOG(LogM2U, Error, TEXT("Could not write %s"), *Output);
+		return 1;
+	}
+	UE_LOG(LogM2U, Display, TEXT("m2uBench results written to %s"), *Output);
+	return 0;
+}
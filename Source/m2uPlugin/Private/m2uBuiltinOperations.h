@@ -12,6 +12,7 @@
 #include "m2uOpLayer.h"
 #include "m2uOpObject.h"
 #include "m2uOpSelection.h"
+#include "m2uOpStats.h"
 #include "m2uOpTransaction.h"
 #include "m2uOpVisibility.h"
 #include "m2uOpFetch.h"
@@ -30,6 +31,7 @@ void CreateBuiltinOperations( Fm2uOperationManager* Manager )
 	new Fm2uOpLayer(Manager);
 
 	new Fm2uOpObjectTransform(Manager);
+	new Fm2uOpObjectHandle(Manager);
 	new Fm2uOpObjectName(Manager);
 	new Fm2uOpObjectDelete(Manager);
 	new Fm2uOpObjectDuplicate(Manager);
@@ -40,6 +42,8 @@ void CreateBuiltinOperations( Fm2uOperationManager* Manager )
 
 	new Fm2uOpSelection(Manager);
 
+	new Fm2uOpStats(Manager);
+
 	new Fm2uOpVisibility(Manager);
 
 	new Fm2uOpFastFetch(Manager);
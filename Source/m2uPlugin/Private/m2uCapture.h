@@ -0,0 +1,360 @@
+#pragma once
+// Recording sessions to replay them later
+
+#include "m2uNetworkThread.h"
+
+#define M2U_CAPTURE_MAGIC 0x4375326D // "m2uC"
+#define M2U_CAPTURE_VERSION 3
+// replayed commands come from connections with this bit set, real ones are
+// counted up from 1 and never get there
+#define M2U_REPLAY_CONNECTION_ID 0x80000000
+
+/**
+   "m2uCapture start [File]" writes every command and transform stream frame
+   the plugin receives to a log, at the time it arrived, and the response and
+   execution time of every command once it was executed.
+   "m2uReplay <File>" executes the commands of a log again, as fast as
+   possible, and reports how the time compares to the recorded one.
+   "m2uReplay <File> paced" feeds the commands and transform frames to the
+   command queue at their original pacing instead, those of every recorded
+   client from a connection of its own, so a session behaves like when it was
+   recorded.
+
+   The log is a binary FArchive file:
+   | uint32 Magic | uint32 Version | Record ... |
+   every record being a uint8 Em2uCaptureRecord, the time, connection and
+   request id, followed by the fields of its kind. The result of a command is
+   a record of its own, written when it was done, and found again by its
+   connection and request id. Transforms that were replaced by newer ones
+   before their execution are in the log, their result is the one of the
+   command replacing them.
+ */
+enum class Em2uCaptureRecord : uint8
+{
+	// a command as it arrived
+	Command,
+	// a frame of the binary transform stream as it arrived
+	Transforms,
+	// the answer to a command, when it was executed
+	Result,
+};
+
+inline FArchive& operator<<( FArchive& Ar, Fm2uTransformRecord& Record )
+{
+	Ar << Record.Handle;
+	Ar << Record.Transform;
+	return Ar;
+}
+
+struct Fm2uCaptureRecord
+{
+	Em2uCaptureRecord Kind;
+	// seconds since the capture started
+	double Time;
+	uint32 ConnectionId;
+	uint32 RequestId;
+	// Command, Data only for M2U_FRAME_FLAG_BINARY
+	uint32 Flags;
+	FString Command;
+	TArray<uint8> Data;
+	// Transforms
+	TArray<Fm2uTransformRecord> Transforms;
+	// Result, game thread time, for async commands of all their steps together
+	double ExecutionSeconds;
+	FString Response;
+
+	Fm2uCaptureRecord()
+		:Kind(Em2uCaptureRecord::Command),
+		 Time(0.0),
+		 ConnectionId(0),
+		 RequestId(0),
+		 Flags(0),
+		 ExecutionSeconds(0.0)
+	{}
+
+	friend FArchive& operator<<( FArchive& Ar, Fm2uCaptureRecord& Record )
+	{
+		uint8 Kind = (uint8)Record.Kind;
+		Ar << Kind;
+		Record.Kind = (Em2uCaptureRecord)Kind;
+		Ar << Record.Time;
+		Ar << Record.ConnectionId;
+		Ar << Record.RequestId;
+		switch( Record.Kind )
+		{
+		case Em2uCaptureRecord::Command:
+			Ar << Record.Flags;
+			Ar << Record.Command;
+			Ar << Record.Data;
+			break;
+		case Em2uCaptureRecord::Transforms:
+			Ar << Record.Transforms;
+			break;
+		case Em2uCaptureRecord::Result:
+			Ar << Record.ExecutionSeconds;
+			Ar << Record.Response;
+			break;
+		default:
+			Ar.ArIsError = true; // not a record, the rest is garbage too
+			break;
+		}
+		return Ar;
+	}
+};
+
+
+/**
+ * Writes the received commands and their results to a capture file. Only used
+ * on the game thread.
+ */
+class Fm2uCaptureWriter
+{
+public:
+
+	Fm2uCaptureWriter()
+		:Writer(NULL),
+		 StartTime(0.0),
+		 NumCommands(0),
+		 NumTransforms(0)
+	{}
+
+	~Fm2uCaptureWriter()
+	{
+		Stop();
+	}
+
+	bool IsCapturing() const
+	{
+		return Writer != NULL;
+	}
+
+	bool Start( const FString& InFilename )
+	{
+		Stop();
+		Writer = IFileManager::Get().CreateFileWriter(*InFilename);
+		if( Writer == NULL )
+			return false;
+		Filename = InFilename;
+		StartTime = FPlatformTime::Seconds();
+		NumCommands = 0;
+		NumTransforms = 0;
+		uint32 Magic = M2U_CAPTURE_MAGIC;
+		uint32 Version = M2U_CAPTURE_VERSION;
+		*Writer << Magic;
+		*Writer << Version;
+		return true;
+	}
+
+	void Stop()
+	{
+		if( Writer == NULL )
+			return;
+		Writer->Close();
+		delete Writer;
+		Writer = NULL;
+		UE_LOG(LogM2U, Log, TEXT("Captured %i commands and %i transform frames to %s"), NumCommands, NumTransforms, *Filename);
+	}
+
+	/** a command or transform stream frame that was just received */
+	void AddCommand( const Fm2uCommand& Command )
+	{
+		if( Writer == NULL )
+			return;
+		Fm2uCaptureRecord Record;
+		Record.Time = GetTime(Command.ReceiveTime);
+		Record.ConnectionId = Command.ConnectionId;
+		Record.RequestId = Command.RequestId;
+		if( Command.Flags & M2U_FRAME_FLAG_TRANSFORMS )
+		{
+			Record.Kind = Em2uCaptureRecord::Transforms;
+			Record.Transforms = Command.Transforms;
+			++NumTransforms;
+		}
+		else
+		{
+			Record.Kind = Em2uCaptureRecord::Command;
+			Record.Flags = Command.Flags;
+			Record.Command = Command.Command;
+			Record.Data = Command.Data;
+			++NumCommands;
+		}
+		*Writer << Record;
+	}
+
+	/** the answer to a command once it was executed */
+	void AddResult( uint32 ConnectionId, uint32 RequestId, double ExecutionSeconds, const FString& Response )
+	{
+		if( Writer == NULL )
+			return;
+		Fm2uCaptureRecord Record;
+		Record.Kind = Em2uCaptureRecord::Result;
+		Record.Time = GetTime(FPlatformTime::Seconds());
+		Record.ConnectionId = ConnectionId;
+		Record.RequestId = RequestId;
+		Record.ExecutionSeconds = ExecutionSeconds;
+		Record.Response = Response;
+		*Writer << Record;
+	}
+
+	/** the number of commands captured so far */
+	int32 Num() const
+	{
+		return NumCommands;
+	}
+
+private:
+
+	double GetTime( double Seconds ) const
+	{
+		// what was waiting when the capture started arrived at 0
+		return FMath::Max(0.0, Seconds - StartTime);
+	}
+
+	FArchive* Writer;
+	FString Filename;
+	double StartTime;
+	int32 NumCommands;
+	int32 NumTransforms;
+};
+
+
+/**
+ * The commands and transform frames of a capture file, for replaying them.
+ */
+class Fm2uReplay
+{
+public:
+
+	Fm2uReplay()
+		:NextRecord(0),
+		 StartTime(0.0)
+	{}
+
+	/** read all records, the results are looked up with FindResult */
+	bool Load( const FString& Filename )
+	{
+		Records.Reset();
+		Results.Reset();
+		ResultIndices.Reset();
+		TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Filename));
+		if( ! Reader.IsValid() )
+			return false;
+		uint32 Magic = 0;
+		uint32 Version = 0;
+		*Reader << Magic;
+		*Reader << Version;
+		if( Magic != M2U_CAPTURE_MAGIC || Version != M2U_CAPTURE_VERSION )
+		{
+			UE_LOG(LogM2U, Error, TEXT("%s is no m2u capture of version %i."), *Filename, M2U_CAPTURE_VERSION);
+			return false;
+		}
+		// the commands still waiting for their result, oldest first. Legacy
+		// clients send all commands with request id 0.
+		TMap<uint64, TArray<int32>> Unanswered;
+		while( Reader->Tell() < Reader->TotalSize() )
+		{
+			Fm2uCaptureRecord Record;
+			*Reader << Record;
+			if( Reader->IsError() )
+			{
+				// a capture that was cut off is still worth replaying
+				UE_LOG(LogM2U, Warning, TEXT("%s is truncated."), *Filename);
+				break;
+			}
+			const uint64 Key = ((uint64)Record.ConnectionId << 32) | Record.RequestId;
+			if( Record.Kind == Em2uCaptureRecord::Result )
+			{
+				// results of commands that arrived before the capture started
+				// have no command to go to
+				TArray<int32>* Waiting = Unanswered.Find(Key);
+				if( Waiting != NULL && Waiting->Num() > 0 )
+				{
+					ResultIndices[(*Waiting)[0]] = Results.Add(MoveTemp(Record));
+					Waiting->RemoveAt(0, 1, false);
+				}
+			}
+			else
+			{
+				// written in the order they arrived
+				if( Record.Kind == Em2uCaptureRecord::Command )
+				{
+					Unanswered.FindOrAdd(Key).Add(Records.Num());
+				}
+				Records.Add(MoveTemp(Record));
+				ResultIndices.Add(INDEX_NONE);
+			}
+		}
+		NextRecord = 0;
+		return true;
+	}
+
+	/** the commands and transform frames, in the order they arrived */
+	const TArray<Fm2uCaptureRecord>& GetRecords() const
+	{
+		return Records;
+	}
+
+	/** @return the result of GetRecords()[Index], NULL if it has none */
+	const Fm2uCaptureRecord* FindResult( int32 Index ) const
+	{
+		return ResultIndices[Index] != INDEX_NONE ? &Results[ResultIndices[Index]] : NULL;
+	}
+
+	/** start handing out the records at their original pacing from now on */
+	void Start()
+	{
+		NextRecord = 0;
+		StartTime = FPlatformTime::Seconds();
+	}
+
+	/** @return the next command or transform frame that is due, or NULL */
+	const Fm2uCaptureRecord* NextDue()
+	{
+		if( IsDone() )
+			return NULL;
+		const Fm2uCaptureRecord& Record = Records[NextRecord];
+		if( FPlatformTime::Seconds() - StartTime < Record.Time )
+			return NULL;
+		++NextRecord;
+		return &Record;
+	}
+
+	/**
+	 * The command or transform frame of a record, as if it came from a
+	 * connection no client uses, one for every recorded connection.
+	 */
+	static Fm2uCommand MakeCommand( const Fm2uCaptureRecord& Record )
+	{
+		const uint32 ConnectionId = Record.ConnectionId | M2U_REPLAY_CONNECTION_ID;
+		if( Record.Kind == Em2uCaptureRecord::Transforms )
+		{
+			Fm2uCommand Transforms(FString(), Record.RequestId, ConnectionId, M2U_FRAME_FLAG_TRANSFORMS);
+			Transforms.Transforms = Record.Transforms;
+			return Transforms;
+		}
+		Fm2uCommand Command(Record.Command, Record.RequestId, ConnectionId, Record.Flags);
+		Command.Data = Record.Data;
+		return Command;
+	}
+
+	bool IsDone() const
+	{
+		return NextRecord >= Records.Num();
+	}
+
+	/** how long the whole replay took so far */
+	double GetElapsed() const
+	{
+		return FPlatformTime::Seconds() - StartTime;
+	}
+
+private:
+
+	// commands and transform frames
+	TArray<Fm2uCaptureRecord> Records;
+	TArray<Fm2uCaptureRecord> Results;
+	// for every record the index of its result, or INDEX_NONE
+	TArray<int32> ResultIndices;
+	int32 NextRecord;
+	double StartTime;
+};
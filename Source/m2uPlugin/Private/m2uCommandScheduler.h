@@ -0,0 +1,261 @@
+#pragma once
+// Fair ordering of received commands of multiple clients
+
+#include "m2uCoreTokenizer.h"
+
+
+/**
+ * Keeps one queue of pending commands per connection and hands them out in
+ * round-robin order, one command per client in turn. A client flooding us
+ * with a big batch only delays every other client by one command at a time.
+ * Commands of one client are always executed in the order they arrived.
+ *
+ * Transforms are coalesced: a TransformObject for an actor that already has
+ * one pending replaces it (latest value wins), as does a TransformCamera. This
+ * only happens as long as no other command was queued in between, so e.g. a
+ * ParentChildTo still sees the transforms that were sent before it. The
+ * replaced commands are answered with the result of the one replacing them.
+ *
+ * Transform stream frames (M2U_FRAME_FLAG_TRANSFORMS) are queued like the
+ * commands, so they keep their place among them. A frame handed out by Next
+ * is only applied at the end of the tick, so the commands of its client wait
+ * until TransformsApplied is called. Frames that directly follow each other
+ * are merged into one.
+ */
+class Fm2uCommandScheduler
+{
+public:
+
+	Fm2uCommandScheduler()
+		:NextQueue(0)
+	{}
+
+	void Add( Fm2uCommand&& Command )
+	{
+		FClientQueue* Queue = NULL;
+		for( FClientQueue& Existing : Queues )
+		{
+			if( Existing.ConnectionId == Command.ConnectionId )
+			{
+				Queue = &Existing;
+				break;
+			}
+		}
+		if( Queue == NULL )
+		{
+			Queue = &Queues[ Queues.AddDefaulted() ];
+			Queue->ConnectionId = Command.ConnectionId;
+		}
+
+		if( Command.Flags & M2U_FRAME_FLAG_TRANSFORMS )
+		{
+			Queue->ResetPendingTransforms();
+			// the applier takes the newest transform of an actor anyway
+			if( Queue->Num() > 0 && (Queue->Commands.Last().Flags & M2U_FRAME_FLAG_TRANSFORMS) )
+			{
+				Queue->Commands.Last().Transforms.Append( Command.Transforms );
+				return;
+			}
+			Queue->Commands.Add( MoveTemp(Command) );
+			return;
+		}
+
+		FString ActorName;
+		uint32 Parts = 0;
+		// a binary TransformObject carries many actors, it is never merged
+		const ETransformKind Kind = (Command.Flags & M2U_FRAME_FLAG_BINARY) ? ETransformKind::None : GetTransformKind( Command.Command, ActorName, Parts );
+		if( Kind == ETransformKind::None )
+		{
+			// no transform may be merged across another command
+			Queue->ResetPendingTransforms();
+			Queue->Commands.Add( MoveTemp(Command) );
+			return;
+		}
+
+		FPendingTransform* Pending = (Kind == ETransformKind::Camera) ? &Queue->PendingCamera : Queue->PendingObjects.Find( ActorName );
+		// a command that only sets some of T, R and S can't replace one that
+		// sets more
+		if( Pending != NULL && Pending->Index >= Queue->Head && (Pending->Parts & ~Parts) == 0 )
+		{
+			Fm2uCommand& Replaced = Queue->Commands[Pending->Index];
+			Replaced.SupersededRequestIds.Add( Replaced.RequestId );
+			Replaced.Command = MoveTemp( Command.Command );
+			Replaced.Data = MoveTemp( Command.Data );
+			Replaced.RequestId = Command.RequestId;
+			Replaced.Flags = Command.Flags;
+			// it is as old as the newest value it carries
+			Replaced.ReceiveTime = Command.ReceiveTime;
+			Pending->Parts = Parts;
+			return;
+		}
+
+		const FPendingTransform Added( Queue->Commands.Add( MoveTemp(Command) ), Parts );
+		if( Kind == ETransformKind::Camera )
+		{
+			Queue->PendingCamera = Added;
+		}
+		else
+		{
+			Queue->PendingObjects.Add( ActorName, Added );
+		}
+	}
+
+	/** forget all pending commands of a connection that was closed */
+	void RemoveConnection( uint32 ConnectionId )
+	{
+		for( int32 Idx = 0; Idx < Queues.Num(); ++Idx )
+		{
+			if( Queues[Idx].ConnectionId == ConnectionId )
+			{
+				Queues.RemoveAt(Idx);
+				if( NextQueue > Idx )
+					--NextQueue;
+				return;
+			}
+		}
+	}
+
+	void Empty()
+	{
+		Queues.Empty();
+		NextQueue = 0;
+	}
+
+	bool IsEmpty() const
+	{
+		for( const FClientQueue& Queue : Queues )
+		{
+			if( Queue.Num() > 0 )
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Get the next command to execute. Every call moves on to the next client
+	 * that has commands waiting and isn't waiting for its transform frames.
+	 */
+	bool Next( Fm2uCommand& OutCommand )
+	{
+		const int32 NumQueues = Queues.Num();
+		for( int32 Offset = 0; Offset < NumQueues; ++Offset )
+		{
+			const int32 Idx = (NextQueue + Offset) % NumQueues;
+			FClientQueue& Queue = Queues[Idx];
+			if( Queue.Num() == 0 )
+				continue;
+			const bool bTransforms = (Queue.Commands[Queue.Head].Flags & M2U_FRAME_FLAG_TRANSFORMS) != 0;
+			if( Queue.bWaitingForTransforms && ! bTransforms )
+				continue;
+
+			Queue.bWaitingForTransforms |= bTransforms;
+			OutCommand = MoveTemp( Queue.Commands[Queue.Head++] );
+			if( Queue.Head == Queue.Commands.Num() )
+			{
+				// keep the allocation for the next batch
+				Queue.Commands.Reset();
+				Queue.Head = 0;
+				Queue.ResetPendingTransforms();
+			}
+			else if( Queue.Head >= 1024 && Queue.Head * 2 >= Queue.Commands.Num() )
+			{
+				// a client that never runs dry, drop the executed part
+				Queue.Commands.RemoveAt(0, Queue.Head, false);
+				Queue.Head = 0;
+				Queue.ResetPendingTransforms(); // the indices moved
+			}
+			NextQueue = (Idx + 1) % NumQueues;
+			return true;
+		}
+		return false;
+	}
+
+	/** the transform frames handed out so far were applied */
+	void TransformsApplied()
+	{
+		for( FClientQueue& Queue : Queues )
+		{
+			Queue.bWaitingForTransforms = false;
+		}
+	}
+
+private:
+
+	enum class ETransformKind
+	{
+		None,
+		Object,
+		Camera
+	};
+
+	static ETransformKind GetTransformKind( const FString& Command, FString& OutActorName, uint32& OutParts )
+	{
+		// only the keyword first, a batch command may be megabytes long
+		Tm2uTokenTable<TCHAR> Tokens;
+		Tokens.TokenizeFirst( *Command, Command.Len(), 1 );
+		const Tm2uTextView<TCHAR> Keyword = Tokens.GetKeyword();
+		if( Keyword.EqualsIgnoreCase("TransformCamera") )
+		{
+			OutParts = M2U_TRANSFORM_ALL;
+			return ETransformKind::Camera;
+		}
+		if( ! Keyword.EqualsIgnoreCase("TransformObject") )
+		{
+			return ETransformKind::None;
+		}
+		Tokens.TokenizeRest();
+		if( Tokens.Num() > 1 && ! Tokens.Get(1).IsEmpty() )
+		{
+			const Tm2uTextView<TCHAR> Name = Tokens.Get(1);
+			OutActorName = FString( Name.Len, Name.Data );
+			// which of T=, R= and S= it sets
+			OutParts = m2uParse::GetTransformParts( Tokens, 2 );
+			return ETransformKind::Object;
+		}
+		return ETransformKind::None;
+	}
+
+	/** a queued transform that a newer one may still replace */
+	struct FPendingTransform
+	{
+		int32 Index; // in Commands
+		uint32 Parts;
+
+		FPendingTransform( int32 InIndex = INDEX_NONE, uint32 InParts = 0 )
+			:Index(InIndex),
+			 Parts(InParts)
+		{}
+	};
+
+	struct FClientQueue
+	{
+		uint32 ConnectionId;
+		TArray<Fm2uCommand> Commands;
+		int32 Head; // the next command to execute
+		// keyed by actor name
+		TMap<FString, FPendingTransform> PendingObjects;
+		FPendingTransform PendingCamera;
+		// a transform frame was handed out but not applied yet
+		bool bWaitingForTransforms;
+
+		FClientQueue()
+			:ConnectionId(0),
+			 Head(0),
+			 bWaitingForTransforms(false)
+		{}
+
+		int32 Num() const
+		{
+			return Commands.Num() - Head;
+		}
+
+		void ResetPendingTransforms()
+		{
+			PendingObjects.Reset();
+			PendingCamera = FPendingTransform();
+		}
+	};
+
+	TArray<FClientQueue> Queues;
+	int32 NextQueue;
+};
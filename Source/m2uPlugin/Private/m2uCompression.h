@@ -0,0 +1,52 @@
+#pragma once
+// Fast payload compression for the framed protocol
+
+// the codec, see there
+#include "m2uCoreCompression.h"
+
+/**
+ * Totals of everything that went through the codec, for judging if compression
+ * pays off. Updated on the network thread, read from anywhere.
+ */
+struct Fm2uCompressionStats
+{
+	volatile int64 RawBytesIn;
+	volatile int64 WireBytesIn;
+	volatile int64 RawBytesOut;
+	volatile int64 WireBytesOut;
+	volatile int64 DecompressMicroseconds;
+	volatile int64 CompressMicroseconds;
+
+	Fm2uCompressionStats()
+		:RawBytesIn(0),
+		 WireBytesIn(0),
+		 RawBytesOut(0),
+		 WireBytesOut(0),
+		 DecompressMicroseconds(0),
+		 CompressMicroseconds(0)
+	{}
+
+	void AddIn( int32 Raw, int32 Wire, double Seconds )
+	{
+		FPlatformAtomics::InterlockedAdd( &RawBytesIn, (int64)Raw );
+		FPlatformAtomics::InterlockedAdd( &WireBytesIn, (int64)Wire );
+		FPlatformAtomics::InterlockedAdd( &DecompressMicroseconds, (int64)(Seconds * 1000000.0) );
+	}
+
+	void AddOut( int32 Raw, int32 Wire, double Seconds )
+	{
+		FPlatformAtomics::InterlockedAdd( &RawBytesOut, (int64)Raw );
+		FPlatformAtomics::InterlockedAdd( &WireBytesOut, (int64)Wire );
+		FPlatformAtomics::InterlockedAdd( &CompressMicroseconds, (int64)(Seconds * 1000000.0) );
+	}
+
+	void Report( FOutputDevice& Ar ) const
+	{
+		Ar.Logf( TEXT("m2u compressed in: %lld bytes -> %lld bytes (ratio %.2f), %.2f ms decompressing"),
+				 RawBytesIn, WireBytesIn, WireBytesIn > 0 ? (double)RawBytesIn / WireBytesIn : 0.0,
+				 DecompressMicroseconds / 1000.0 );
+		Ar.Logf( TEXT("m2u compressed out: %lld bytes -> %lld bytes (ratio %.2f), %.2f ms compressing"),
+				 RawBytesOut, WireBytesOut, WireBytesOut > 0 ? (double)RawBytesOut / WireBytesOut : 0.0,
+				 CompressMicroseconds / 1000.0 );
+	}
+};
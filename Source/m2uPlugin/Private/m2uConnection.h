@@ -0,0 +1,72 @@
+#pragma once
+// The network-thread side state of one connected client
+
+#include "m2uFraming.h"
+#include "m2uTransport.h"
+#include "m2uSession.h"
+
+// How a connected client talks to us, see m2uFraming.h
+namespace Em2uProtocol
+{
+	enum Type
+	{
+		Undetermined, // nothing received yet
+		Legacy,       // everything pending is one command
+		Framed        // length-prefixed frames with request ids
+	};
+}
+
+
+/**
+ * Everything the network thread needs to know about one client: its transport,
+ * the protocol it speaks and its own receive and send buffers.
+ * Connection ids are never reused, so results of commands of a closed
+ * connection can't end up at a new client. Only a client that resumes its
+ * session continues the connection, with the old id, see m2uSession.h.
+ */
+class Fm2uConnection
+{
+public:
+
+	Fm2uConnection( Fm2uTransport* InTransport, uint32 InId )
+		:Transport(InTransport),
+		 Id(InId),
+		 Protocol(Em2uProtocol::Undetermined),
+		 LastReceiveTime(0.0),
+		 bReadPaused(false),
+		 CompressionThreshold(0),
+		 Session(NULL),
+		 ResumeSession(NULL),
+		 ResumeRequestId(0),
+		 ResumeAckedRequestId(0)
+	{}
+
+	~Fm2uConnection()
+	{
+		delete Transport; // closes the socket or whatever it runs over
+		Transport = NULL;
+		delete Session;
+		Session = NULL;
+	}
+
+	// NULL while a session waits for its client to come back
+	Fm2uTransport* Transport;
+	const uint32 Id;
+	Em2uProtocol::Type Protocol;
+	Fm2uFrameDecoder Receiver;
+	double LastReceiveTime;
+	// encoded responses the socket didn't accept yet
+	Fm2uRingBuffer Sender;
+	// set while the client doesn't read its responses, we stop reading its
+	// commands then until it catches up
+	bool bReadPaused;
+	// responses of at least this many bytes are compressed, 0 = never
+	int32 CompressionThreshold;
+	// set if the client asked for a resumable session
+	Fm2uSession* Session;
+	// the client asked to continue this (detached) session, the network
+	// thread hands the transport over after receiving
+	Fm2uSession* ResumeSession;
+	uint32 ResumeRequestId;
+	uint32 ResumeAckedRequestId;
+};
@@ -0,0 +1,218 @@
+#pragma once
+// Framed wire protocol for m2u connections
+
+#include "m2uRingBuffer.h"
+#include "m2uUtf8.h"
+#include "m2uCompression.h"
+// the header layout, flags and limits
+#include "m2uCoreFraming.h"
+
+/**
+   By default a connection uses the legacy "text blob" protocol: everything that
+   is pending on the socket is concatenated and treated as one command. That
+   breaks as soon as commands are split across or coalesced within TCP segments,
+   and it forces the client to wait for every reply before sending the next
+   command.
+
+   A client that wants to pipeline commands sends the 4 byte magic "m2uF" as the
+   very first bytes on the connection. From then on, all data in both directions
+   is framed:
+
+   | uint32 PayloadLength | uint32 RequestId | uint32 Flags | Payload ... |
+
+   All header values are little-endian. The payload is the UTF-8 command text
+   exactly as it would have been sent in legacy mode (without a terminating zero). The
+   response to a command is sent back in a frame carrying the same RequestId, so
+   the client can match replies to requests.
+
+   Flags:
+   M2U_FRAME_FLAG_COMPRESSED: the payload is compressed, see m2uCompression.h.
+     Clients may always send compressed frames. Responses are only compressed
+     after the client asked for it with the "Compression" control command.
+   M2U_FRAME_FLAG_CONTROL: the payload is a command for the connection itself,
+     not for the editor. It is answered right away by the network thread with a
+     control frame of the same RequestId. Control commands:
+     "Compression <MinBytes>" compress responses of at least MinBytes from now
+       on, 0 turns compression off again. Answers "Ok".
+     "Session" start a resumable session, answers "Ok <Token>".
+     "Ack <RequestId>" the response to RequestId arrived, not answered.
+     "Resume <Token> <LastAckedRequestId>" continue a session after
+       reconnecting, answers "Ok", "Incomplete" or "Unknown Session".
+     See m2uSession.h.
+   M2U_FRAME_FLAG_ASYNC: run the command as a long-running operation if it is
+     one (ImportAssets, FetchSelected, ...). Such a command is answered right
+     away with "Accepted", followed by "Progress <0..1>" frames while it runs,
+     all of them carrying the ASYNC flag and the RequestId of the command. The
+     final result comes in a frame without the flag. Other commands sent in the
+     meantime are executed and answered as usual, so replies may arrive out of
+     order. Commands that can't run asynchronously are simply executed and
+     answered with a single frame without the flag.
+   M2U_FRAME_FLAG_TRANSFORMS: the payload is not text but binary transform
+     records, see m2uTransformStream.h. These frames are not answered.
+   M2U_FRAME_FLAG_BINARY: the payload is the command text, a zero byte, and
+     binary data for the command. Only "AddActorBatch" and "TransformObject"
+     take binary data, as actor records, see m2uActorRecords.h. They are
+     answered like text commands.
+   Other flags are reserved and must be zero.
+ */
+
+namespace m2uFraming
+{
+	/**
+	   Append a complete frame (header and payload) to the Out array.
+	   If Payload is NULL, the payload bytes are only reserved for the caller to fill.
+	 */
+	inline void AppendFrame( TArray<uint8>& Out, uint32 RequestId, uint32 Flags, const uint8* Payload, int32 PayloadLength )
+	{
+		const int32 Start = Out.AddUninitialized( M2U_FRAME_HEADER_SIZE + PayloadLength );
+		uint8* Dest = Out.GetData() + Start;
+		WriteHeader( Dest, PayloadLength, RequestId, Flags );
+		if( Payload != NULL && PayloadLength > 0 )
+		{
+			FMemory::Memcpy( Dest + M2U_FRAME_HEADER_SIZE, Payload, PayloadLength );
+		}
+	}
+}
+
+
+/**
+ * Incrementally decodes frames from a persistent receive ring buffer.
+ * Receive into the buffer through GetWriteRegion/CommitWrite, then call NextFrame
+ * until it returns false. Partial frames stay in the buffer until the rest of
+ * their bytes arrived. After NextFrame succeeded, the payload has to be taken
+ * out with ConsumeText or ConsumeBytes.
+ */
+class Fm2uFrameDecoder
+{
+public:
+
+	Fm2uFrameDecoder()
+		:bError(false)
+	{}
+
+	void Reset()
+	{
+		Buffer.Reset();
+		bError = false;
+	}
+
+	/** see Fm2uRingBuffer::GetWriteRegion */
+	uint8* GetWriteRegion( int32 MinFree, int32& OutSize )
+	{
+		return Buffer.GetWriteRegion( MinFree, OutSize );
+	}
+
+	void CommitWrite( int32 Count )
+	{
+		Buffer.CommitWrite( Count );
+	}
+
+	/** The number of received bytes not consumed yet. */
+	int32 Num() const
+	{
+		return Buffer.Num();
+	}
+
+	/** check if the unconsumed bytes begin with Count bytes of Prefix */
+	bool StartsWith( const char* Prefix, int32 Count ) const
+	{
+		if( Num() < Count )
+			return false;
+		uint8 Bytes[16];
+		check( Count <= ARRAY_COUNT(Bytes) );
+		Buffer.Peek( 0, Bytes, Count );
+		return FMemory::Memcmp( Bytes, Prefix, Count ) == 0;
+	}
+
+	/** Mark Count bytes at the front of the buffer as consumed. */
+	void Consume( int32 Count )
+	{
+		Buffer.Consume( Count );
+	}
+
+	/**
+	   Try to decode the header of the next frame. Only succeeds once the whole
+	   frame is in the buffer. The header is consumed then, the payload has to be
+	   consumed by the caller.
+
+	   @return true if a frame is ready, false if more data is needed or the
+	   stream is broken (see HasError).
+	 */
+	bool NextFrame( Fm2uFrameHeader& OutHeader )
+	{
+		if( bError || Num() < M2U_FRAME_HEADER_SIZE )
+			return false;
+
+		uint8 Data[M2U_FRAME_HEADER_SIZE];
+		Buffer.Peek( 0, Data, M2U_FRAME_HEADER_SIZE );
+		const Em2uFrameHeaderError HeaderError = m2uFraming::ReadHeader( Data, OutHeader );
+		if( HeaderError == Em2uFrameHeaderError::InvalidLength )
+		{
+			UE_LOG(LogM2U, Error, TEXT("Received frame with invalid length %u."), OutHeader.PayloadLength);
+			bError = true;
+			return false;
+		}
+		if( HeaderError == Em2uFrameHeaderError::UnknownFlags )
+		{
+			UE_LOG(LogM2U, Error, TEXT("Received frame with unknown flags %x."), OutHeader.Flags);
+			bError = true;
+			return false;
+		}
+		if( Num() < M2U_FRAME_HEADER_SIZE + (int32)OutHeader.PayloadLength )
+			return false; // wait for the rest of the frame
+
+		Consume( M2U_FRAME_HEADER_SIZE );
+		return true;
+	}
+
+	/**
+	   Decode Count bytes of UTF-8 from the front of the buffer into Out,
+	   replacing its contents, and consume them.
+	 */
+	void ConsumeText( int32 Count, FString& Out )
+	{
+		TArray<TCHAR>& Chars = Out.GetCharArray();
+		Chars.Reset();
+		if( Count > 0 )
+		{
+			// one TCHAR per byte is the most UTF-8 can decode to (plus the zero)
+			Chars.Reserve( Count + 1 );
+			const uint8* First;
+			const uint8* Second;
+			int32 FirstNum, SecondNum;
+			Buffer.GetReadSpans( 0, Count, First, FirstNum, Second, SecondNum );
+			Utf8.Reset();
+			Utf8.Decode( First, FirstNum, Chars );
+			Utf8.Decode( Second, SecondNum, Chars );
+			Utf8.Flush( Chars );
+			Chars.Add( '\0' );
+			Consume( Count );
+		}
+	}
+
+	/** copy Count bytes from the front of the buffer to Out and consume them */
+	void ConsumeBytes( int32 Count, TArray<uint8>& Out )
+	{
+		Out.SetNumUninitialized( Count, false );
+		Buffer.Peek( 0, Out.GetData(), Count );
+		Consume( Count );
+	}
+
+	/** the content of a frame was invalid, the stream can't be trusted anymore */
+	void SetError()
+	{
+		bError = true;
+	}
+
+	/** The stream contained garbage and can not be decoded any further. */
+	bool HasError() const
+	{
+		return bError;
+	}
+
+private:
+
+	Fm2uRingBuffer Buffer;
+	Fm2uUtf8Decoder Utf8;
+	bool bError;
+};
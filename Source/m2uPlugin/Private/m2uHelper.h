@@ -9,11 +9,7 @@
 #include "AssetSelection.h"
 #include "m2uAssetHelper.h"
 #include "Runtime/Launch/Resources/Version.h"
-
-// Functions I'm currently using from this cpp file aren't exported, so they will
-// be unresolved symbols on Windows. For now importing the cpp is OK...
-// TODO: the required functions should probably be rewritten here instead.
-#include "Editor/UnrealEd/Private/ParamParser.cpp"
+#include "m2uCoreTokenizer.h"
 
 
 // Provides functions that are used by most likely more than one command or action
@@ -24,17 +20,13 @@ namespace m2uHelper
 
 
 /**
-   Parse a python-style list from a string to an array containing the contents
-   of that list.
-   The input string should look like this:
-   [name1,name2,name3,name4]
+   Start reading a python-style list "[name1,name2,name3]" at Str, which may
+   go on behind the list. The items are read one at a time without allocating,
+   quoted names may contain commas, see Tm2uListParser.
  */
-	TArray<FString> ParseList(FString Str)
+	Fm2uListParser ParseList(const TCHAR* Str)
 	{
-		FString Chopped = Str.Mid(1,Str.Len()-2); // remove the brackets
-		TArray<FString> Result;
-		Chopped.ParseIntoArray( Result, TEXT(","), false);
-		return Result;
+		return Fm2uListParser(Str, FCString::Strlen(Str));
 	}
 
 /**
@@ -136,11 +128,12 @@ bool GetActorByName( const TCHAR* Name, AActor** OutActor, UWorld* InWorld = NUL
 
 	
 /**
- * void SetActorTransformRelativeFromText(AActor* Actor, const TCHAR* Stream)
+ * void SetActorTransformRelative(AActor* Actor, const Fm2uTransformText& Transform)
  *
- * Set the Actors relative transformations to the values provided in text-form
- * T=(x y z) R=(x y z) S=(x y z)
- * If one or more of T, R or S is not present in the String, they will be ignored.
+ * Set the Actors relative transformations to the values parsed from text-form
+ * T=(x y z) R=(x y z) S=(x y z), see m2uParse::ParseTransform.
+ * If one or more of T, R or S was not present in the text, they will be ignored.
+ * SetActorTransformRelativeFromText parses the text itself.
  *
  * Relative transformations are the actual transformation values you see in the 
  * Editor. They are equivalent to object-space transforms in maya for example.
@@ -150,38 +143,28 @@ bool GetActorByName( const TCHAR* Name, AActor** OutActor, UWorld* InWorld = NUL
  *
  * The Actor has to be valid, so check before calling this function!
  */
-	void SetActorTransformRelativeFromText(AActor* Actor, const TCHAR* Str)
+	void SetActorTransformRelative(AActor* Actor, const Fm2uTransformText& Transform)
 	{
-		const TCHAR* Stream; // used for searching in Str
-		//if( Stream != NULL )
-		//{	++Stream;  } // skip a space
-
 		// get location
-		FVector Loc;
-		if( (Stream =  FCString::Strfind(Str,TEXT("T="))) )
+		if( Transform.Parts & M2U_TRANSFORM_LOCATION )
 		{
-			Stream += 3; // skip "T=("
-			Stream = GetFVECTORSpaceDelimited( Stream, Loc );
+			const FVector Loc( Transform.Location[0], Transform.Location[1], Transform.Location[2] );
 			//UE_LOG(LogM2U, Log, TEXT("Loc %s"), *(Loc.ToString()) );
 			Actor->SetActorRelativeLocation( Loc, false );
 		}
 
 		// get rotation
-		FRotator Rot;
-		if( (Stream =  FCString::Strfind(Str,TEXT("R="))) )
+		if( Transform.Parts & M2U_TRANSFORM_ROTATION )
 		{
-			Stream += 3; // skip "R=("
-			Stream = GetFROTATORSpaceDelimited( Stream, Rot, 1.0f );
+			const FRotator Rot( Transform.Rotation[0], Transform.Rotation[1], Transform.Rotation[2] );
 			//UE_LOG(LogM2U, Log, TEXT("Rot %s"), *(Rot.ToString()) );
 			Actor->SetActorRelativeRotation( Rot, false );
 		}
 
 		// get scale
-		FVector Scale;
-		if( (Stream =  FCString::Strfind(Str,TEXT("S="))) )
+		if( Transform.Parts & M2U_TRANSFORM_SCALE )
 		{
-			Stream += 3; // skip "S=("
-			Stream = GetFVECTORSpaceDelimited( Stream, Scale );
+			const FVector Scale( Transform.Scale[0], Transform.Scale[1], Transform.Scale[2] );
 			//UE_LOG(LogM2U, Log, TEXT("Scc %s"), *(Scale.ToString()) );
 			Actor->SetActorRelativeScale3D( Scale );
 		}
@@ -193,7 +176,26 @@ bool GetActorByName( const TCHAR* Name, AActor** OutActor, UWorld* InWorld = NUL
 		// Request saves/refreshes.
 		Actor->MarkPackageDirty();
 
-	}// void SetActorTransformRelativeFromText()
+	}// void SetActorTransformRelative()
+
+	/** set all of T, R and S at once, for the binary actor records */
+	void SetActorTransformRelative(AActor* Actor, const FTransform& Transform)
+	{
+		Actor->SetActorRelativeTransform( Transform, false );
+
+		Actor->InvalidateLightingCache();
+		Actor->PostEditMove( true );
+		Actor->CheckDefaultSubobjects();
+		Actor->MarkPackageDirty();
+	}
+
+	void SetActorTransformRelativeFromText(AActor* Actor, const TCHAR* Str)
+	{
+		const Tm2uTokenTable<TCHAR> Tokens( Str );
+		Fm2uTransformText Transform;
+		m2uParse::ParseTransform( Tokens, Transform );
+		SetActorTransformRelative( Actor, Transform );
+	}
 
 
 
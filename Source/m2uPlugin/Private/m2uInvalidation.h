@@ -0,0 +1,126 @@
+#pragma once
+// Editor updates collected over a batch of commands
+
+#include "UnrealEd.h"
+
+/** what the editor has to catch up with after commands changed things */
+enum class Em2uInvalidation : uint8
+{
+	None = 0,
+	// the level viewports need a redraw
+	Viewports = 1 << 0,
+	// actors were (de)selected without notifying the editor
+	Selection = 1 << 1,
+	// actors were renamed or added, the world outliner is outdated
+	Outliner = 1 << 2,
+};
+ENUM_CLASS_FLAGS(Em2uInvalidation)
+
+
+/**
+ * Operations don't redraw the viewports or notify the editor themselves, they
+ * only mark what they changed with m2uInvalidation::Invalidate. The plugin
+ * flushes that once after executing the commands of a tick, so a batch of a
+ * thousand transforms leads to one redraw, not a thousand.
+ *
+ * While a batch spans several ticks, the realtime level viewports can be
+ * switched off to leave more time for the commands. They only redraw on flush
+ * then and are switched back on when the batch is done.
+ * Only used on the game thread.
+ */
+class Fm2uInvalidationScheduler
+{
+public:
+
+	Fm2uInvalidationScheduler()
+		:Pending(Em2uInvalidation::None),
+		 bRealtimeSuspended(false)
+	{}
+
+	void Invalidate( Em2uInvalidation What )
+	{
+		Pending |= What;
+	}
+
+	/** tell the editor about everything invalidated since the last flush */
+	void Flush()
+	{
+		const Em2uInvalidation What = Pending;
+		Pending = Em2uInvalidation::None;
+		if( GEditor == NULL )
+			return;
+
+		if( EnumHasAnyFlags(What, Em2uInvalidation::Selection) )
+		{
+			GEditor->NoteSelectionChange();
+		}
+		if( EnumHasAnyFlags(What, Em2uInvalidation::Outliner) )
+		{
+			GEngine->BroadcastLevelActorListChanged();
+		}
+		if( EnumHasAnyFlags(What, Em2uInvalidation::Viewports) )
+		{
+			GEditor->RedrawLevelEditingViewports();
+		}
+	}
+
+	/** stop rendering the realtime level viewports every frame */
+	void SuspendRealtime()
+	{
+		if( bRealtimeSuspended || GEditor == NULL )
+			return;
+		bRealtimeSuspended = true;
+		for( FLevelEditorViewportClient* Client : GEditor->LevelViewportClients )
+		{
+			if( Client->IsRealtime() )
+			{
+				Client->SetRealtime(false, true); // store the current value
+				SuspendedClients.Add(Client);
+			}
+		}
+	}
+
+	/** switch the viewports suspended by SuspendRealtime back to realtime */
+	void RestoreRealtime()
+	{
+		if( ! bRealtimeSuspended )
+			return;
+		bRealtimeSuspended = false;
+		for( FLevelEditorViewportClient* Client : SuspendedClients )
+		{
+			// viewports may have been closed in the meantime
+			if( GEditor != NULL && GEditor->LevelViewportClients.Contains(Client) )
+			{
+				Client->RestoreRealtime(true);
+			}
+		}
+		SuspendedClients.Reset();
+	}
+
+	bool IsRealtimeSuspended() const
+	{
+		return bRealtimeSuspended;
+	}
+
+private:
+
+	Em2uInvalidation Pending;
+	bool bRealtimeSuspended;
+	TArray<FLevelEditorViewportClient*> SuspendedClients;
+};
+
+
+namespace m2uInvalidation
+{
+	/** the scheduler shared by all operations */
+	inline Fm2uInvalidationScheduler& Get()
+	{
+		static Fm2uInvalidationScheduler Scheduler;
+		return Scheduler;
+	}
+
+	inline void Invalidate( Em2uInvalidation What )
+	{
+		Get().Invalidate(What);
+	}
+}
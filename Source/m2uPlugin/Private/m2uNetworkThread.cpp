@@ -0,0 +1,664 @@
+#include "m2uPluginPrivatePCH.h"
+#include "m2uNetworkThread.h"
+#include "m2uTrace.h"
+
+
+Fm2uNetworkThread::Fm2uNetworkThread( int32 InMaxClients )
+	:Thread(NULL),
+	 MaxClients(InMaxClients),
+	 LastConnectionId(0)
+{
+	CompressionHashTable.SetNumUninitialized(m2uCompression::HashTableSize);
+	Thread = FRunnableThread::Create(this, TEXT("m2uNetworkThread"), 0, TPri_AboveNormal);
+}
+
+Fm2uNetworkThread::~Fm2uNetworkThread()
+{
+	if( Thread != NULL )
+	{
+		Thread->Kill(true); // calls Stop and waits for Run to return
+		delete Thread;
+		Thread = NULL;
+	}
+}
+
+void Fm2uNetworkThread::Stop()
+{
+	StopTaskCounter.Increment();
+}
+
+bool Fm2uNetworkThread::ReserveClient()
+{
+	if( NumClients.Increment() > MaxClients )
+	{
+		NumClients.Decrement();
+		return false;
+	}
+	return true;
+}
+
+bool Fm2uNetworkThread::AddClient( FSocket* Socket )
+{
+	if( ! ReserveClient() )
+		return false;
+	NewTransports.Enqueue(new Fm2uSocketTransport(Socket));
+	return true;
+}
+
+bool Fm2uNetworkThread::AddClient( Fm2uTransport* Transport )
+{
+	if( ! ReserveClient() )
+		return false;
+	NewTransports.Enqueue(Transport);
+	return true;
+}
+
+void Fm2uNetworkThread::CloseClients()
+{
+	CloseRequestCounter.Increment();
+}
+
+bool Fm2uNetworkThread::DequeueCommand( Fm2uCommand& OutCommand )
+{
+	return Inbound.Dequeue(OutCommand);
+}
+
+bool Fm2uNetworkThread::DequeueClosedConnection( uint32& OutConnectionId )
+{
+	return ClosedConnections.Dequeue(OutConnectionId);
+}
+
+void Fm2uNetworkThread::QueueResponse( Fm2uResponse&& Response )
+{
+	Outbound.Enqueue(MoveTemp(Response));
+}
+
+
+uint32 Fm2uNetworkThread::Run()
+{
+	while( StopTaskCounter.GetValue() == 0 )
+	{
+		if( CloseRequestCounter.GetValue() > 0 )
+		{
+			CloseRequestCounter.Reset();
+			DropAllConnections();
+		}
+		AcceptNewClients();
+
+		bool bReceivedAnything = false;
+		for( int32 Idx = Connections.Num() - 1; Idx >= 0; --Idx )
+		{
+			Fm2uConnection* Connection = Connections[Idx];
+			if( ! Connection->Transport->IsConnected() )
+			{
+				UE_LOG(LogM2U, Log, TEXT("Client %u disconnected."), Connection->Id);
+				DropConnection(Idx);
+				continue;
+			}
+			if( Connection->bReadPaused )
+				continue;
+			bReceivedAnything |= ReceiveMessages(Connection);
+			if( Connection->Receiver.HasError() )
+			{
+				UE_LOG(LogM2U, Error, TEXT("Broken frame stream from client %u, closing connection."), Connection->Id);
+				DropConnection(Idx);
+			}
+		}
+		ResumeSessions();
+		ExpireSessions();
+
+		QueueResponses();
+		for( int32 Idx = Connections.Num() - 1; Idx >= 0; --Idx )
+		{
+			Fm2uConnection* Connection = Connections[Idx];
+			if( ! FlushSends(Connection) )
+			{
+				UE_LOG(LogM2U, Error, TEXT("Sending answer to client %u failed."), Connection->Id);
+				DropConnection(Idx);
+				continue;
+			}
+
+			// backpressure: a client that doesn't read its responses doesn't get
+			// to send more commands
+			const int32 Pending = Connection->Sender.Num();
+			if( ! Connection->bReadPaused && Pending > M2U_SEND_HIGH_WATERMARK )
+			{
+				UE_LOG(LogM2U, Warning, TEXT("Client %u is not reading its responses, pausing its commands."), Connection->Id);
+				Connection->bReadPaused = true;
+			}
+			else if( Connection->bReadPaused && Pending <= M2U_SEND_LOW_WATERMARK )
+			{
+				Connection->bReadPaused = false;
+			}
+		}
+
+		if( bReceivedAnything )
+			continue;
+		if( Connections.Num() == 1 && ! Connections[0]->bReadPaused )
+		{
+			// sleep until there is something to read, but wake up regularly to
+			// send the responses the game thread produced in the meantime
+			Connections[0]->Transport->WaitForData(0.001);
+		}
+		else
+		{
+			FPlatformProcess::Sleep(Connections.Num() == 0 ? 0.01f : 0.001f);
+		}
+	}
+
+	DropAllConnections();
+	Fm2uTransport* Transport = NULL;
+	while( NewTransports.Dequeue(Transport) )
+	{
+		delete Transport;
+	}
+	return 0;
+}
+
+
+void Fm2uNetworkThread::AcceptNewClients()
+{
+	Fm2uTransport* Transport = NULL;
+	while( NewTransports.Dequeue(Transport) )
+	{
+		Fm2uConnection* Connection = new Fm2uConnection(Transport, ++LastConnectionId);
+		Connections.Add(Connection);
+		UE_LOG(LogM2U, Log, TEXT("Client %u connected on %s."), Connection->Id, *Transport->Describe());
+	}
+}
+
+
+Fm2uConnection* Fm2uNetworkThread::FindConnection( uint32 ConnectionId ) const
+{
+	for( Fm2uConnection* Connection : Connections )
+	{
+		if( Connection->Id == ConnectionId )
+			return Connection;
+	}
+	for( Fm2uConnection* Connection : DetachedConnections )
+	{
+		if( Connection->Id == ConnectionId )
+			return Connection;
+	}
+	return NULL;
+}
+
+
+void Fm2uNetworkThread::DropConnection( int32 Index )
+{
+	Fm2uConnection* Connection = Connections[Index];
+	Connections.RemoveAt(Index);
+	NumClients.Decrement();
+
+	if( Connection->Session != NULL )
+	{
+		// keep the connection going without a client, its commands are still
+		// executed and the responses collected for when the client resumes
+		delete Connection->Transport;
+		Connection->Transport = NULL;
+		Connection->Receiver.Reset();
+		Connection->Sender.Reset(); // may end in a partial frame, the replay has all of them
+		Connection->bReadPaused = false;
+		Connection->Session->DetachedTime = FPlatformTime::Seconds();
+		DetachedConnections.Add(Connection);
+		UE_LOG(LogM2U, Log, TEXT("Client %u is gone, keeping its session for %.0f seconds."), Connection->Id, M2U_SESSION_TIMEOUT);
+		return;
+	}
+	ClosedConnections.Enqueue(Connection->Id);
+	delete Connection; // closes the transport
+}
+
+
+void Fm2uNetworkThread::CloseDetachedConnection( int32 Index )
+{
+	Fm2uConnection* Connection = DetachedConnections[Index];
+	DetachedConnections.RemoveAt(Index);
+	ClosedConnections.Enqueue(Connection->Id);
+	delete Connection;
+}
+
+
+void Fm2uNetworkThread::DropAllConnections()
+{
+	while( DetachedConnections.Num() > 0 )
+	{
+		CloseDetachedConnection(DetachedConnections.Num() - 1);
+	}
+	while( Connections.Num() > 0 )
+	{
+		// no resuming after the connections were reset
+		Fm2uConnection* Connection = Connections.Last();
+		delete Connection->Session;
+		Connection->Session = NULL;
+		DropConnection(Connections.Num() - 1);
+	}
+}
+
+
+void Fm2uNetworkThread::ResumeSessions()
+{
+	for( int32 Idx = Connections.Num() - 1; Idx >= 0; --Idx )
+	{
+		Fm2uConnection* Connection = Connections[Idx];
+		Fm2uSession* Session = Connection->ResumeSession;
+		if( Session == NULL )
+			continue;
+		const uint32 RequestId = Connection->ResumeRequestId;
+		const uint32 AckedRequestId = Connection->ResumeAckedRequestId;
+		Connection->ResumeSession = NULL;
+
+		// the old connection may not have noticed yet that its client is gone
+		for( int32 OldIdx = 0; OldIdx < Connections.Num(); ++OldIdx )
+		{
+			if( Connections[OldIdx]->Session == Session )
+			{
+				DropConnection(OldIdx);
+				Idx = Connections.Find(Connection);
+				break;
+			}
+		}
+
+		Fm2uConnection* Resumed = NULL;
+		for( int32 DetachedIdx = 0; DetachedIdx < DetachedConnections.Num(); ++DetachedIdx )
+		{
+			if( DetachedConnections[DetachedIdx]->Session == Session )
+			{
+				Resumed = DetachedConnections[DetachedIdx];
+				DetachedConnections.RemoveAt(DetachedIdx);
+				break;
+			}
+		}
+		if( Resumed == NULL )
+		{
+			QueueText(Connection, RequestId, M2U_FRAME_FLAG_CONTROL, TEXT("Unknown Session"));
+			continue;
+		}
+
+		// continue the old connection with the new client, whatever it sent
+		// after the Resume is decoded there
+		Resumed->Transport = Connection->Transport;
+		Connection->Transport = NULL;
+		Swap(Resumed->Receiver, Connection->Receiver);
+		Resumed->LastReceiveTime = Connection->LastReceiveTime;
+		Connections[Idx] = Resumed;
+		ClosedConnections.Enqueue(Connection->Id);
+		delete Connection;
+
+		const bool bComplete = Session->CanReplayAfter(AckedRequestId);
+		QueueText(Resumed, RequestId, M2U_FRAME_FLAG_CONTROL, bComplete ? TEXT("Ok") : TEXT("Incomplete"));
+		Session->ReplayAfter(AckedRequestId, Resumed->Sender);
+		UE_LOG(LogM2U, Log, TEXT("Client %u resumed its session on %s."), Resumed->Id, *Resumed->Transport->Describe());
+	}
+}
+
+
+void Fm2uNetworkThread::ExpireSessions()
+{
+	const double Now = FPlatformTime::Seconds();
+	for( int32 Idx = DetachedConnections.Num() - 1; Idx >= 0; --Idx )
+	{
+		if( Now - DetachedConnections[Idx]->Session->DetachedTime > M2U_SESSION_TIMEOUT )
+		{
+			UE_LOG(LogM2U, Log, TEXT("Session of client %u expired."), DetachedConnections[Idx]->Id);
+			CloseDetachedConnection(Idx);
+		}
+	}
+}
+
+
+bool Fm2uNetworkThread::ReceiveMessages( Fm2uConnection* Connection )
+{
+	Fm2uTraceScope Trace(TEXT("Receive"), Connection->Id);
+	Fm2uTransport* Client = Connection->Transport;
+	Fm2uFrameDecoder& Receiver = Connection->Receiver;
+
+	// get all pending data from the client into its persistent receive buffer
+	const int32 PreviousNum = Receiver.Num();
+	int32 DataSize = 0;
+	while( (DataSize = Client->GetPendingData()) > 0 )
+	{
+		// read pending data directly into the receive buffer, the free region
+		// may wrap around, so it can take two reads
+		int32 RegionSize = 0;
+		uint8* Dest = Receiver.GetWriteRegion(DataSize, RegionSize);
+		int32 BytesRead = 0;
+		if( ! Client->Recv( Dest, FMath::Min<int32>(DataSize, RegionSize), BytesRead) )
+		{
+			BytesRead = 0;
+		}
+		Receiver.CommitWrite(BytesRead);
+		if( BytesRead == 0 )
+			break;
+	}
+	const double Now = FPlatformTime::Seconds();
+	const bool bReceived = Receiver.Num() != PreviousNum;
+	if( bReceived )
+	{
+		Connection->LastReceiveTime = Now;
+	}
+	else
+	{
+		Trace.Cancel(); // most rounds find nothing, that would only clutter
+	}
+
+	// the first bytes of a connection tell us which protocol the client speaks
+	if( Connection->Protocol == Em2uProtocol::Undetermined )
+	{
+		if( Receiver.Num() < M2U_FRAME_MAGIC_SIZE )
+		{
+			// a legacy command may be shorter than the magic, like "Ok", it is
+			// complete once the client went quiet
+			if( Receiver.Num() == 0 || Now - Connection->LastReceiveTime < M2U_LEGACY_QUIET_TIME )
+				return bReceived;
+			Connection->Protocol = Em2uProtocol::Legacy;
+		}
+		else if( Receiver.StartsWith(M2U_FRAME_MAGIC, M2U_FRAME_MAGIC_SIZE) )
+		{
+			UE_LOG(LogM2U, Log, TEXT("Client %u uses the framed protocol."), Connection->Id);
+			Connection->Protocol = Em2uProtocol::Framed;
+			Receiver.Consume(M2U_FRAME_MAGIC_SIZE);
+		}
+		else
+		{
+			Connection->Protocol = Em2uProtocol::Legacy;
+		}
+	}
+
+	if( Connection->Protocol == Em2uProtocol::Legacy )
+	{
+		// everything the client sent before waiting for the reply is one message
+		if( Receiver.Num() > 0 && Now - Connection->LastReceiveTime >= M2U_LEGACY_QUIET_TIME )
+		{
+			Fm2uCommand Command;
+			Command.ConnectionId = Connection->Id;
+			Command.ReceiveTime = Now;
+			Receiver.ConsumeText(Receiver.Num(), Command.Command);
+			Inbound.Enqueue(MoveTemp(Command));
+		}
+		return bReceived;
+	}
+
+	// framed protocol: queue all complete frames, keep partial ones buffered
+	Fm2uFrameHeader Header;
+	while( Receiver.NextFrame(Header) )
+	{
+		if( Header.Flags & M2U_FRAME_FLAG_TRANSFORMS )
+		{
+			// queued with the commands, so neither overtakes the other
+			Fm2uCommand Transforms;
+			Transforms.RequestId = Header.RequestId;
+			Transforms.ConnectionId = Connection->Id;
+			Transforms.Flags = M2U_FRAME_FLAG_TRANSFORMS;
+			Transforms.ReceiveTime = Now;
+			if( ! ConsumeTransforms(Receiver, Header, Transforms.Transforms) )
+			{
+				UE_LOG(LogM2U, Error, TEXT("Received broken transform frame %u."), Header.RequestId);
+				Receiver.SetError();
+				break;
+			}
+			Inbound.Enqueue(MoveTemp(Transforms));
+			continue;
+		}
+
+		Fm2uTraceScope DecodeTrace(TEXT("Decode"), Header.RequestId);
+		Fm2uCommand Command;
+		Command.RequestId = Header.RequestId;
+		Command.ConnectionId = Connection->Id;
+		Command.Flags = Header.Flags & (M2U_FRAME_FLAG_ASYNC | M2U_FRAME_FLAG_BINARY);
+		Command.ReceiveTime = Now;
+		if( Header.Flags & M2U_FRAME_FLAG_BINARY )
+		{
+			if( ! ConsumeBinaryCommand(Receiver, Header, Command) )
+			{
+				UE_LOG(LogM2U, Error, TEXT("Received broken binary frame %u."), Header.RequestId);
+				Receiver.SetError();
+				break;
+			}
+		}
+		else if( Header.Flags & M2U_FRAME_FLAG_COMPRESSED )
+		{
+			if( ! ConsumeCompressedText(Receiver, Header.PayloadLength, Command.Command) )
+			{
+				UE_LOG(LogM2U, Error, TEXT("Received broken compressed frame %u."), Header.RequestId);
+				Receiver.SetError();
+				break;
+			}
+		}
+		else
+		{
+			Receiver.ConsumeText(Header.PayloadLength, Command.Command);
+		}
+
+		if( Header.Flags & M2U_FRAME_FLAG_CONTROL )
+		{
+			HandleControlCommand(Connection, Header.RequestId, Command.Command);
+			if( Connection->ResumeSession != NULL )
+				break; // the rest belongs to the resumed connection
+			continue;
+		}
+		Inbound.Enqueue(MoveTemp(Command));
+	}
+	return bReceived;
+}
+
+
+bool Fm2uNetworkThread::ConsumeCompressedText( Fm2uFrameDecoder& Receiver, int32 PayloadLength, FString& OutText )
+{
+	if( ! ConsumeCompressed(Receiver, PayloadLength) )
+		return false;
+	m2uUtf8::DecodeToString(RawBuffer.GetData(), RawBuffer.Num(), OutText);
+	return true;
+}
+
+
+bool Fm2uNetworkThread::ConsumeCompressed( Fm2uFrameDecoder& Receiver, int32 PayloadLength )
+{
+	if( PayloadLength < 4 )
+		return false;
+	Receiver.ConsumeBytes(PayloadLength, CompressedBuffer);
+	const uint32 RawSize = m2uFraming::ReadUInt32(CompressedBuffer.GetData());
+	if( RawSize > M2U_FRAME_MAX_PAYLOAD )
+		return false;
+
+	const double StartTime = FPlatformTime::Seconds();
+	RawBuffer.SetNumUninitialized(RawSize, false);
+	if( ! m2uCompression::Decompress(CompressedBuffer.GetData() + 4, PayloadLength - 4, RawBuffer.GetData(), RawSize) )
+		return false;
+	CompressionStats.AddIn(RawSize, PayloadLength, FPlatformTime::Seconds() - StartTime);
+	return true;
+}
+
+
+bool Fm2uNetworkThread::ConsumeTransforms( Fm2uFrameDecoder& Receiver, const Fm2uFrameHeader& Header, TArray<Fm2uTransformRecord>& OutRecords )
+{
+	if( Header.Flags & M2U_FRAME_FLAG_COMPRESSED )
+	{
+		if( ! ConsumeCompressed(Receiver, Header.PayloadLength) )
+			return false;
+	}
+	else
+	{
+		Receiver.ConsumeBytes(Header.PayloadLength, RawBuffer);
+	}
+
+	return m2uTransformStream::Decode(RawBuffer.GetData(), RawBuffer.Num(), OutRecords);
+}
+
+
+bool Fm2uNetworkThread::ConsumeBinaryCommand( Fm2uFrameDecoder& Receiver, const Fm2uFrameHeader& Header, Fm2uCommand& OutCommand )
+{
+	if( Header.Flags & M2U_FRAME_FLAG_COMPRESSED )
+	{
+		if( ! ConsumeCompressed(Receiver, Header.PayloadLength) )
+			return false;
+	}
+	else
+	{
+		Receiver.ConsumeBytes(Header.PayloadLength, RawBuffer);
+	}
+
+	const int32 TextLength = m2uFraming::GetBinaryCommandLength(RawBuffer.GetData(), RawBuffer.Num());
+	if( TextLength < 0 )
+		return false;
+	m2uUtf8::DecodeToString(RawBuffer.GetData(), TextLength, OutCommand.Command);
+	OutCommand.Data.Append(RawBuffer.GetData() + TextLength + 1, RawBuffer.Num() - TextLength - 1);
+	return true;
+}
+
+
+void Fm2uNetworkThread::HandleControlCommand( Fm2uConnection* Connection, uint32 RequestId, const FString& Command )
+{
+	const TCHAR* Str = *Command;
+	FString Reply = TEXT("Ok");
+	if( FParse::Command(&Str, TEXT("Compression")) )
+	{
+		FString MinBytes;
+		if( FParse::Token(Str, MinBytes, 0) )
+		{
+			Connection->CompressionThreshold = FMath::Max(0, FCString::Atoi(*MinBytes));
+		}
+		UE_LOG(LogM2U, Log, TEXT("Client %u compression threshold is %i bytes."), Connection->Id, Connection->CompressionThreshold);
+	}
+	else if( FParse::Command(&Str, TEXT("Session")) )
+	{
+		if( Connection->Session == NULL )
+		{
+			Connection->Session = new Fm2uSession(FGuid::NewGuid().ToString(EGuidFormats::Digits));
+			UE_LOG(LogM2U, Log, TEXT("Client %u started a session."), Connection->Id);
+		}
+		Reply = FString::Printf(TEXT("Ok %s"), *Connection->Session->Token);
+	}
+	else if( FParse::Command(&Str, TEXT("Ack")) )
+	{
+		FString RequestIdString;
+		if( Connection->Session != NULL && FParse::Token(Str, RequestIdString, 0) )
+		{
+			Connection->Session->Acknowledge((uint32)FCString::Strtoui64(*RequestIdString, NULL, 10));
+		}
+		return; // acks are sent often, they are not answered
+	}
+	else if( FParse::Command(&Str, TEXT("Resume")) )
+	{
+		FString Token;
+		FString RequestIdString;
+		FParse::Token(Str, Token, 0);
+		Fm2uSession* Session = NULL;
+		for( Fm2uConnection* Other : Connections )
+		{
+			if( Other != Connection && Other->Session != NULL && Other->Session->Token == Token )
+				Session = Other->Session;
+		}
+		for( Fm2uConnection* Other : DetachedConnections )
+		{
+			if( Other->Session->Token == Token )
+				Session = Other->Session;
+		}
+		if( Session != NULL )
+		{
+			// answered when the connection is handed over, see ResumeSessions
+			Connection->ResumeSession = Session;
+			Connection->ResumeRequestId = RequestId;
+			Connection->ResumeAckedRequestId = 0;
+			if( FParse::Token(Str, RequestIdString, 0) )
+			{
+				Connection->ResumeAckedRequestId = (uint32)FCString::Strtoui64(*RequestIdString, NULL, 10);
+			}
+			return;
+		}
+		Reply = TEXT("Unknown Session");
+	}
+	else
+	{
+		UE_LOG(LogM2U, Warning, TEXT("Unknown control command: %s"), *Command);
+		Reply = TEXT("Unknown Control Command");
+	}
+	QueueText(Connection, RequestId, M2U_FRAME_FLAG_CONTROL, Reply);
+}
+
+
+void Fm2uNetworkThread::QueueResponses()
+{
+	Fm2uResponse Response;
+	while( Outbound.Dequeue(Response) )
+	{
+		Fm2uConnection* Connection = FindConnection(Response.ConnectionId);
+		if( Connection == NULL )
+			continue; // the client that asked is gone
+		QueueText(Connection, Response.RequestId, Response.Flags, Response.Message);
+	}
+}
+
+
+void Fm2uNetworkThread::QueueText( Fm2uConnection* Connection, uint32 RequestId, uint32 Flags, const FString& Message )
+{
+	Fm2uTraceScope Trace(TEXT("Encode"), RequestId);
+	// encode into the reused scratch buffer, then append to the connection's
+	// send buffer where it is coalesced with the other pending responses
+	const int32 EncodedLen = m2uUtf8::EncodedLength(*Message, Message.Len());
+	EncodeBuffer.SetNumUninitialized(EncodedLen, false);
+	m2uUtf8::Encode(*Message, Message.Len(), EncodeBuffer.GetData());
+
+	if( Connection->Protocol != Em2uProtocol::Framed )
+	{
+		Connection->Sender.Write(EncodeBuffer.GetData(), EncodedLen);
+		return;
+	}
+
+	const uint8* Payload = EncodeBuffer.GetData();
+	int32 PayloadLength = EncodedLen;
+	if( Connection->CompressionThreshold > 0 && EncodedLen >= Connection->CompressionThreshold )
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		CompressedBuffer.SetNumUninitialized(4 + m2uCompression::CompressBound(EncodedLen), false);
+		m2uFraming::WriteUInt32(CompressedBuffer.GetData(), EncodedLen);
+		const int32 CompressedLen = 4 + m2uCompression::Compress(EncodeBuffer.GetData(), EncodedLen,
+																  CompressedBuffer.GetData() + 4, CompressionHashTable.GetData());
+		// incompressible data is sent as it is
+		if( CompressedLen < EncodedLen )
+		{
+			Payload = CompressedBuffer.GetData();
+			PayloadLength = CompressedLen;
+			Flags |= M2U_FRAME_FLAG_COMPRESSED;
+		}
+		CompressionStats.AddOut(EncodedLen, PayloadLength, FPlatformTime::Seconds() - StartTime);
+	}
+
+	uint8 Header[M2U_FRAME_HEADER_SIZE];
+	m2uFraming::WriteHeader(Header, PayloadLength, RequestId, Flags);
+	if( Connection->Transport != NULL )
+	{
+		Connection->Sender.Write(Header, M2U_FRAME_HEADER_SIZE);
+		Connection->Sender.Write(Payload, PayloadLength);
+	}
+	// keep responses for resuming, control frames only concern the connection
+	if( Connection->Session != NULL && (Flags & M2U_FRAME_FLAG_CONTROL) == 0 )
+	{
+		Connection->Session->Record(RequestId, Header, M2U_FRAME_HEADER_SIZE, Payload, PayloadLength);
+	}
+}
+
+
+bool Fm2uNetworkThread::FlushSends( Fm2uConnection* Connection )
+{
+	Fm2uRingBuffer& Sender = Connection->Sender;
+	Fm2uTraceScope Trace(TEXT("Send"), Connection->Id);
+	if( Sender.Num() == 0 )
+	{
+		Trace.Cancel();
+	}
+	while( Sender.Num() > 0 )
+	{
+		const uint8* First;
+		const uint8* Second;
+		int32 FirstNum, SecondNum;
+		Sender.GetReadSpans(0, Sender.Num(), First, FirstNum, Second, SecondNum);
+
+		int32 BytesSent = 0;
+		if( ! Connection->Transport->Send(First, FirstNum, BytesSent) )
+			return false;
+		Sender.Consume(BytesSent);
+		if( BytesSent < FirstNum )
+			break; // short write, resume with the rest in the next round
+	}
+	return true;
+}
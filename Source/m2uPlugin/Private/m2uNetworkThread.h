@@ -0,0 +1,188 @@
+#pragma once
+// Socket I/O on a dedicated thread
+
+#include "m2uConnection.h"
+#include "m2uTransformStream.h"
+
+// legacy messages are complete once the client has been silent for this long
+#define M2U_LEGACY_QUIET_TIME 0.005
+// the number of clients that may be connected at the same time
+#define DEFAULT_M2U_MAX_CLIENTS 8
+// stop reading commands from a client when this many response bytes are waiting
+// for it, and continue when it is down to the low watermark again
+#define M2U_SEND_HIGH_WATERMARK (16*1024*1024)
+#define M2U_SEND_LOW_WATERMARK (4*1024*1024)
+
+
+/**
+ * A received command waiting for execution and where to send the answer to.
+ */
+struct Fm2uCommand
+{
+	FString Command;
+	uint32 RequestId;
+	uint32 ConnectionId;
+	// frame flags the command came with, only M2U_FRAME_FLAG_ASYNC,
+	// M2U_FRAME_FLAG_BINARY and M2U_FRAME_FLAG_TRANSFORMS matter here
+	uint32 Flags;
+	// the binary data of a M2U_FRAME_FLAG_BINARY command, Command is only the
+	// text in front of it
+	TArray<uint8> Data;
+	// the records of a transform stream frame, M2U_FRAME_FLAG_TRANSFORMS
+	// has no text
+	TArray<Fm2uTransformRecord> Transforms;
+	// older commands this one replaced, they get the same answer
+	TArray<uint32> SupersededRequestIds;
+	// FPlatformTime::Seconds() when the command was received
+	double ReceiveTime;
+
+	Fm2uCommand()
+		:RequestId(0),
+		 ConnectionId(0),
+		 Flags(0),
+		 ReceiveTime(0.0)
+	{}
+
+	Fm2uCommand( FString InCommand, uint32 InRequestId, uint32 InConnectionId, uint32 InFlags = 0 )
+		:Command(MoveTemp(InCommand)),
+		 RequestId(InRequestId),
+		 ConnectionId(InConnectionId),
+		 Flags(InFlags),
+		 ReceiveTime(FPlatformTime::Seconds())
+	{}
+};
+
+/**
+ * The result of a command on its way back to the client it came from.
+ */
+struct Fm2uResponse
+{
+	FString Message;
+	uint32 RequestId;
+	uint32 ConnectionId;
+	// M2U_FRAME_FLAG_ASYNC marks an intermediate answer of a long-running command
+	uint32 Flags;
+
+	Fm2uResponse()
+		:RequestId(0),
+		 ConnectionId(0),
+		 Flags(0)
+	{}
+
+	Fm2uResponse( FString InMessage, uint32 InRequestId, uint32 InConnectionId, uint32 InFlags = 0 )
+		:Message(MoveTemp(InMessage)),
+		 RequestId(InRequestId),
+		 ConnectionId(InConnectionId),
+		 Flags(InFlags)
+	{}
+};
+
+
+/**
+ * Owns the client sockets and does all the receiving, decoding, encoding and
+ * sending, so the game thread only has to execute the commands.
+ *
+ * The game thread talks to it only through single-producer/single-consumer
+ * lock-free queues: decoded commands come out of DequeueCommand, results go in
+ * through QueueResponse and are routed to the connection they belong to.
+ * Sockets accepted by the TcpListener and other transports are handed over
+ * with AddClient from the listener threads.
+ */
+class Fm2uNetworkThread : public FRunnable
+{
+public:
+
+	Fm2uNetworkThread( int32 InMaxClients = DEFAULT_M2U_MAX_CLIENTS );
+	virtual ~Fm2uNetworkThread();
+
+	/* FRunnable implementation */
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	/**
+	 * Take ownership of a newly accepted socket. Called on the listener thread.
+	 * @return false if the client is declined because there are already
+	 * MaxClients connected, the socket is not taken then.
+	 */
+	bool AddClient( FSocket* Socket );
+
+	/**
+	 * Take ownership of a newly connected client of any other transport, see
+	 * the FSocket version. Called on the listener thread.
+	 */
+	bool AddClient( Fm2uTransport* Transport );
+
+	/** close all connections, called on the game thread */
+	void CloseClients();
+
+	/** get the next received command or transform stream frame, called on the game thread */
+	bool DequeueCommand( Fm2uCommand& OutCommand );
+
+	/** get the id of a connection that was closed, called on the game thread */
+	bool DequeueClosedConnection( uint32& OutConnectionId );
+
+	/** send a result to the client, called on the game thread */
+	void QueueResponse( Fm2uResponse&& Response );
+
+	const Fm2uCompressionStats& GetCompressionStats() const
+	{
+		return CompressionStats;
+	}
+
+private:
+
+	/** count a client that is about to be added, false if there is no room */
+	bool ReserveClient();
+	void AcceptNewClients();
+	/** @return true if anything was received */
+	bool ReceiveMessages( Fm2uConnection* Connection );
+	/** encode all results into the send buffers of their connections */
+	void QueueResponses();
+	/** encode and maybe compress a message into the send buffer of a connection */
+	void QueueText( Fm2uConnection* Connection, uint32 RequestId, uint32 Flags, const FString& Message );
+	/** @return false if the compressed payload is broken */
+	bool ConsumeCompressedText( Fm2uFrameDecoder& Receiver, int32 PayloadLength, FString& OutText );
+	/** decompress a payload into RawBuffer, @return false if it is broken */
+	bool ConsumeCompressed( Fm2uFrameDecoder& Receiver, int32 PayloadLength );
+	/** @return false if the transform records are broken */
+	bool ConsumeTransforms( Fm2uFrameDecoder& Receiver, const Fm2uFrameHeader& Header, TArray<Fm2uTransformRecord>& OutRecords );
+	/** split a binary command into its text and data, @return false if it is broken */
+	bool ConsumeBinaryCommand( Fm2uFrameDecoder& Receiver, const Fm2uFrameHeader& Header, Fm2uCommand& OutCommand );
+	/** answer a control frame, see m2uFraming.h */
+	void HandleControlCommand( Fm2uConnection* Connection, uint32 RequestId, const FString& Command );
+	/** @return false if the connection broke */
+	bool FlushSends( Fm2uConnection* Connection );
+	/** also finds connections that wait for their session to be resumed */
+	Fm2uConnection* FindConnection( uint32 ConnectionId ) const;
+	/** close a connection, or detach it from its client if it has a session */
+	void DropConnection( int32 Index );
+	void DropAllConnections();
+	/** hand the transports of clients that asked to resume over to their sessions */
+	void ResumeSessions();
+	/** close detached connections whose client didn't come back in time */
+	void ExpireSessions();
+	void CloseDetachedConnection( int32 Index );
+
+	FRunnableThread* Thread;
+	FThreadSafeCounter StopTaskCounter;
+	FThreadSafeCounter CloseRequestCounter;
+	// connected clients plus the ones about to be
+	FThreadSafeCounter NumClients;
+	const int32 MaxClients;
+
+	TQueue<Fm2uTransport*, EQueueMode::Mpsc> NewTransports;
+	TQueue<Fm2uCommand, EQueueMode::Spsc> Inbound;
+	TQueue<uint32, EQueueMode::Spsc> ClosedConnections;
+	TQueue<Fm2uResponse, EQueueMode::Spsc> Outbound;
+
+	// everything below is only touched on the network thread
+	TArray<Fm2uConnection*> Connections;
+	// connections with a session whose client is gone, see m2uSession.h
+	TArray<Fm2uConnection*> DetachedConnections;
+	uint32 LastConnectionId;
+	TArray<uint8> EncodeBuffer;
+	TArray<uint8> CompressedBuffer;
+	TArray<uint8> RawBuffer;
+	TArray<int32> CompressionHashTable;
+	Fm2uCompressionStats CompressionStats;
+};
@@ -14,11 +14,11 @@ class Fm2uOpAssetExport : public Fm2uOperation
 public:
 
 	Fm2uOpAssetExport( Fm2uOperationManager* Manager = NULL )
-		:Fm2uOperation( Manager ){}
+		:Fm2uOperation( Manager, {TEXT("ExportAsset")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 
 		if( FParse::Command(&Str, TEXT("ExportAsset")))
@@ -44,16 +44,63 @@ public:
 };
 
 
+/**
+ * Imports files one at a time, so a large import doesn't block other commands.
+ */
+class Fm2uImportAssetsTask : public Fm2uAsyncTask
+{
+public:
+
+	/**
+	 * @param InFilesAndDestinations pairs of a file path and the destination
+	 *        path to import it to, directories must already be expanded.
+	 */
+	Fm2uImportAssetsTask( TArray<TPair<FString, FString>>&& InFilesAndDestinations, bool bInForceNoOverwrite )
+		:FilesAndDestinations(MoveTemp(InFilesAndDestinations)),
+		 bForceNoOverwrite(bInForceNoOverwrite),
+		 NextImport(0)
+	{}
+
+	bool Step( FString& Result ) override
+	{
+		if( NextImport < FilesAndDestinations.Num() )
+		{
+			const TPair<FString, FString>& Import = FilesAndDestinations[NextImport++];
+			TArray<FString> Files;
+			Files.Add(Import.Key);
+			m2uAssetHelper::ImportAssets(Files, Import.Value, false, bForceNoOverwrite/*, &GetUserInput*/);
+		}
+		if( NextImport < FilesAndDestinations.Num() )
+			return false;
+		Result = TEXT("Ok");
+		return true;
+	}
+
+	float GetProgress() const override
+	{
+		if( FilesAndDestinations.Num() == 0 )
+			return 1.0f;
+		return (float)NextImport / FilesAndDestinations.Num();
+	}
+
+private:
+
+	TArray<TPair<FString, FString>> FilesAndDestinations;
+	bool bForceNoOverwrite;
+	int32 NextImport;
+};
+
+
 class Fm2uOpAssetImport : public Fm2uOperation
 {
 public:
 
 	Fm2uOpAssetImport( Fm2uOperationManager* Manager = NULL )
-		:Fm2uOperation( Manager ){}
+		:Fm2uOperation( Manager, {TEXT("ImportAssets"), TEXT("ImportAssetsBatch")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 		
 		if( FParse::Command(&Str, TEXT("ImportAssets")))
@@ -80,6 +127,48 @@ public:
 			return false;
 	}
 
+	/**
+	   Same commands as Execute, but the files are imported one per step of
+	   the returned task.
+	*/
+	Fm2uAsyncTask* ExecuteAsync( const TCHAR* Cmd ) override
+	{
+		const TCHAR* Str = Cmd;
+		TArray<TPair<FString, FString>> FilesAndDestinations;
+		bool bForceNoOverwrite = false;
+
+		if( FParse::Command(&Str, TEXT("ImportAssets")))
+		{
+			FString RootDestinationPath;
+			TArray<FString> Files;
+			ParseImportAssets(Str, bForceNoOverwrite, RootDestinationPath, Files);
+			m2uAssetHelper::ExpandDirectories(Files, RootDestinationPath, FilesAndDestinations);
+		}
+
+		else if( FParse::Command(&Str, TEXT("ImportAssetsBatch")))
+		{
+			TArray<TPair<FString, FString>> Batch;
+			if( ! ParseImportAssetsBatch(Str, bForceNoOverwrite, Batch) )
+			{
+				return NULL; // let Execute report the error
+			}
+			for( const TPair<FString, FString>& Import : Batch )
+			{
+				TArray<FString> Files;
+				Files.Add(Import.Key);
+				m2uAssetHelper::ExpandDirectories(Files, Import.Value, FilesAndDestinations);
+			}
+		}
+
+		else
+		{
+// cannot handle the passed command
+			return NULL;
+		}
+
+		return new Fm2uImportAssetsTask(MoveTemp(FilesAndDestinations), bForceNoOverwrite);
+	}
+
 /**
    will import all assets listed after the destination path into the destination
    path. It will not recreate folder structures, only import the files directly
@@ -92,20 +181,9 @@ public:
 	FString ImportAssets(const TCHAR* Str)
 	{
 		bool bForceNoOverwrite = false;
-		if(FParse::Bool(Str, TEXT("ForceNoOverwrite="), bForceNoOverwrite))
-		{
-			// jump over the next space
-			Str = FCString::Strchr(Str,' ');
-			if( Str != NULL)
-				Str++;
-		}
-		FString RootDestinationPath = FParse::Token(Str,0);
+		FString RootDestinationPath;
 		TArray<FString> Files;
-		FString AssetFile;
-		while( FParse::Token(Str, AssetFile, 0) )
-		{
-			Files.Add(AssetFile);
-		}
+		ParseImportAssets(Str, bForceNoOverwrite, RootDestinationPath, Files);
 		m2uAssetHelper::ImportAssets(Files, RootDestinationPath, false, bForceNoOverwrite/*, &GetUserInput*/ );
 		return TEXT("Ok");
 	}
@@ -123,9 +201,26 @@ public:
 */
 	FString ImportAssetsBatch(const TCHAR* Str)
 	{
-		FString AssetDestination;
-		FString AssetSource;
 		bool bForceNoOverwrite = false;
+		TArray<TPair<FString, FString>> Batch;
+		if( ! ParseImportAssetsBatch(Str, bForceNoOverwrite, Batch) )
+		{
+			return TEXT("1");
+		}
+		for( const TPair<FString, FString>& Import : Batch )
+		{
+			TArray<FString> Files;
+			Files.Add(Import.Key);
+			m2uAssetHelper::ImportAssets(Files, Import.Value, false, bForceNoOverwrite/*, &GetUserInput*/);
+		}
+		return TEXT("Ok");
+	}
+
+private:
+
+	/** parse the optional "ForceNoOverwrite=" and move Str behind it */
+	static void ParseForceNoOverwrite(const TCHAR*& Str, bool& bForceNoOverwrite)
+	{
 		if(FParse::Bool(Str, TEXT("ForceNoOverwrite="), bForceNoOverwrite))
 		{
 			// jump over the next space
@@ -133,26 +228,47 @@ public:
 			if( Str != NULL)
 				Str++;
 		}
+	}
+
+	/** parse the arguments of ImportAssets */
+	static void ParseImportAssets(const TCHAR* Str, bool& bForceNoOverwrite, FString& RootDestinationPath, TArray<FString>& Files)
+	{
+		ParseForceNoOverwrite(Str, bForceNoOverwrite);
+		if( Str == NULL )
+			return;
+		RootDestinationPath = FParse::Token(Str,0);
+		FString AssetFile;
+		while( FParse::Token(Str, AssetFile, 0) )
+		{
+			Files.Add(AssetFile);
+		}
+	}
+
+	/**
+	   parse the arguments of ImportAssetsBatch into pairs of file path and
+	   destination. The whole list is checked before anything is imported.
+	   @return false if the list is uneven
+	*/
+	static bool ParseImportAssetsBatch(const TCHAR* Str, bool& bForceNoOverwrite, TArray<TPair<FString, FString>>& OutBatch)
+	{
+		ParseForceNoOverwrite(Str, bForceNoOverwrite);
+		if( Str == NULL )
+			return true;
+		FString AssetDestination;
+		FString AssetSource;
 		while( FParse::Token(Str, AssetDestination, 0) )
 		{
 			if( FParse::Token(Str, AssetSource, 0) )
 			{
-				TArray<FString> Files;
-				Files.Add(AssetSource);
-				m2uAssetHelper::ImportAssets(Files, AssetDestination, false, bForceNoOverwrite/*, &GetUserInput*/);
+				OutBatch.Add(TPairInitializer<FString, FString>(AssetSource, AssetDestination));
 			}
 			else // there is an uneven list of Destination<->FilePath infos
 			{
-// TODO: maybe store all associations in a pair-list first,
-// and start the import process only if they are even. Because
-// the reason for unevenness may be earlier than the end of the list.
-// We would import crap then maybe or create invalid destination paths
-// which in turn might crash the editor.
 				UE_LOG(LogM2U, Error, TEXT("Uneven list of Destination<->FilePath infos for Import."));
-				return TEXT("1");
+				return false;
 			}
 		}
-		return TEXT("Ok");
+		return true;
 	}
 
 };
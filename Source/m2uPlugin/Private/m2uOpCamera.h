@@ -6,43 +6,38 @@
 #include "ActorEditorUtils.h"
 #include "UnrealEd.h"
 #include "m2uHelper.h"
+#include "m2uInvalidation.h"
 
 class Fm2uOpCamera : public Fm2uOperation
 {
 public:
 
 	Fm2uOpCamera( Fm2uOperationManager* Manager = NULL )
-		:Fm2uOperation( Manager ){}
+		:Fm2uOperation( Manager, {TEXT("TransformCamera")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 
 		if( FParse::Command(&Str, TEXT("TransformCamera")))
 		{
 			/* this command is meant for viewports, not for camera Actors */
-			const TCHAR* Stream = Str;
-			FVector Loc;
-			Stream = GetFVECTORSpaceDelimited( Stream, Loc );
-			// jump over the space
-			Stream = FCString::Strchr(Stream,' ');
-			if( Stream != NULL )
-			{
-				++Stream;
-			}
-			FRotator Rot;
-			Stream = GetFROTATORSpaceDelimited( Stream, Rot, 1.0f );
+			// "x y z pitch yaw roll"
+			float Values[6];
+			const TCHAR* Stream = m2uParse::ParseFloats( Str, Values, 6 );
 
 			if( Stream != NULL )
 			{
+				const FVector Loc( Values[0], Values[1], Values[2] );
+				const FRotator Rot( Values[3], Values[4], Values[5] );
 				for( int32 i=0; i<GEditor->LevelViewportClients.Num(); i++ )
 				{
 					GEditor->LevelViewportClients[i]->SetViewLocation( Loc );
 					GEditor->LevelViewportClients[i]->SetViewRotation( Rot );
 				}
 			}
-			GEditor->RedrawLevelEditingViewports();
+			m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
 		}
 
 		else
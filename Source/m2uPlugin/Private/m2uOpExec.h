@@ -9,11 +9,11 @@ class Fm2uOpExec : public Fm2uOperation
 public:
 
 	Fm2uOpExec( Fm2uOperationManager* Manager = NULL )
-		:Fm2uOperation( Manager ){}
+		:Fm2uOperation( Manager, {TEXT("Exec")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		if( FParse::Command(&Str, TEXT("Exec")))
 		{
 			if( GEditor->Exec(GEditor->GetEditorWorldContext().World(), Str) )
@@ -8,16 +8,51 @@
 #include "m2uHelper.h"
 
 
+/**
+ * Exports the selection in one step. The export itself can't be split up, but
+ * the client gets its "Accepted" right away and the commands that were queued
+ * before are not held up by it.
+ */
+class Fm2uFetchSelectedTask : public Fm2uAsyncTask
+{
+public:
+
+	Fm2uFetchSelectedTask( const FString& InFilePath )
+		:FilePath(InFilePath),
+		 bDone(false)
+	{}
+
+	bool Step( FString& Result ) override
+	{
+		auto World = GEditor->GetEditorWorldContext().World();
+		GEditor->ExportMap(World, *FilePath, true);
+		bDone = true;
+		Result = TEXT("Ok");
+		return true;
+	}
+
+	float GetProgress() const override
+	{
+		return bDone ? 1.0f : 0.0f;
+	}
+
+private:
+
+	FString FilePath;
+	bool bDone;
+};
+
+
 class Fm2uOpFastFetch : public Fm2uOperation
 {
 public:
 
 Fm2uOpFastFetch( Fm2uOperationManager* Manager = NULL )
-	:Fm2uOperation( Manager ){}
+	:Fm2uOperation( Manager, {TEXT("FetchSelected")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 
 		// fast fetching exports the selected objects simply into an fbx (or obj) file
@@ -41,4 +76,14 @@ Fm2uOpFastFetch( Fm2uOperationManager* Manager = NULL )
 		else
 			return false;
 	}
+
+	Fm2uAsyncTask* ExecuteAsync( const TCHAR* Cmd ) override
+	{
+		const TCHAR* Str = Cmd;
+		if( FParse::Command(&Str, TEXT("FetchSelected")))
+		{
+			return new Fm2uFetchSelectedTask(FParse::Token(Str,0));
+		}
+		return NULL;
+	}
 };
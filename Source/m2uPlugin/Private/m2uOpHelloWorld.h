@@ -8,11 +8,11 @@ class Fm2uOpHelloWorld : public Fm2uOperation
 public:
 
 	Fm2uOpHelloWorld( Fm2uOperationManager* Manager = NULL )
-		:Fm2uOperation( Manager ){}
+		:Fm2uOperation( Manager, {TEXT("HelloWorld")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		if( FParse::Command(&Str, TEXT("HelloWorld")))
 		{
 			Result = TEXT("Hellow World");
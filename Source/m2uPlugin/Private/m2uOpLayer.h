@@ -14,55 +14,61 @@ class Fm2uOpLayer : public Fm2uOperation
 public:
 
 Fm2uOpLayer( Fm2uOperationManager* Manager = NULL )
-	:Fm2uOperation( Manager ){}
+	:Fm2uOperation( Manager, {TEXT("AddObjectsToLayer"), TEXT("RemoveObjectsFromAllLayers"), TEXT("HideLayer"), TEXT("UnhideLayer"), TEXT("DeleteLayer"), TEXT("RenameLayer")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 
 		if( FParse::Command(&Str, TEXT("AddObjectsToLayer")))
 		{
-			FString LayerName = FParse::Token(Str,0);
-			FString ActorNamesList = FParse::Token(Str,0);
+			TCHAR LayerName[NAME_SIZE];
+			FParse::Token(Str, LayerName, ARRAY_COUNT(LayerName), false);
+			const FName LayerFName(LayerName);
 			bool bRemoveFromOthers = true;
 			FParse::Bool(Str, TEXT("RemoveFromOthers="), bRemoveFromOthers);
 
-			UE_LOG(LogM2U, Log, TEXT("AddObjectsToLayer received: %s %s"), *LayerName, *ActorNamesList);
+			UE_LOG(LogM2U, Log, TEXT("AddObjectsToLayer received: %s %s"), LayerName, Str);
 
-			TArray<FString> ActorNames = m2uHelper::ParseList(ActorNamesList);
-			for( FString ActorName : ActorNames )
+			// the same for all actors
+			TArray<FName> AllLayerNames;
+			if( bRemoveFromOthers )
 			{
-				UE_LOG(LogM2U, Log, TEXT("Actor Names List: %s"), *ActorName);
+				GEditor->Layers->AddAllLayerNamesTo(AllLayerNames);
+			}
+			Fm2uListParser ActorNames = m2uHelper::ParseList(Str);
+			TCHAR ActorName[NAME_SIZE];
+			while( ActorNames.Next(ActorName, ARRAY_COUNT(ActorName)) )
+			{
+				UE_LOG(LogM2U, Verbose, TEXT("Actor Names List: %s"), ActorName);
 				AActor* Actor;
-				if( m2uHelper::GetActorByName( *ActorName, &Actor) )
+				if( m2uHelper::GetActorByName( ActorName, &Actor) )
 				{
 					//if( FCString::Stricmp( *RemoveFromOthers, TEXT("True") )==0 )
 					if( bRemoveFromOthers )
 					{
-						UE_LOG(LogM2U, Log, TEXT("Removing Actor %s from all Others"), *ActorName);
-						TArray<FName> AllLayerNames;
-						GEditor->Layers->AddAllLayerNamesTo(AllLayerNames);
+						UE_LOG(LogM2U, Verbose, TEXT("Removing Actor %s from all Others"), ActorName);
 						GEditor->Layers->RemoveActorFromLayers(Actor, AllLayerNames);
 					}
-					UE_LOG(LogM2U, Log, TEXT("Adding Actor %s to Layer %s"), *ActorName, *LayerName);
-					GEditor->Layers->AddActorToLayer(Actor, FName(*LayerName));
+					UE_LOG(LogM2U, Verbose, TEXT("Adding Actor %s to Layer %s"), ActorName, LayerName);
+					GEditor->Layers->AddActorToLayer(Actor, LayerFName);
 				}
 			}
 		}
 
 		else if( FParse::Command(&Str, TEXT("RemoveObjectsFromAllLayers")))
 		{
-			FString ActorNamesList = FParse::Token(Str,0);
-			TArray<FString> ActorNames = m2uHelper::ParseList(ActorNamesList);
-			for( FString ActorName : ActorNames )
+			TArray<FName> AllLayerNames;
+			GEditor->Layers->AddAllLayerNamesTo(AllLayerNames);
+			Fm2uListParser ActorNames = m2uHelper::ParseList(Str);
+			TCHAR ActorName[NAME_SIZE];
+			while( ActorNames.Next(ActorName, ARRAY_COUNT(ActorName)) )
 			{
 				AActor* Actor;
-				if( m2uHelper::GetActorByName( *ActorName, &Actor) )
+				if( m2uHelper::GetActorByName( ActorName, &Actor) )
 				{
-					UE_LOG(LogM2U, Log, TEXT("Removing Actor %s from all Layers."), *ActorName);
-					TArray<FName> AllLayerNames;
-					GEditor->Layers->AddAllLayerNamesTo(AllLayerNames);
+					UE_LOG(LogM2U, Verbose, TEXT("Removing Actor %s from all Layers."), ActorName);
 					GEditor->Layers->RemoveActorFromLayers(Actor, AllLayerNames);
 				}
 			}
@@ -70,31 +76,36 @@ Fm2uOpLayer( Fm2uOperationManager* Manager = NULL )
 
 		else if( FParse::Command(&Str, TEXT("HideLayer")))
 		{
-			FString LayerName = FParse::Token(Str,0);
-			GEditor->Layers->SetLayerVisibility(FName(*LayerName), false);
-			UE_LOG(LogM2U, Log, TEXT("Hiding Layer: %s"), *LayerName);
+			TCHAR LayerName[NAME_SIZE];
+			FParse::Token(Str, LayerName, ARRAY_COUNT(LayerName), false);
+			GEditor->Layers->SetLayerVisibility(FName(LayerName), false);
+			UE_LOG(LogM2U, Log, TEXT("Hiding Layer: %s"), LayerName);
 		}
 
 		else if( FParse::Command(&Str, TEXT("UnhideLayer")))
 		{
-			FString LayerName = FParse::Token(Str,0);
-			GEditor->Layers->SetLayerVisibility(FName(*LayerName), true);
-			UE_LOG(LogM2U, Log, TEXT("Unhiding Layer: %s"), *LayerName);
+			TCHAR LayerName[NAME_SIZE];
+			FParse::Token(Str, LayerName, ARRAY_COUNT(LayerName), false);
+			GEditor->Layers->SetLayerVisibility(FName(LayerName), true);
+			UE_LOG(LogM2U, Log, TEXT("Unhiding Layer: %s"), LayerName);
 		}
 
 		else if( FParse::Command(&Str, TEXT("DeleteLayer")))
 		{
-			FString LayerName = FParse::Token(Str,0);
-			GEditor->Layers->DeleteLayer(FName(*LayerName));
-			UE_LOG(LogM2U, Log, TEXT("Deleting Layer: %s"), *LayerName);
+			TCHAR LayerName[NAME_SIZE];
+			FParse::Token(Str, LayerName, ARRAY_COUNT(LayerName), false);
+			GEditor->Layers->DeleteLayer(FName(LayerName));
+			UE_LOG(LogM2U, Log, TEXT("Deleting Layer: %s"), LayerName);
 		}
 
 		else if( FParse::Command(&Str, TEXT("RenameLayer")))
 		{
-			FString OldName = FParse::Token(Str,0);
-			FString NewName = FParse::Token(Str,0);
-			GEditor->Layers->RenameLayer(FName(*OldName), FName(*NewName));
-			UE_LOG(LogM2U, Log, TEXT("Renaming Layer %s to %s"), *OldName, *NewName);
+			TCHAR OldName[NAME_SIZE];
+			TCHAR NewName[NAME_SIZE];
+			FParse::Token(Str, OldName, ARRAY_COUNT(OldName), false);
+			FParse::Token(Str, NewName, ARRAY_COUNT(NewName), false);
+			GEditor->Layers->RenameLayer(FName(OldName), FName(NewName));
+			UE_LOG(LogM2U, Log, TEXT("Renaming Layer %s to %s"), OldName, NewName);
 		}
 
 		else
@@ -6,6 +6,9 @@
 #include "ActorEditorUtils.h"
 #include "UnrealEd.h"
 #include "m2uHelper.h"
+#include "m2uActorRecords.h"
+#include "m2uTransformStream.h"
+#include "m2uInvalidation.h"
 
 
 class Fm2uOpObjectTransform : public Fm2uOperation
@@ -13,60 +16,145 @@ class Fm2uOpObjectTransform : public Fm2uOperation
 public:
 
 Fm2uOpObjectTransform( Fm2uOperationManager* Manager = NULL )
-	:Fm2uOperation( Manager ){}
+	:Fm2uOperation( Manager, {TEXT("TransformObject")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
-		bool DidExecute = true;
+		return ExecuteTokens(Fm2uTokenTable(Cmd), Result);
+	}
 
-		if( FParse::Command(&Str, TEXT("TransformObject")))
+	bool ExecuteTokens( const Fm2uTokenTable& Tokens, FString& Result ) override
+	{
+		if( ! Tokens.GetKeyword().EqualsIgnoreCase("TransformObject") )
 		{
-			Result = TransformObject(Str);
+// cannot handle the passed command
+			return false;
 		}
+		Result = TransformObject(Tokens);
+		return true;
+	}
 
-		else
+	/** TransformObject with actor records, see m2uActorRecords.h */
+	bool ExecuteBinary( const TCHAR* Cmd, const uint8* Data, int32 Num, FString& Result ) override
+	{
+		if( ! Fm2uTokenTable(Cmd).GetKeyword().EqualsIgnoreCase("TransformObject") )
 		{
-// cannot handle the passed command
-			DidExecute = false;
+			return false;
 		}
-
-		if( DidExecute )
+		Fm2uActorRecords Records;
+		if( ! m2uActorRecords::Decode(Data, Num, Records) )
+		{
+			Result = TEXT("1");
 			return true;
-		else
-			return false;
+		}
+		for( int32 Idx = 0; Idx < Records.Names.Num(); ++Idx )
+		{
+			AActor* Actor = NULL;
+			if( m2uHelper::GetActorByName(*Records.Names[Idx], &Actor) && Actor != NULL )
+			{
+				m2uHelper::SetActorTransformRelative(Actor, Records.Transforms[Idx]);
+			}
+			else
+			{
+				UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *Records.Names[Idx]);
+				Records.Names[Idx].Empty();
+			}
+		}
+		m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
+		Result = m2uActorRecords::MakeNameList(Records.Names);
+		return true;
 	}
 
-	FString TransformObject(const TCHAR* Str)
+	/** TransformObject <Name> T=(x y z) R=(p y r) S=(x y z) */
+	FString TransformObject(const Fm2uTokenTable& Tokens)
 	{
-		const FString ActorName = FParse::Token(Str,0);
+		TCHAR ActorName[NAME_SIZE] = TEXT("");
+		if( Tokens.Num() > 1 )
+		{
+			Tokens.Get(1).CopyTo(ActorName, ARRAY_COUNT(ActorName));
+		}
 		AActor* Actor = NULL;
-		//UE_LOG(LogM2U, Log, TEXT("Searching for Actor with name %s"), *ActorName);
+		//UE_LOG(LogM2U, Log, TEXT("Searching for Actor with name %s"), ActorName);
 
-		if(!m2uHelper::GetActorByName(*ActorName, &Actor) || Actor == NULL)
+		if(!m2uHelper::GetActorByName(ActorName, &Actor) || Actor == NULL)
 		{
-			UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *ActorName);
+			UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), ActorName);
 			return TEXT("1");
 		}
 
-		m2uHelper::SetActorTransformRelativeFromText(Actor, Str);
+		Fm2uTransformText Transform;
+		m2uParse::ParseTransform(Tokens, Transform, 2);
+		m2uHelper::SetActorTransformRelative(Actor, Transform);
 
-		GEditor->RedrawLevelEditingViewports();
+		m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
 		return TEXT("Ok");
 	}
 };
 
 
+/**
+ * Hands out the actor handles used by the binary transform stream, see
+ * m2uTransformStream.h.
+ */
+class Fm2uOpObjectHandle : public Fm2uOperation
+{
+public:
+
+Fm2uOpObjectHandle( Fm2uOperationManager* Manager = NULL )
+	:Fm2uOperation( Manager, {TEXT("GetActorHandles")} ){}
+
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
+	{
+		const TCHAR* Str = Cmd;
+		bool DidExecute = true;
+
+		if( FParse::Command(&Str, TEXT("GetActorHandles")))
+		{
+			Fm2uListParser ActorNames = m2uHelper::ParseList(Str);
+			Fm2uActorHandleTable& Handles = m2uTransformStream::GetActorHandles();
+			Result = TEXT("[");
+			TCHAR ActorName[NAME_SIZE];
+			TCHAR Number[16];
+			for( int32 Idx = 0; ActorNames.Next(ActorName, ARRAY_COUNT(ActorName)); ++Idx )
+			{
+				AActor* Actor = NULL;
+				uint32 Handle = 0;
+				if( m2uHelper::GetActorByName( ActorName, &Actor) )
+				{
+					Handle = Handles.GetHandle(Actor);
+				}
+				if( Idx > 0 )
+					Result += TEXT(",");
+				FCString::Sprintf(Number, TEXT("%u"), Handle);
+				Result += Number;
+			}
+			Result += TEXT("]");
+		}
+
+		else
+		{
+// cannot handle the passed command
+			DidExecute = false;
+		}
+
+		if( DidExecute )
+			return true;
+		else
+			return false;
+	}
+};
+
+
 class Fm2uOpObjectName : public Fm2uOperation
 {
 public:
 
 Fm2uOpObjectName( Fm2uOperationManager* Manager = NULL )
-	:Fm2uOperation( Manager ){}
+	:Fm2uOperation( Manager, {TEXT("GetFreeName"), TEXT("RenameObject")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 
 		if( FParse::Command(&Str, TEXT("GetFreeName")))
@@ -78,7 +166,8 @@ Fm2uOpObjectName( Fm2uOperationManager* Manager = NULL )
 
 		else if( FParse::Command(&Str, TEXT("RenameObject")))
 		{
-			const FString ActorName = FParse::Token(Str,0);
+			TCHAR ActorName[NAME_SIZE];
+			FParse::Token(Str, ActorName, ARRAY_COUNT(ActorName), false);
 			// jump over the next space
 			Str = FCString::Strchr(Str,' ');
 			if( Str != NULL)
@@ -88,15 +177,16 @@ Fm2uOpObjectName( Fm2uOperationManager* Manager = NULL )
 
 			// find the Actor
 			AActor* Actor = NULL;
-			if(!m2uHelper::GetActorByName(*ActorName, &Actor) || Actor == NULL)
+			if(!m2uHelper::GetActorByName(ActorName, &Actor) || Actor == NULL)
 			{
-				UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *ActorName);
+				UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), ActorName);
 				Result = TEXT("1"); // NOT FOUND
 			}
 
 			// try to rename the actor		  
 			const FName ResultName = RenameActor(Actor, NewName);
 			Result = ResultName.ToString();
+			m2uInvalidation::Invalidate(Em2uInvalidation::Outliner);
 		}
 
 		else
@@ -230,11 +320,11 @@ class Fm2uOpObjectDelete : public Fm2uOperation
 public:
 
 Fm2uOpObjectDelete( Fm2uOperationManager* Manager = NULL )
-	:Fm2uOperation( Manager ){}
+	:Fm2uOperation( Manager, {TEXT("DeleteSelected"), TEXT("DeleteObject")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 
 		if( FParse::Command(&Str, TEXT("DeleteSelected")))
@@ -256,8 +346,9 @@ Fm2uOpObjectDelete( Fm2uOperationManager* Manager = NULL )
 			// TODO: maybe we could reselect the previous selection after the delete op
 			// but this is probably in 99% of the cases not necessary
 			GEditor->SelectNone(true, true, false);
-			const FString ActorName = FParse::Token(Str,0);
-			AActor* Actor = GEditor->SelectNamedActor(*ActorName);
+			TCHAR ActorName[NAME_SIZE];
+			FParse::Token(Str, ActorName, ARRAY_COUNT(ActorName), false);
+			AActor* Actor = GEditor->SelectNamedActor(ActorName);
 			auto World = GEditor->GetEditorWorldContext().World();
 			((UUnrealEdEngine*)GEditor)->edactDeleteSelected(World);
 
@@ -283,24 +374,25 @@ class Fm2uOpObjectDuplicate : public Fm2uOperation
 public:
 
 Fm2uOpObjectDuplicate( Fm2uOperationManager* Manager = NULL )
-	:Fm2uOperation( Manager ){}
+	:Fm2uOperation( Manager, {TEXT("DuplicateObject")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 
 		if( FParse::Command(&Str, TEXT("DuplicateObject")))
 		{
-			const FString ActorName = FParse::Token(Str,0);
+			TCHAR ActorName[NAME_SIZE];
+			FParse::Token(Str, ActorName, ARRAY_COUNT(ActorName), false);
 			AActor* OrigActor = NULL;
 			AActor* Actor = NULL; // the duplicate
-			//UE_LOG(LogM2U, Log, TEXT("Searching for Actor with name %s"), *ActorName);
+			//UE_LOG(LogM2U, Log, TEXT("Searching for Actor with name %s"), ActorName);
 
 			// Find the Original to clone
-			if(!m2uHelper::GetActorByName(*ActorName, &OrigActor) || OrigActor == NULL)
+			if(!m2uHelper::GetActorByName(ActorName, &OrigActor) || OrigActor == NULL)
 			{
-				UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *ActorName);
+				UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), ActorName);
 				Result = TEXT("1"); // original not found
 			}
 
@@ -317,7 +409,7 @@ Fm2uOpObjectDuplicate( Fm2uOperationManager* Manager = NULL )
 
 			// select only the actor we want to duplicate
 			GEditor->SelectNone(true, true, false);
-			//OrigActor = GEditor->SelectNamedActor(*ActorName); // actor to duplicate
+			//OrigActor = GEditor->SelectNamedActor(ActorName); // actor to duplicate
 			GEditor->SelectActor(OrigActor, true, false);
 			auto World = GEditor->GetEditorWorldContext().World();
 			// Do the duplication
@@ -333,7 +425,7 @@ Fm2uOpObjectDuplicate( Fm2uOperationManager* Manager = NULL )
 			// if there are transform parameters in the command, apply them
 			m2uHelper::SetActorTransformRelativeFromText(Actor, Str);
 
-			GEditor->RedrawLevelEditingViewports();
+			m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
 
 			// Try to set the actor's name to DupName
 			// NOTE: a unique name was already assigned during the actual duplicate
@@ -379,33 +471,64 @@ class Fm2uOpObjectAdd : public Fm2uOperation
 public:
 
 Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
-	:Fm2uOperation( Manager ){}
+	:Fm2uOperation( Manager, {TEXT("AddActor"), TEXT("AddActorBatch")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
-		bool DidExecute = true;
+		Fm2uTokenTable Tokens;
+		Tokens.TokenizeFirst(Cmd, FCString::Strlen(Cmd), 1);
+		if( NeedsAllTokens(Tokens.GetKeyword()) )
+		{
+			Tokens.TokenizeRest();
+		}
+		return ExecuteTokens(Tokens, Result);
+	}
+
+	/** AddActorBatch splits every line on its own */
+	bool NeedsAllTokens( const Tm2uTextView<TCHAR>& Keyword ) const override
+	{
+		return ! Keyword.EqualsIgnoreCase("AddActorBatch");
+	}
 
-		if( FParse::Command(&Str, TEXT("AddActor")))
+	bool ExecuteTokens( const Fm2uTokenTable& Tokens, FString& Result ) override
+	{
+		const Tm2uTextView<TCHAR> Keyword = Tokens.GetKeyword();
+		if( Keyword.EqualsIgnoreCase("AddActor") )
 		{
-			Result = AddActor(Str);
+			Result = AddActor(Tokens, 1);
 		}
 
-		else if( FParse::Command(&Str, TEXT("AddActorBatch")))
+		else if( Keyword.EqualsIgnoreCase("AddActorBatch") )
 		{
-			Result = AddActorBatch(Str);
+			// the lines begin behind the keyword, only it is split, see
+			// NeedsAllTokens
+			const Fm2uToken& First = Tokens.GetToken(0);
+			Result = AddActorBatch(Tokens.GetText() + First.Start + Keyword.Len, Tokens.GetTextLen() - First.Start - Keyword.Len);
 		}
 
 		else
 		{
 // cannot handle the passed command
-			DidExecute = false;
+			return false;
 		}
+		return true;
+	}
 
-		if( DidExecute )
-			return true;
-		else
+	/** AddActorBatch with actor records, see m2uActorRecords.h */
+	bool ExecuteBinary( const TCHAR* Cmd, const uint8* Data, int32 Num, FString& Result ) override
+	{
+		if( ! Fm2uTokenTable(Cmd).GetKeyword().EqualsIgnoreCase("AddActorBatch") )
+		{
 			return false;
+		}
+		Fm2uActorRecords Records;
+		if( ! m2uActorRecords::Decode(Data, Num, Records) )
+		{
+			Result = TEXT("1");
+			return true;
+		}
+		Result = AddActorRecords(Records);
+		return true;
 	}
 
 /**
@@ -418,16 +541,23 @@ Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
    That name will be returned to the caller. If the name result is not as desired,
    the caller might want to rename the source-object (see object rename functions).
 */
-	FString AddActor(const TCHAR* Str)
+	FString AddActor(const Fm2uTokenTable& Tokens, int32 FirstToken)
 	{
-		FString AssetName = FParse::Token(Str,0);
-		const FString ActorName = FParse::Token(Str,0);
+		// <AssetName> <ActorName> [EditIfExists=Bool] [T=(x y z) R=(p y r) S=(x y z)]
+		const Tm2uTextView<TCHAR> AssetToken = FirstToken < Tokens.Num() ? Tokens.Get(FirstToken) : Tm2uTextView<TCHAR>();
+		const Tm2uTextView<TCHAR> NameToken = FirstToken + 1 < Tokens.Num() ? Tokens.Get(FirstToken + 1) : Tm2uTextView<TCHAR>();
+		FString AssetName( AssetToken.Len, AssetToken.Data );
+		const FString ActorName( NameToken.Len, NameToken.Data );
 		auto World = GEditor->GetEditorWorldContext().World();
 		ULevel* Level = World->GetCurrentLevel();
 		
 		// Parse additional parameters
 		bool bEditIfExists = true;
-		FParse::Bool(Str, TEXT("EditIfExists="), bEditIfExists);
+		const int32 EditIfExists = Tokens.Find("EditIfExists", FirstToken + 2);
+		if( EditIfExists >= 0 )
+		{
+			bEditIfExists = m2uParse::ToBool(Tokens.GetValue(EditIfExists));
+		}
 		// Note: Replacing would happen if the object to create is of a different type 
 		// than the one that already has that desired name. 
 		// it is very unlikely that in that case not simply a new name can be used
@@ -465,7 +595,9 @@ Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
 		// now we might have transformation data in that string
 		// so set that, while we already have that actor
 		// (no need in searching it again later
-		m2uHelper::SetActorTransformRelativeFromText(Actor, Str);
+		Fm2uTransformText Transform;
+		m2uParse::ParseTransform(Tokens, Transform, FirstToken + 2);
+		m2uHelper::SetActorTransformRelative(Actor, Transform);
 		// TODO: set other attributes
 		// TODO: set asset-reference (mesh) at least if bEdit
 
@@ -479,21 +611,82 @@ Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
 	   add multiple actors from the string,
 	   expects every line to be a new actor
 	*/
-	FString AddActorBatch(const TCHAR* Str)
+	FString AddActorBatch(const TCHAR* Str, int32 Len)
 	{
 		UE_LOG(LogM2U, Log, TEXT("Batch Add parsing lines"));
-		FString Line;
-		while( FParse::Line(&Str, Line, 0) )
+		// every line is split where it is, into the same table
+		Fm2uTokenTable LineTokens;
+		const TCHAR* End = Str + Len;
+		while( Str < End )
 		{
-			if( Line.IsEmpty() )
+			const TCHAR* Line = Str;
+			while( Str < End && *Str != '\n' && *Str != '\r' )
+			{
+				++Str;
+			}
+			LineTokens.Tokenize(Line, (int32)(Str - Line));
+			if( Str < End )
+			{
+				++Str; // the line break
+			}
+			if( LineTokens.Num() == 0 )
 				continue;
-			UE_LOG(LogM2U, Log, TEXT("Read one Line: %s"),*Line);
-			AddActor(*Line);
+			UE_LOG(LogM2U, Verbose, TEXT("Read one Line: %s"), *FString(LineTokens.GetTextLen(), Line));
+			AddActor(LineTokens, 0);
 		}
 		// TODO: return a list of the created names
 		return TEXT("Ok");
 	}
 
+	/**
+	   add or edit the actors of all records, every asset is only looked up
+	   once. Returns the list of resulting names.
+	*/
+	FString AddActorRecords(Fm2uActorRecords& Records)
+	{
+		UE_LOG(LogM2U, Log, TEXT("Batch Add %i actor records"), Records.Names.Num());
+		TArray<UObject*> Assets;
+		Assets.Reserve(Records.AssetPaths.Num());
+		for( const FString& Path : Records.AssetPaths )
+		{
+			UObject* Asset = m2uAssetHelper::GetAssetFromPath(Path);
+			if( Asset == NULL )
+			{
+				UE_LOG(LogM2U, Warning, TEXT("Asset not found: %s"), *Path);
+			}
+			Assets.Add(Asset);
+		}
+
+		ULevel* Level = GEditor->GetEditorWorldContext().World()->GetCurrentLevel();
+		for( int32 Idx = 0; Idx < Records.Names.Num(); ++Idx )
+		{
+			FString& ActorName = Records.Names[Idx];
+			const int32 AssetIndex = Records.AssetIndices[Idx];
+			// like AddActor with EditIfExists=true
+			const FName ActorFName = m2uHelper::GetFreeName(ActorName);
+			AActor* Actor = NULL;
+			if( ActorFName.ToString() != ActorName )
+			{
+				m2uHelper::GetActorByName(*ActorName, &Actor);
+			}
+			else if( AssetIndex != INDEX_NONE && Assets[AssetIndex] != NULL )
+			{
+				Actor = AddNewActorFromAsset(Assets[AssetIndex], Level, ActorFName, false);
+			}
+
+			if( Actor == NULL )
+			{
+				UE_LOG(LogM2U, Log, TEXT("Actor %s could not be added or edited."), *ActorName);
+				ActorName.Empty();
+				continue;
+			}
+			m2uHelper::SetActorTransformRelative(Actor, Records.Transforms[Idx]);
+			ActorName = Actor->GetFName().ToString();
+		}
+		m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
+		return m2uActorRecords::MakeNameList(Records.Names);
+	}
+
 	/**
  * Spawn a new Actor in the Level. Automatically find the type of Actor to create 
  * based on the type of Asset. 
@@ -520,6 +713,16 @@ Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
 		if( Asset == NULL)
 			return NULL;
 
+		return AddNewActorFromAsset(Asset, InLevel, Name, bSelectActor, ObjectFlags);
+	}
+
+	/** the same for an Asset that is already loaded */
+	AActor* AddNewActorFromAsset( UObject* Asset,
+								  ULevel* InLevel,
+								  FName Name = NAME_None,
+								  bool bSelectActor = true,
+								  EObjectFlags ObjectFlags = RF_Transactional)
+	{
 		//UClass* AssetClass = Asset->GetClass();
 		
 		if( Name == NAME_None)
@@ -556,7 +759,8 @@ Fm2uOpObjectAdd( Fm2uOperationManager* Manager = NULL )
 		if( bSelectActor )
 		{
 			GEditor->SelectNone( false, true);
-			GEditor->SelectActor( Actor, true, true);
+			GEditor->SelectActor( Actor, true, false);
+			m2uInvalidation::Invalidate(Em2uInvalidation::Selection);
 		}
 		Actor->InvalidateLightingCache();
 		Actor->PostEditChange();
@@ -580,11 +784,11 @@ class Fm2uOpObjectParent : public Fm2uOperation
 public:
 
 Fm2uOpObjectParent( Fm2uOperationManager* Manager = NULL )
-	:Fm2uOperation( Manager ){}
+	:Fm2uOperation( Manager, {TEXT("ParentChildTo")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 
 		if( FParse::Command(&Str, TEXT("ParentChildTo")))
@@ -606,22 +810,23 @@ Fm2uOpObjectParent( Fm2uOperationManager* Manager = NULL )
 
 	FString ParentChildTo(const TCHAR* Str)
 	{
-		const FString ChildName = FParse::Token(Str,0);
+		TCHAR ChildName[NAME_SIZE];
+		FParse::Token(Str, ChildName, ARRAY_COUNT(ChildName), false);
 		Str = FCString::Strchr(Str,' ');
-		FString ParentName;
+		TCHAR ParentName[NAME_SIZE] = TEXT("");
 		if( Str != NULL) // there may be a parent name present
 		{
 			Str++;
 			if( *Str != '\0' ) // there was a space, but no name after that
 			{
-				ParentName = FParse::Token(Str,0);
+				FParse::Token(Str, ParentName, ARRAY_COUNT(ParentName), false);
 			}
 		}
 
 		AActor* ChildActor = NULL;
-		if(!m2uHelper::GetActorByName(*ChildName, &ChildActor) || ChildActor == NULL)
+		if(!m2uHelper::GetActorByName(ChildName, &ChildActor) || ChildActor == NULL)
 		{
-			UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *ChildName);
+			UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), ChildName);
 			return TEXT("1");
 		}
 
@@ -629,12 +834,12 @@ Fm2uOpObjectParent( Fm2uOperationManager* Manager = NULL )
 		//const FScopedTransaction Transaction( NSLOCTEXT("Editor", "UndoAction_PerformAttachment", "Attach actors") );
 
 		// parent to world, aka "detach"
-		if( ParentName.Len() < 1) // no valid parent name
+		if( ParentName[0] == '\0' ) // no valid parent name
 		{
 			USceneComponent* ChildRoot = ChildActor->GetRootComponent();
 			if(ChildRoot->GetAttachParent() != NULL)
 			{
-				UE_LOG(LogM2U, Log, TEXT("Parenting %s the World."), *ChildName);
+				UE_LOG(LogM2U, Log, TEXT("Parenting %s the World."), ChildName);
 				AActor* OldParentActor = ChildRoot->GetAttachParent()->GetOwner();
 				OldParentActor->Modify();
 				ChildRoot->DetachFromParent(true);
@@ -646,9 +851,9 @@ Fm2uOpObjectParent( Fm2uOperationManager* Manager = NULL )
 		}
 
 		AActor* ParentActor = NULL;
-		if(!m2uHelper::GetActorByName(*ParentName, &ParentActor) || ParentActor == NULL)
+		if(!m2uHelper::GetActorByName(ParentName, &ParentActor) || ParentActor == NULL)
 		{
-			UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), *ParentName);
+			UE_LOG(LogM2U, Log, TEXT("Actor %s not found or invalid."), ParentName);
 			return TEXT("1");
 		}
 		if( ParentActor == ChildActor ) // can't parent actor to itself
@@ -656,7 +861,7 @@ Fm2uOpObjectParent( Fm2uOperationManager* Manager = NULL )
 			return TEXT("1");
 		}
 		// parent to other actor, aka "attach"
-		UE_LOG(LogM2U, Log, TEXT("Parenting %s to %s."), *ChildName, *ParentName);
+		UE_LOG(LogM2U, Log, TEXT("Parenting %s to %s."), ChildName, ParentName);
 		GEditor->ParentActors( ParentActor, ChildActor, NAME_None);
 
 		return TEXT("0");
@@ -5,68 +5,65 @@
 
 #include "ActorEditorUtils.h"
 #include "UnrealEd.h"
+#include "m2uInvalidation.h"
 
 class Fm2uOpSelection : public Fm2uOperation
 {
 public:
 
 Fm2uOpSelection( Fm2uOperationManager* Manager = NULL )
-		:Fm2uOperation( Manager ){}
+		:Fm2uOperation( Manager, {TEXT("SelectByNames"), TEXT("DeselectAll"), TEXT("DeselectByNames")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = false;
 
 		if( FParse::Command(&Str, TEXT("SelectByNames")))
 		{
-			FString ActorNamesList = FParse::Token(Str,0);
-			TArray<FString> ActorNames = m2uHelper::ParseList(ActorNamesList);			
-			for( FString ActorName : ActorNames )
+			Fm2uListParser ActorNames = m2uHelper::ParseList(Str);
+			TCHAR ActorName[NAME_SIZE];
+			while( ActorNames.Next(ActorName, ARRAY_COUNT(ActorName)) )
 			{
 				AActor* Actor;
-				if( m2uHelper::GetActorByName(*ActorName, &Actor) )
+				if( m2uHelper::GetActorByName(ActorName, &Actor) )
 				{
-					GEditor->SelectActor( Actor, true, true, true);// actor, select, notify, evenIfHidden
+					GEditor->SelectActor( Actor, true, false, true);// actor, select, notify, evenIfHidden
 				}			   
 			}
-			GEditor->RedrawLevelEditingViewports();
+			m2uInvalidation::Invalidate(Em2uInvalidation::Selection | Em2uInvalidation::Viewports);
 			DidExecute = true;
 		}
 
 		else if( FParse::Command(&Str, TEXT("DeselectAll")))
 		{
-			GEditor->SelectNone(true, true, false);
-			GEditor->RedrawLevelEditingViewports();
+			GEditor->SelectNone(false, true, false);
+			m2uInvalidation::Invalidate(Em2uInvalidation::Selection | Em2uInvalidation::Viewports);
 
 			DidExecute = true;
 		}
 
 		else if( FParse::Command(&Str, TEXT("DeselectByNames")))
 		{
-			TArray<AActor*> SelectedActors;
 			USelection* Selection = GEditor->GetSelectedActors();
-			Selection->GetSelectedObjects<AActor>(SelectedActors);
-			
-			FString ActorNamesList = FParse::Token(Str,0);
-			TArray<FString> ActorNames = m2uHelper::ParseList(ActorNamesList);			
-			for( FString ActorName : ActorNames )
+
+			// look every name up instead of comparing it with all selected
+			// actors, that is a lot of strings for a large selection
+			Fm2uListParser ActorNames = m2uHelper::ParseList(Str);
+			TCHAR ActorName[NAME_SIZE];
+			while( ActorNames.Next(ActorName, ARRAY_COUNT(ActorName)) )
 			{
-				for( int32 Idx = 0 ; Idx < SelectedActors.Num() ; ++Idx )
+				AActor* Actor;
+				if( m2uHelper::GetActorByName(ActorName, &Actor) && Actor->IsSelected() )
 				{
-					AActor* Actor = SelectedActors[ Idx ];
-					if(Actor->GetFName().ToString() == ActorName)
-					{
-						Selection->Modify();
-						//Selection->BeginBatchSelectOperation();
-						//Selection->Deselect(Actor);
-						//Selection->EndBatchSelectOperation();
-						GEditor->SelectActor( Actor, false, true, true ); // deselect
-						break;
-					}
-				}	
+					Selection->Modify();
+					//Selection->BeginBatchSelectOperation();
+					//Selection->Deselect(Actor);
+					//Selection->EndBatchSelectOperation();
+					GEditor->SelectActor( Actor, false, false, true ); // deselect
+				}
 			}
-			GEditor->RedrawLevelEditingViewports();
+			m2uInvalidation::Invalidate(Em2uInvalidation::Selection | Em2uInvalidation::Viewports);
 			DidExecute = true;
 		}
 
@@ -0,0 +1,39 @@
+#pragma once
+// Statistics Operations
+
+#include "m2uOperation.h"
+#include "m2uStats.h"
+
+class Fm2uOpStats : public Fm2uOperation
+{
+public:
+
+	Fm2uOpStats( Fm2uOperationManager* Manager = NULL )
+		:Fm2uOperation( Manager, {TEXT("GetStats"), TEXT("ResetStats")} ){}
+
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
+	{
+		const TCHAR* Str = Cmd;
+		bool DidExecute = true;
+
+		if( FParse::Command(&Str, TEXT("GetStats")))
+		{
+			// the execution times per command, see Fm2uCommandStats::ToString
+			Result = m2uStats::Get().ToString();
+		}
+
+		else if( FParse::Command(&Str, TEXT("ResetStats")))
+		{
+			m2uStats::Get().Reset();
+			Result = TEXT("Ok");
+		}
+
+		else
+		{
+			// cannot handle the passed command
+			DidExecute = false;
+		}
+
+		return DidExecute;
+	}
+};
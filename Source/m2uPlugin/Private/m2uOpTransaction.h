@@ -13,11 +13,11 @@ class Fm2uOpTransaction : public Fm2uOperation
 public:
 
 Fm2uOpTransaction( Fm2uOperationManager* Manager = NULL )
-	:Fm2uOperation( Manager ){}
+	:Fm2uOperation( Manager, {TEXT("Undo"), TEXT("Redo")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 
 		if( FParse::Command(&Str, TEXT("Undo")))
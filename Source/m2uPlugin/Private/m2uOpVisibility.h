@@ -6,17 +6,18 @@
 #include "ActorEditorUtils.h"
 #include "UnrealEd.h"
 #include "m2uHelper.h"
+#include "m2uInvalidation.h"
 
 class Fm2uOpVisibility : public Fm2uOperation
 {
 public:
 
 Fm2uOpVisibility( Fm2uOperationManager* Manager = NULL )
-		:Fm2uOperation( Manager ){}
+		:Fm2uOperation( Manager, {TEXT("HideSelected"), TEXT("UnhideSelected"), TEXT("IsolateSelected"), TEXT("UnhideAll"), TEXT("HideByNames")} ){}
 
-	bool Execute( FString Cmd, FString& Result ) override
+	bool Execute( const TCHAR* Cmd, FString& Result ) override
 	{
-		const TCHAR* Str = *Cmd;
+		const TCHAR* Str = Cmd;
 		bool DidExecute = true;
 
 		// also see the "edactHide..." functions
@@ -38,7 +39,7 @@ Fm2uOpVisibility( Fm2uOperationManager* Manager = NULL )
 					Actor->SetIsTemporarilyHiddenInEditor( true );
 				}
 			}
-			GEditor->RedrawLevelEditingViewports();
+			m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
 		}
 
 		else if( FParse::Command(&Str, TEXT("UnhideSelected")))
@@ -57,7 +58,7 @@ Fm2uOpVisibility( Fm2uOperationManager* Manager = NULL )
 					Actor->SetIsTemporarilyHiddenInEditor( false );
 				}
 			}
-			GEditor->RedrawLevelEditingViewports();
+			m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
 		}
 
 		else if( FParse::Command(&Str, TEXT("IsolateSelected")))
@@ -73,7 +74,7 @@ Fm2uOpVisibility( Fm2uOperationManager* Manager = NULL )
 					Actor->SetIsTemporarilyHiddenInEditor( true );
 				}
 			}
-			GEditor->RedrawLevelEditingViewports();
+			m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
 		}
 
 		else if( FParse::Command(&Str, TEXT("UnhideAll")))
@@ -88,21 +89,21 @@ Fm2uOpVisibility( Fm2uOperationManager* Manager = NULL )
 					Actor->SetIsTemporarilyHiddenInEditor( false );
 				}
 			}
-			GEditor->RedrawLevelEditingViewports();
+			m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
 		}
 
 		else if( FParse::Command(&Str, TEXT("HideByNames")))
 		{
-			FString Name;
-			while( FParse::Token(Str, Name, 0) )
+			TCHAR Name[NAME_SIZE];
+			while( FParse::Token(Str, Name, ARRAY_COUNT(Name), false) )
 			{
 				AActor* Actor = NULL;
-				if(m2uHelper::GetActorByName(*Name, &Actor) && !Actor->IsHiddenEd())
+				if(m2uHelper::GetActorByName(Name, &Actor) && !Actor->IsHiddenEd())
 				{
 					Actor->SetIsTemporarilyHiddenInEditor( true );
 				}
 			}
-			GEditor->RedrawLevelEditingViewports();
+			m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
 		}
 		
 		else
@@ -1,8 +1,9 @@
-
 #include "m2uPluginPrivatePCH.h"
 #include "m2uOperation.h"
+#include "m2uTrace.h"
 
-Fm2uOperation::Fm2uOperation( Fm2uOperationManager* Manager )
+Fm2uOperation::Fm2uOperation( Fm2uOperationManager* Manager, const TArray<FString>& InKeywords )
+	:Keywords(InKeywords)
 {
 	this->Manager = Manager;
 	if( Manager != NULL )
@@ -15,6 +16,25 @@ Fm2uOperation::~Fm2uOperation()
 {}
 
 
+namespace
+{
+	/**
+	 * The FName of the first word of Cmd, if it exists. A word that no FName
+	 * was ever created for can't be any keyword.
+	 */
+	FName FindFirstWord( const TCHAR* Cmd )
+	{
+		// a word ends where FParse::Command stops matching
+		const Tm2uTextView<TCHAR> FirstWord = m2uParse::FirstWord(Cmd);
+		if( FirstWord.IsEmpty() || FirstWord.Len >= NAME_SIZE )
+			return NAME_None;
+		TCHAR Word[NAME_SIZE];
+		FirstWord.CopyTo(Word, ARRAY_COUNT(Word));
+		return FName(Word, FNAME_Find);
+	}
+}
+
+
 Fm2uOperationManager::~Fm2uOperationManager()
 {
 	for( Fm2uOperation* Op : RegisteredOperations )
@@ -24,19 +44,173 @@ Fm2uOperationManager::~Fm2uOperationManager()
 void Fm2uOperationManager::Register( Fm2uOperation* Operation )
 {
 	RegisteredOperations.Insert(Operation,0);
+	if( Operation->GetKeywords().Num() == 0 )
+	{
+		UnindexedOperations.Insert(Operation,0);
+	}
+	for( const FString& Keyword : Operation->GetKeywords() )
+	{
+		OperationsByKeyword.Add(*Keyword, Operation);
+	}
+}
+
+FName Fm2uOperationManager::GetKeyword( const TCHAR* Cmd )
+{
+	return FindFirstWord(Cmd);
 }
 
-FString Fm2uOperationManager::Execute( FString Cmd )
+Fm2uOperation* Fm2uOperationManager::FindOperation( const TCHAR* Cmd ) const
 {
-	for( Fm2uOperation* Operation : RegisteredOperations )
+	Fm2uOperation* const* Operation = OperationsByKeyword.Find(Cmd);
+	return Operation != NULL ? *Operation : NULL;
+}
+
+FString Fm2uOperationManager::Execute( const TCHAR* Cmd )
+{
+	Fm2uTraceScope Trace(TEXT("Execute"));
+	if( m2uTrace::Get().IsEnabled() )
+	{
+		Trace.SetDetail(GetKeyword(Cmd));
+	}
+	// split once, every Operation asked reads the same tokens. The keyword
+	// is enough to find the Operation, the rest is only split if it is read.
+	Fm2uTokenTable Tokens;
+	Tokens.TokenizeFirst(Cmd, FCString::Strlen(Cmd), 1);
+	const Tm2uTextView<TCHAR> Keyword = Tokens.GetKeyword();
+	FString Result;
+	Fm2uOperation* const* Found = OperationsByKeyword.FindWord(Keyword);
+	Fm2uOperation* Indexed = Found != NULL ? *Found : NULL;
+	if( Indexed != NULL )
 	{
-		FString Result;
-		if( Operation -> Execute(Cmd, Result) )
+		if( Indexed -> NeedsAllTokens(Keyword) )
+		{
+			Tokens.TokenizeRest();
+		}
+		if( Indexed -> ExecuteTokens(Tokens, Result) )
 		{
 			return Result;
 		}
+		// it declined, maybe another one with the same keyword can do it
+		Tokens.TokenizeRest();
+		for( Fm2uOperation* Operation : RegisteredOperations )
+		{
+			if( Operation != Indexed && Operation -> ExecuteTokens(Tokens, Result) )
+			{
+				return Result;
+			}
+		}
+	}
+	else
+	{
+		Tokens.TokenizeRest();
+		for( Fm2uOperation* Operation : UnindexedOperations )
+		{
+			if( Operation -> ExecuteTokens(Tokens, Result) )
+			{
+				return Result;
+			}
+		}
 	}
 	// no Operation could handle that command
-	UE_LOG(LogM2U, Warning, TEXT("Command not found: %s"), *Cmd);
+	UE_LOG(LogM2U, Warning, TEXT("Command not found: %s"), Cmd);
+	return TEXT("Command Not Found");
+}
+
+FString Fm2uOperationManager::ExecuteBinary( const TCHAR* Cmd, const TArray<uint8>& Data )
+{
+	Fm2uTraceScope Trace(TEXT("ExecuteBinary"));
+	if( m2uTrace::Get().IsEnabled() )
+	{
+		Trace.SetDetail(GetKeyword(Cmd));
+	}
+	FString Result;
+	// only Operations that declare the keyword know what the data means
+	Fm2uOperation* Indexed = FindOperation(Cmd);
+	if( Indexed != NULL && Indexed -> ExecuteBinary(Cmd, Data.GetData(), Data.Num(), Result) )
+	{
+		return Result;
+	}
+	UE_LOG(LogM2U, Warning, TEXT("Binary command not found: %s"), Cmd);
 	return TEXT("Command Not Found");
 }
+
+Fm2uAsyncTask* Fm2uOperationManager::ExecuteAsync( const TCHAR* Cmd )
+{
+	// only one Operation can run a command asynchronously
+	Fm2uOperation* Indexed = FindOperation(Cmd);
+	if( Indexed != NULL )
+	{
+		return Indexed -> ExecuteAsync(Cmd);
+	}
+	for( Fm2uOperation* Operation : UnindexedOperations )
+	{
+		Fm2uAsyncTask* Task = Operation -> ExecuteAsync(Cmd);
+		if( Task != NULL )
+		{
+			return Task;
+		}
+	}
+	return NULL;
+}
+
+void Fm2uOperationManager::BenchmarkDispatch( int32 Iterations, FOutputDevice& Ar ) const
+{
+	TArray<FString> Commands;
+	for( const Fm2uOperation* Operation : RegisteredOperations )
+	{
+		for( const FString& Keyword : Operation->GetKeywords() )
+		{
+			Commands.Add(Keyword + TEXT(" Actor_1 T=(0 0 0)"));
+		}
+	}
+	Commands.Add(TEXT("m2uUnknownCommand Actor_1"));
+	Iterations = FMath::Max(1, Iterations);
+
+	// what every command took before the keyword table: every Operation
+	// compares its commands one after the other until one matches
+	int32 Found = 0;
+	double StartTime = FPlatformTime::Seconds();
+	for( int32 Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		for( const FString& Cmd : Commands )
+		{
+			for( const Fm2uOperation* Operation : RegisteredOperations )
+			{
+				bool bMatched = false;
+				for( const FString& Keyword : Operation->GetKeywords() )
+				{
+					const TCHAR* Str = *Cmd;
+					if( FParse::Command(&Str, *Keyword) )
+					{
+						bMatched = true;
+						break;
+					}
+				}
+				if( bMatched )
+				{
+					++Found;
+					break;
+				}
+			}
+		}
+	}
+	const double LinearTime = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	for( int32 Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		for( const FString& Cmd : Commands )
+		{
+			if( FindOperation(*Cmd) != NULL )
+			{
+				++Found;
+			}
+		}
+	}
+	const double IndexedTime = FPlatformTime::Seconds() - StartTime;
+
+	const double NumDispatches = (double)Iterations * Commands.Num();
+	Ar.Logf(TEXT("m2u dispatch of %i commands x %i iterations (%i found):"), Commands.Num(), Iterations, Found);
+	Ar.Logf(TEXT("  compare keywords: %8.1f ns per command"), LinearTime * 1e9 / NumDispatches);
+	Ar.Logf(TEXT("  keyword table:    %8.1f ns per command"), IndexedTime * 1e9 / NumDispatches);
+}
@@ -11,6 +11,11 @@
 
 #include "m2uHelper.h"
 #include "m2uBatchFileParse.h"
+#include "m2uSharedMemory.h"
+#include "m2uUnixSocket.h"
+#include "m2uInvalidation.h"
+#include "m2uStats.h"
+#include "m2uTrace.h"
 
 #include "m2uBuiltinOperations.h"
 
@@ -18,6 +23,13 @@
 
 DEFINE_LOG_CATEGORY( LogM2U )
 
+DEFINE_STAT( STAT_m2uExecuteCommands );
+DEFINE_STAT( STAT_m2uStepRunningTasks );
+DEFINE_STAT( STAT_m2uApplyTransformStream );
+DEFINE_STAT( STAT_m2uFlushInvalidation );
+DEFINE_STAT( STAT_m2uCommandsExecuted );
+DEFINE_STAT( STAT_m2uRunningTasks );
+
 
 IMPLEMENT_MODULE( Fm2uPlugin, m2uPlugin )
 
@@ -26,8 +38,19 @@ IMPLEMENT_MODULE( Fm2uPlugin, m2uPlugin )
 FString ExecuteCommand(const TCHAR* Str/*, Fm2uPlugin* Conn*/);
 
 Fm2uPlugin::Fm2uPlugin()
-	:Client(NULL),
-	 TcpListener(NULL)
+	:NetworkThread(NULL),
+	 TickBudgetMs(DEFAULT_M2U_TICK_BUDGET_MS),
+	 NextRunningTask(0),
+	 TcpListener(NULL),
+	 ListenPort(DEFAULT_M2U_PORT),
+	 bUseUnixSocket(false),
+	 UnixSocketListener(NULL),
+	 bUseSharedMemory(false),
+	 SharedMemoryListener(NULL),
+	 bSuspendRealtime(false),
+	 PacedReplay(NULL),
+	 TickObject(NULL),
+	 OperationManager(NULL)
 {
 }
 
@@ -40,6 +63,7 @@ void Fm2uPlugin::StartupModule()
 		return;
 	}
 
+	NetworkThread = new Fm2uNetworkThread();
 	ResetConnection( DEFAULT_M2U_PORT );
 
 	TickObject = new Fm2uTickObject(this);
@@ -54,16 +78,16 @@ void Fm2uPlugin::StartupModule()
 void Fm2uPlugin::ShutdownModule()
 {
 
-    // close all clients
-	if(Client != NULL)
-	{
-		Client->Close();
-		Client=NULL;
-	}
+	StopListeners();
+	CancelAllRunningTasks();
+	m2uInvalidation::Get().RestoreRealtime();
+	Capture.Stop();
+	delete PacedReplay;
+	PacedReplay = NULL;
 
-	TcpListener->Stop();
-	delete TcpListener;
-	TcpListener = NULL;
+    // close all clients
+	delete NetworkThread;
+	NetworkThread = NULL;
 
 	delete TickObject;
 	TickObject = NULL;
@@ -96,11 +120,210 @@ bool Fm2uPlugin::Exec( UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar )
 		}
 		return true;
 	}
+	else if( FParse::Command(&Cmd, TEXT("m2uTickBudget")) )
+	{
+		// milliseconds per tick to spend on executing received commands
+		FString BudgetString;
+		if( FParse::Token(Cmd, BudgetString, 0))
+		{
+			TickBudgetMs = FMath::Max(0.0f, FCString::Atof(*BudgetString));
+		}
+		Ar.Logf(TEXT("m2u tick budget is %.2f ms"), TickBudgetMs);
+		return true;
+	}
+	else if( FParse::Command(&Cmd, TEXT("m2uCompressionStats")) )
+	{
+		if( NetworkThread != NULL )
+		{
+			NetworkThread->GetCompressionStats().Report(Ar);
+		}
+		return true;
+	}
+	else if( FParse::Command(&Cmd, TEXT("m2uSharedMemory")) )
+	{
+		// also accept clients on the same machine through shared memory
+		FString EnableString;
+		if( FParse::Token(Cmd, EnableString, 0))
+		{
+			bUseSharedMemory = EnableString.ToBool();
+			ResetConnection(ListenPort);
+		}
+		Ar.Logf(TEXT("m2u shared memory transport is %s"), bUseSharedMemory ? TEXT("on") : TEXT("off"));
+		return true;
+	}
+	else if( FParse::Command(&Cmd, TEXT("m2uUnixSocket")) )
+	{
+		// listen on a unix domain socket instead of the TCP port
+		FString EnableString;
+		if( FParse::Token(Cmd, EnableString, 0))
+		{
+#if M2U_WITH_UNIX_SOCKETS
+			bUseUnixSocket = EnableString.ToBool();
+			ResetConnection(ListenPort);
+#else
+			Ar.Logf(TEXT("Unix sockets are not supported on this platform"));
+#endif
+		}
+		Ar.Logf(TEXT("m2u unix socket is %s"), bUseUnixSocket ? TEXT("on") : TEXT("off"));
+		return true;
+	}
+	else if( FParse::Command(&Cmd, TEXT("m2uSuspendRealtime")) )
+	{
+		// don't render realtime viewports while a batch takes several ticks
+		FString EnableString;
+		if( FParse::Token(Cmd, EnableString, 0))
+		{
+			bSuspendRealtime = EnableString.ToBool();
+			if( ! bSuspendRealtime )
+			{
+				m2uInvalidation::Get().RestoreRealtime();
+			}
+		}
+		Ar.Logf(TEXT("m2u realtime suspension during batches is %s"), bSuspendRealtime ? TEXT("on") : TEXT("off"));
+		return true;
+	}
+	else if( FParse::Command(&Cmd, TEXT("m2uBenchDispatch")) )
+	{
+		// compare the cost of finding the Operation for a command
+		int32 Iterations = 10000;
+		FString IterationsString;
+		if( FParse::Token(Cmd, IterationsString, 0))
+		{
+			Iterations = FCString::Atoi(*IterationsString);
+		}
+		if( OperationManager != NULL )
+		{
+			OperationManager->BenchmarkDispatch(Iterations, Ar);
+		}
+		return true;
+	}
 	else if( FParse::Command(&Cmd, TEXT("m2uDo")) )
 	{
 		// execute an Action without using tcp connection
 		//ExecuteCommand(Cmd);
-		OperationManager -> Execute(FString(Cmd));
+		const double StartTime = FPlatformTime::Seconds();
+		const FString Result = OperationManager -> Execute(Cmd);
+		m2uStats::Get().Add(Cmd, FPlatformTime::Seconds() - StartTime);
+		m2uInvalidation::Get().Flush();
+		Ar.Logf(TEXT("%s"), *Result);
+		return true;
+	}
+	else if( FParse::Command(&Cmd, TEXT("m2uTrace")) )
+	{
+		// record a timeline: m2uTrace start [MaxSpans] | stop | dump [File]
+		Fm2uTracer& Tracer = m2uTrace::Get();
+		FString Token;
+		if( FParse::Command(&Cmd, TEXT("start")) )
+		{
+			int32 Capacity = M2U_TRACE_DEFAULT_CAPACITY;
+			if( FParse::Token(Cmd, Token, 0) )
+			{
+				Capacity = FCString::Atoi(*Token);
+			}
+			Tracer.Start(Capacity);
+			Ar.Logf(TEXT("m2u trace started"));
+		}
+		else if( FParse::Command(&Cmd, TEXT("stop")) )
+		{
+			Tracer.Stop();
+		}
+		else if( FParse::Command(&Cmd, TEXT("dump")) )
+		{
+			FString Filename = FPaths::ProfilingDir() / FString::Printf(TEXT("m2u-%s.json"), *FDateTime::Now().ToString());
+			if( FParse::Token(Cmd, Token, 0) )
+			{
+				Filename = Token;
+			}
+			if( Tracer.Dump(Filename) )
+			{
+				Ar.Logf(TEXT("m2u trace written to %s"), *Filename);
+			}
+			else
+			{
+				Ar.Logf(TEXT("Could not write %s"), *Filename);
+			}
+		}
+		int32 NumRecorded;
+		int64 NumDropped;
+		Tracer.GetCounts(NumRecorded, NumDropped);
+		Ar.Logf(TEXT("m2u trace is %s, %i spans recorded, %lld dropped"), Tracer.IsEnabled() ? TEXT("recording") : TEXT("stopped"), NumRecorded, NumDropped);
+		return true;
+	}
+	else if( FParse::Command(&Cmd, TEXT("m2uCapture")) )
+	{
+		// record the received commands: m2uCapture start [File] | stop
+		if( FParse::Command(&Cmd, TEXT("start")) )
+		{
+			FString Filename = FPaths::ProfilingDir() / FString::Printf(TEXT("m2u-%s.m2ucap"), *FDateTime::Now().ToString());
+			FString Token;
+			if( FParse::Token(Cmd, Token, 0) )
+			{
+				Filename = Token;
+			}
+			if( Capture.Start(Filename) )
+			{
+				Ar.Logf(TEXT("m2u capturing to %s"), *Filename);
+			}
+			else
+			{
+				Ar.Logf(TEXT("Could not write %s"), *Filename);
+			}
+		}
+		else if( FParse::Command(&Cmd, TEXT("stop")) )
+		{
+			Ar.Logf(TEXT("m2u captured %i commands"), Capture.Num());
+			Capture.Stop();
+		}
+		return true;
+	}
+	else if( FParse::Command(&Cmd, TEXT("m2uReplay")) )
+	{
+		// execute a capture again: m2uReplay <File> [paced] | stop
+		if( FParse::Command(&Cmd, TEXT("stop")) )
+		{
+			delete PacedReplay;
+			PacedReplay = NULL;
+			return true;
+		}
+		FString Filename;
+		if( ! FParse::Token(Cmd, Filename, 0) )
+		{
+			Ar.Logf(TEXT("Usage: m2uReplay <File> [paced]"));
+			return true;
+		}
+		Fm2uReplay* Replay = new Fm2uReplay();
+		if( ! Replay->Load(Filename) )
+		{
+			Ar.Logf(TEXT("Could not read %s"), *Filename);
+			delete Replay;
+			return true;
+		}
+		if( FParse::Command(&Cmd, TEXT("paced")) )
+		{
+			// the commands are executed in the ticks as they come due
+			delete PacedReplay;
+			PacedReplay = Replay;
+			PacedReplay->Start();
+			Ar.Logf(TEXT("m2u replaying %i records"), PacedReplay->GetRecords().Num());
+		}
+		else
+		{
+			ReplayFast(*Replay, Ar);
+			delete Replay;
+		}
+		return true;
+	}
+	else if( FParse::Command(&Cmd, TEXT("m2uStats")) )
+	{
+		// execution times per command, "m2uStats reset" starts over
+		if( FParse::Command(&Cmd, TEXT("reset")) )
+		{
+			m2uStats::Get().Reset();
+		}
+		else
+		{
+			m2uStats::Get().Report(Ar);
+		}
 		return true;
 	}
 	return false;
@@ -108,29 +331,51 @@ bool Fm2uPlugin::Exec( UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar )
 
 void Fm2uPlugin::ResetConnection(uint16 Port)
 {
-	if(Client != NULL)
+	NetworkThread->CloseClients();
+	CommandQueue.Empty();
+	CancelAllRunningTasks();
+	StopListeners();
+
+	ListenPort = Port;
+	if( bUseUnixSocket )
+	{
+#if M2U_WITH_UNIX_SOCKETS
+		UnixSocketListener = new Fm2uUnixSocketListener(Port, NetworkThread);
+#endif
+	}
+	else
+	{
+		UE_LOG(LogM2U, Log, TEXT("Hosting on Port %i"), Port);
+		TcpListener = new FTcpListener( FIPv4Endpoint(DEFAULT_M2U_ADDRESS, Port) );
+		TcpListener->OnConnectionAccepted().BindRaw(this, &Fm2uPlugin::HandleConnectionAccepted);
+	}
+	if( bUseSharedMemory )
 	{
-		Client->Close();
-		Client=NULL;
+		SharedMemoryListener = new Fm2uSharedMemoryListener(Port, NetworkThread);
 	}
+}
+
+void Fm2uPlugin::StopListeners()
+{
 	if(TcpListener != NULL)
 	{
 		TcpListener->Stop();
 		delete TcpListener;
+		TcpListener = NULL;
 	}
-	UE_LOG(LogM2U, Log, TEXT("Hosting on Port %i"), Port);
-	TcpListener = new FTcpListener( FIPv4Endpoint(DEFAULT_M2U_ADDRESS, Port) );
-	TcpListener->OnConnectionAccepted().BindRaw(this, &Fm2uPlugin::HandleConnectionAccepted);
+#if M2U_WITH_UNIX_SOCKETS
+	delete UnixSocketListener;
+	UnixSocketListener = NULL;
+#endif
+	delete SharedMemoryListener;
+	SharedMemoryListener = NULL;
 }
 
 bool Fm2uPlugin::HandleConnectionAccepted( FSocket* ClientSocket, const FIPv4Endpoint& ClientEndpoint)
 {
-	if(Client==NULL)
+	// NOTE: this is called on the listener thread
+	if( NetworkThread->AddClient(ClientSocket) )
 	{
-		Client = ClientSocket;
-		int32 NewSize;
-		Client->SetReceiveBufferSize(4000000, NewSize);
-		UE_LOG(LogM2U, Log, TEXT("Connected on Port %i, Buffersize %i."), Client->GetPortNo(), NewSize);
 		return true;
 	}
 	UE_LOG(LogM2U, Log, TEXT("Connection declined"));
@@ -140,88 +385,269 @@ bool Fm2uPlugin::HandleConnectionAccepted( FSocket* ClientSocket, const FIPv4End
 
 void Fm2uPlugin::Tick( float DeltaTime )
 {
-	// valid and connected?
-	if( Client != NULL && Client -> GetConnectionState() == SCS_Connected)
+	Fm2uTraceScope Trace(TEXT("Tick"));
+	//UE_LOG(LogM2U, Log, TEXT("Tick time was %f"),DeltaTime);
+	// get all messages the network thread decoded, do stuff, and tell the caller
+	// what happened ;)
+	// Note: legacy clients send one command per message, they can't be split
+	// on newlines because batch commands like AddActorBatch contain those.
+	Fm2uCommand Command;
+	while( NetworkThread->DequeueCommand(Command) )
 	{
-		//UE_LOG(LogM2U, Log, TEXT("Tick time was %f"),DeltaTime);
-		// get the message, do stuff, and tell the caller what happened ;)
-		FString Message;	
-		if( GetMessage(Message) )
+		Capture.AddCommand(Command);
+		CommandQueue.Add(MoveTemp(Command));
+	}
+	QueueReplayedCommands();
+	// don't bother executing what nobody will receive an answer for
+	uint32 ClosedConnectionId;
+	while( NetworkThread->DequeueClosedConnection(ClosedConnectionId) )
+	{
+		CommandQueue.RemoveConnection(ClosedConnectionId);
+		CancelRunningTasks(ClosedConnectionId);
+	}
+	ExecuteQueuedCommands();
+	ApplyTransformStream();
+	FlushInvalidation();
+}
+
+
+void Fm2uPlugin::QueueReplayedCommands()
+{
+	if( PacedReplay == NULL )
+		return;
+	const Fm2uCaptureRecord* Record;
+	while( (Record = PacedReplay->NextDue()) != NULL )
+	{
+		CommandQueue.Add(Fm2uReplay::MakeCommand(*Record));
+	}
+	if( PacedReplay->IsDone() && CommandQueue.IsEmpty() && RunningTasks.Num() == 0 )
+	{
+		const TArray<Fm2uCaptureRecord>& Records = PacedReplay->GetRecords();
+		UE_LOG(LogM2U, Log, TEXT("Replayed %i records in %.3f s, the capture took %.3f s. See m2uStats for the times per command."),
+			Records.Num(), PacedReplay->GetElapsed(), Records.Num() > 0 ? Records.Last().Time : 0.0);
+		delete PacedReplay;
+		PacedReplay = NULL;
+	}
+}
+
+
+void Fm2uPlugin::ReplayFast( const Fm2uReplay& Replay, FOutputDevice& Ar )
+{
+	// everything in one go, async commands too, no tick budget
+	double RecordedSeconds = 0.0;
+	double ReplayedSeconds = 0.0;
+	double TransformSeconds = 0.0;
+	int32 NumCommands = 0;
+	int32 NumChanged = 0;
+	Fm2uTransformApplier Applier;
+	const TArray<Fm2uCaptureRecord>& Records = Replay.GetRecords();
+	for( int32 Idx = 0; Idx < Records.Num(); ++Idx )
+	{
+		const Fm2uCaptureRecord& Record = Records[Idx];
+		const double StartTime = FPlatformTime::Seconds();
+		if( Record.Kind == Em2uCaptureRecord::Transforms )
+		{
+			Applier.Add(Record.Transforms);
+			Applier.Apply();
+			TransformSeconds += FPlatformTime::Seconds() - StartTime;
+			continue;
+		}
+		const FString Result = (Record.Flags & M2U_FRAME_FLAG_BINARY)
+			? OperationManager->ExecuteBinary(*Record.Command, Record.Data)
+			: OperationManager->Execute(*Record.Command);
+		const double ExecutionSeconds = FPlatformTime::Seconds() - StartTime;
+		m2uStats::Get().Add(*Record.Command, ExecutionSeconds);
+		ReplayedSeconds += ExecutionSeconds;
+		++NumCommands;
+		const Fm2uCaptureRecord* Recorded = Replay.FindResult(Idx);
+		if( Recorded != NULL )
 		{
-			//FString Result = ExecuteCommand(*Message);
-			// TODO: add batch-parse-message and execute multiple, newline-divided
-			// operations in one go
-			FString Result = OperationManager->Execute(Message);
-			SendResponse(Result);
+			RecordedSeconds += Recorded->ExecutionSeconds;
+			if( Result != Recorded->Response )
+			{
+				++NumChanged;
+			}
 		}
 	}
+	// the actors that were moved last are done moving now
+	Applier.Apply();
+	m2uInvalidation::Get().Flush();
+	Ar.Logf(TEXT("m2u replayed %i commands: %.3f s executing, %.3f s when captured, %i different responses, %.3f s for %i transform frames"),
+		NumCommands, ReplayedSeconds, RecordedSeconds, NumChanged, TransformSeconds, Records.Num() - NumCommands);
+}
+
+
+void Fm2uPlugin::ApplyTransformStream()
+{
+	Fm2uTraceScope Trace(TEXT("ApplyTransforms"));
+	SCOPE_CYCLE_COUNTER(STAT_m2uApplyTransformStream);
+	// one redraw for all of them
+	if( TransformApplier.Apply() )
+	{
+		m2uInvalidation::Invalidate(Em2uInvalidation::Viewports);
+	}
+	// the commands sent after them may go on now
+	CommandQueue.TransformsApplied();
+}
+
+
+void Fm2uPlugin::FlushInvalidation()
+{
+	Fm2uTraceScope Trace(TEXT("FlushInvalidation"));
+	SCOPE_CYCLE_COUNTER(STAT_m2uFlushInvalidation);
+	Fm2uInvalidationScheduler& Invalidation = m2uInvalidation::Get();
+	// commands left over mean the batch continues in the next tick
+	if( CommandQueue.IsEmpty() )
+	{
+		Invalidation.RestoreRealtime();
+	}
+	else if( bSuspendRealtime )
+	{
+		Invalidation.SuspendRealtime();
+	}
+	Invalidation.Flush();
 }
 
 
-bool Fm2uPlugin::GetMessage(FString& Result)
+void Fm2uPlugin::ExecuteQueuedCommands()
 {
-	// get all data from client and create one long FString from it
-	// return the result when the client is out of pending data.
-	//FString Result;
-	uint32 DataSize = 0;
-	while(Client->HasPendingData(DataSize) && DataSize > 0 )
-	{
-		//UE_LOG(LogM2U, Log, TEXT("pending data size %i"), DataSize);
-        // create data array to read from client
-		//FArrayReaderPtr Data = MakeShareable(new FArrayReader(true));
-		FArrayReader Data;
-		Data.SetNumUninitialized(DataSize);
-
-		int32 BytesRead = 0;
-        // read pending data into the Data array reader
-		if( Client->Recv( Data.GetData(), Data.Num(), BytesRead) )
+	// execute as many commands as fit into the budget, at least one per tick,
+	// the rest will be executed in the next tick. The clients take turns.
+	const double StartTime = FPlatformTime::Seconds();
+	const double Budget = TickBudgetMs / 1000.0;
+	Fm2uCommand Command;
+	while( CommandQueue.Next(Command) )
+	{
+		if( Command.Flags & M2U_FRAME_FLAG_TRANSFORMS )
+		{
+			// applied at the end of the tick, together with all others
+			TransformApplier.Add(Command.Transforms);
+			continue;
+		}
+		SCOPE_CYCLE_COUNTER(STAT_m2uExecuteCommands);
+		Fm2uTraceScope Trace(TEXT("Command"), Command.RequestId);
+		INC_DWORD_STAT(STAT_m2uCommandsExecuted);
+		const FName Keyword = Fm2uOperationManager::GetKeyword(*Command.Command);
+		FScopeCycleCounter KeywordCycles(m2uStats::GetStatId(Keyword));
+		const double CommandStartTime = FPlatformTime::Seconds();
+		// long-running commands only get started here and are answered later
+		Fm2uAsyncTask* Task = NULL;
+		if( (Command.Flags & M2U_FRAME_FLAG_ASYNC) && !(Command.Flags & M2U_FRAME_FLAG_BINARY) )
+		{
+			Task = OperationManager->ExecuteAsync(*Command.Command);
+		}
+		if( Task != NULL )
 		{
-			//UE_LOG(LogM2U, Log, TEXT("DataNum %i, BytesRead: %i"), Data.Num(), BytesRead);
+			// their stats are added when they are done
+			Fm2uRunningTask Running(Task, Command.RequestId, Command.ConnectionId);
+			Running.Keyword = Keyword;
+			Running.ExecutionSeconds = FPlatformTime::Seconds() - CommandStartTime;
+			RunningTasks.Add(Running);
+			SendResponse(TEXT("Accepted"), Command.RequestId, Command.ConnectionId, M2U_FRAME_FLAG_ASYNC);
+		}
+		else
+		{
+			FString Result = (Command.Flags & M2U_FRAME_FLAG_BINARY)
+				? OperationManager->ExecuteBinary(*Command.Command, Command.Data)
+				: OperationManager->Execute(*Command.Command);
+			const double ExecutionSeconds = FPlatformTime::Seconds() - CommandStartTime;
+			m2uStats::Get().Add(Keyword, ExecutionSeconds);
+			Capture.AddResult(Command.ConnectionId, Command.RequestId, ExecutionSeconds, Result);
+			for( uint32 SupersededRequestId : Command.SupersededRequestIds )
+			{
+				// they were never executed on their own
+				Capture.AddResult(Command.ConnectionId, SupersededRequestId, 0.0, Result);
+				SendResponse(Result, SupersededRequestId, Command.ConnectionId);
+			}
+			SendResponse(Result, Command.RequestId, Command.ConnectionId);
+		}
 
-			// the data we receive is supposed to be ansi, but we will work with TCHAR, so we have to convert
-			int32 DestLen = TStringConvert<ANSICHAR,TCHAR>::ConvertedLength((char*)(Data.GetData()),Data.Num());
-			//UE_LOG(LogM2U, Log, TEXT("DestLen will be %i"), DestLen);
-			TCHAR* Dest = new TCHAR[DestLen+1];
-			TStringConvert<ANSICHAR,TCHAR>::Convert(Dest, DestLen, (char*)(Data.GetData()), Data.Num());
-			Dest[DestLen]='\0';
+		if( FPlatformTime::Seconds() - StartTime >= Budget )
+			break;
+	}
+	StepRunningTasks(StartTime + Budget);
+}
 
-			//FString Text(Dest); // FString from tchar array
-			//UE_LOG(LogM2U, Log, TEXT("server received %s"), *Text);
-			//UE_LOG(LogM2U, Log, TEXT("Server received: %s"), Dest);
 
-			//FString Result = ExecuteCommand(Dest, this);
-			//SendResponse(Result);
+void Fm2uPlugin::StepRunningTasks( double EndTime )
+{
+	// what is left of the budget goes to the long-running commands, one step
+	// each in turn. At least one step is done every tick, so a constant stream
+	// of short commands can't stall them.
+	SCOPE_CYCLE_COUNTER(STAT_m2uStepRunningTasks);
+	bool bStepped = false;
+	while( RunningTasks.Num() > 0 )
+	{
+		if( bStepped && FPlatformTime::Seconds() >= EndTime )
+			break;
+		if( NextRunningTask >= RunningTasks.Num() )
+		{
+			NextRunningTask = 0;
+		}
 
-			// add all the message parts to the Result
-			Result += Dest;
+		Fm2uRunningTask& Running = RunningTasks[NextRunningTask];
+		FString Result;
+		bStepped = true;
+		Fm2uTraceScope Trace(TEXT("Step"), Running.RequestId, Running.Keyword);
+		FScopeCycleCounter KeywordCycles(m2uStats::GetStatId(Running.Keyword));
+		const double StepStartTime = FPlatformTime::Seconds();
+		const bool bDone = Running.Task->Step(Result);
+		// the time it took on the game thread, not how long it was running
+		Running.ExecutionSeconds += FPlatformTime::Seconds() - StepStartTime;
+		if( bDone )
+		{
+			m2uStats::Get().Add(Running.Keyword, Running.ExecutionSeconds);
+			Capture.AddResult(Running.ConnectionId, Running.RequestId, Running.ExecutionSeconds, Result);
+			SendResponse(Result, Running.RequestId, Running.ConnectionId);
+			delete Running.Task;
+			RunningTasks.RemoveAt(NextRunningTask);
+			continue;
+		}
 
-			delete Dest;
+		// only report when there is something new to tell
+		const float Progress = Running.Task->GetProgress();
+		if( Progress != Running.ReportedProgress )
+		{
+			Running.ReportedProgress = Progress;
+			SendResponse(FString::Printf(TEXT("Progress %.3f"), Progress), Running.RequestId, Running.ConnectionId, M2U_FRAME_FLAG_ASYNC);
 		}
-	}// while
-	if(! Result.IsEmpty() )
-		return true;
-	else
-		return false;
+		++NextRunningTask;
+	}
+	SET_DWORD_STAT(STAT_m2uRunningTasks, RunningTasks.Num());
 }
 
-void Fm2uPlugin::SendResponse(const FString& Message)
+
+void Fm2uPlugin::CancelRunningTasks( uint32 ConnectionId )
 {
-	if( Client != NULL && Client -> GetConnectionState() == SCS_Connected)
-	{
-		//const uint8* Data = *Message;
-		//const int32 Count = Message.Len();
-		int32 DestLen = TStringConvert<TCHAR,ANSICHAR>::ConvertedLength(*Message, Message.Len());
-		//UE_LOG(LogM2U, Log, TEXT("DestLen will be %i"), DestLen);
-		uint8* Dest = new uint8[DestLen+1];
-		TStringConvert<TCHAR,ANSICHAR>::Convert((ANSICHAR*)Dest, DestLen, *Message, Message.Len());
-		Dest[DestLen]='\0';
-
-		int32 BytesSent = 0;
-		if(	! Client->Send( Dest, DestLen, BytesSent) )
+	for( int32 Idx = RunningTasks.Num() - 1; Idx >= 0; --Idx )
+	{
+		if( RunningTasks[Idx].ConnectionId == ConnectionId )
 		{
-			UE_LOG(LogM2U, Error, TEXT("TCP Server sending answer failed."));
+			UE_LOG(LogM2U, Log, TEXT("Cancelled request %u of closed connection %u."), RunningTasks[Idx].RequestId, ConnectionId);
+			delete RunningTasks[Idx].Task;
+			RunningTasks.RemoveAt(Idx);
 		}
 	}
+	NextRunningTask = 0;
+}
+
+
+void Fm2uPlugin::CancelAllRunningTasks()
+{
+	for( Fm2uRunningTask& Running : RunningTasks )
+	{
+		delete Running.Task;
+	}
+	RunningTasks.Empty();
+	NextRunningTask = 0;
+}
+
+
+void Fm2uPlugin::SendResponse(const FString& Message, uint32 RequestId, uint32 ConnectionId, uint32 Flags)
+{
+	Fm2uTraceScope Trace(TEXT("SendResponse"), RequestId);
+	// encoding and sending happens on the network thread
+	NetworkThread->QueueResponse(Fm2uResponse(Message, RequestId, ConnectionId, Flags));
 }
 
 //void HandleReceivedData(FArrayReader& Data)
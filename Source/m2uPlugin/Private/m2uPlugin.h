@@ -3,12 +3,44 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogM2U, Log, All);
 
+#include "m2uNetworkThread.h"
+#include "m2uCommandScheduler.h"
+#include "m2uCapture.h"
+
 class Fm2uTickObject;
+class Fm2uAsyncTask;
+class Fm2uSharedMemoryListener;
+class Fm2uUnixSocketListener;
 
 // IP-Address of 0.0.0.0 listens on all local interfaces (all addresses)
 //#define DEFAULT_M2U_ENDPOINT FIPv4Endpoint(FIPv4Address(0,0,0,0), 3939)
 #define DEFAULT_M2U_ADDRESS FIPv4Address(0,0,0,0)
 #define DEFAULT_M2U_PORT 3939
+// milliseconds per editor tick we may spend on executing queued commands
+#define DEFAULT_M2U_TICK_BUDGET_MS 10.0f
+
+/**
+ * A long-running command that was accepted and is advanced a step at a time,
+ * and where to report its progress and result to.
+ */
+struct Fm2uRunningTask
+{
+	Fm2uAsyncTask* Task;
+	uint32 RequestId;
+	uint32 ConnectionId;
+	float ReportedProgress;
+	// for the stats, what it took on the game thread so far
+	FName Keyword;
+	double ExecutionSeconds;
+
+	Fm2uRunningTask( Fm2uAsyncTask* InTask, uint32 InRequestId, uint32 InConnectionId )
+		:Task(InTask),
+		 RequestId(InRequestId),
+		 ConnectionId(InConnectionId),
+		 ReportedProgress(0.0f),
+		 ExecutionSeconds(0.0)
+	{}
+};
 
 class Fm2uPlugin : public Im2uPlugin, private FSelfRegisteringExec
 {
@@ -31,16 +63,66 @@ public:
 	void Tick( float DeltaTime );
 
 	/* TCP messaging functions */
-	bool GetMessage(FString& Result);
-	void SendResponse( const FString& Message);
+	void SendResponse( const FString& Message, uint32 RequestId, uint32 ConnectionId, uint32 Flags = 0);
 	void ResetConnection(uint16 Port);
+	void StopListeners();
+
+	/* move the actors of all transform stream frames of this tick at once */
+	void ApplyTransformStream();
+
+	/* tell the editor once about everything the commands of this tick changed */
+	void FlushInvalidation();
+
+	/* execute queued commands until the tick budget is used up */
+	void ExecuteQueuedCommands();
+
+	/* advance the long-running commands until EndTime, by at least one step */
+	void StepRunningTasks( double EndTime );
+
+	/* abort the long-running commands of a connection, or all of them */
+	void CancelRunningTasks( uint32 ConnectionId );
+	void CancelAllRunningTasks();
+
+	/* the operations the commands go to, NULL outside of the editor */
+	class Fm2uOperationManager* GetOperationManager() const
+	{
+		return OperationManager;
+	}
+
+	/* execute all commands of a capture right away and report the time */
+	void ReplayFast( const Fm2uReplay& Replay, FOutputDevice& Ar );
+
+	/* feed the due commands and transforms of the paced replay to the command queue */
+	void QueueReplayedCommands();
 
 	/* FExec implementation */
 	virtual bool Exec( UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar );
 
 protected:
-	FSocket* Client;
+	Fm2uNetworkThread* NetworkThread;
+	// commands received but not executed yet, carried over between ticks
+	Fm2uCommandScheduler CommandQueue;
+	// records of the binary transform stream, applied once per tick
+	Fm2uTransformApplier TransformApplier;
+	float TickBudgetMs;
+	// accepted long-running commands, they take turns like the clients do
+	TArray<Fm2uRunningTask> RunningTasks;
+	int32 NextRunningTask;
 	class FTcpListener* TcpListener;
+	// the port all listeners use
+	uint16 ListenPort;
+	// listen on a local unix domain socket instead of the TCP port
+	bool bUseUnixSocket;
+	Fm2uUnixSocketListener* UnixSocketListener;
+	// same-machine clients can connect through shared memory too, if enabled
+	bool bUseSharedMemory;
+	Fm2uSharedMemoryListener* SharedMemoryListener;
+	// switch realtime viewports off while a batch of commands takes several ticks
+	bool bSuspendRealtime;
+	// received commands and their results are written to this while capturing
+	Fm2uCaptureWriter Capture;
+	// the capture being replayed at its original pacing, if any
+	Fm2uReplay* PacedReplay;
 	Fm2uTickObject* TickObject;
 	class Fm2uOperationManager* OperationManager;
 
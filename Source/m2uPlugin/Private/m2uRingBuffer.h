@@ -0,0 +1,148 @@
+#pragma once
+// A growable byte ring buffer for socket data
+
+
+/**
+ * Bytes are written at the tail and consumed from the head without ever moving
+ * the data around. The storage only grows (doubling, power-of-two capacity)
+ * when more bytes have to be held than fit, so in steady state receiving data
+ * does not allocate.
+ */
+class Fm2uRingBuffer
+{
+public:
+
+	explicit Fm2uRingBuffer( int32 InitialCapacity = 64*1024 )
+		:Head(0),
+		 Used(0)
+	{
+		int32 Capacity = 1;
+		while( Capacity < InitialCapacity )
+			Capacity <<= 1;
+		Data.SetNumUninitialized( Capacity );
+	}
+
+	/** The number of readable bytes. */
+	int32 Num() const
+	{
+		return Used;
+	}
+
+	int32 Capacity() const
+	{
+		return Data.Num();
+	}
+
+	/** forget all content, but keep the storage */
+	void Reset()
+	{
+		Head = 0;
+		Used = 0;
+	}
+
+	/**
+	   Make sure there is room for at least MinFree more bytes and return the
+	   contiguous writable region at the tail. The region may be smaller than
+	   MinFree when it wraps around the end of the storage, write in two steps
+	   then. Call CommitWrite with the number of bytes actually written.
+	 */
+	uint8* GetWriteRegion( int32 MinFree, int32& OutSize )
+	{
+		if( Capacity() - Used < MinFree )
+		{
+			Grow( Used + MinFree );
+		}
+		const int32 Tail = (Head + Used) & Mask();
+		const int32 Free = Capacity() - Used;
+		OutSize = FMath::Min( Free, Capacity() - Tail );
+		return Data.GetData() + Tail;
+	}
+
+	void CommitWrite( int32 Count )
+	{
+		check( Count >= 0 && Used + Count <= Capacity() );
+		Used += Count;
+	}
+
+	/** append Count bytes, growing the storage if needed */
+	void Write( const uint8* Src, int32 Count )
+	{
+		while( Count > 0 )
+		{
+			int32 RegionSize = 0;
+			uint8* Dest = GetWriteRegion( Count, RegionSize );
+			const int32 Chunk = FMath::Min( Count, RegionSize );
+			FMemory::Memcpy( Dest, Src, Chunk );
+			CommitWrite( Chunk );
+			Src += Chunk;
+			Count -= Chunk;
+		}
+	}
+
+	/** copy Count bytes starting at Offset from the head to Dest without consuming */
+	void Peek( int32 Offset, uint8* Dest, int32 Count ) const
+	{
+		const uint8* First;
+		const uint8* Second;
+		int32 FirstNum, SecondNum;
+		GetReadSpans( Offset, Count, First, FirstNum, Second, SecondNum );
+		FMemory::Memcpy( Dest, First, FirstNum );
+		if( SecondNum > 0 )
+		{
+			FMemory::Memcpy( Dest + FirstNum, Second, SecondNum );
+		}
+	}
+
+	/**
+	   Get the Count bytes starting at Offset from the head as (at most) two
+	   contiguous spans, the second one is empty unless the range wraps around.
+	 */
+	void GetReadSpans( int32 Offset, int32 Count, const uint8*& OutFirst, int32& OutFirstNum, const uint8*& OutSecond, int32& OutSecondNum ) const
+	{
+		check( Offset >= 0 && Count >= 0 && Offset + Count <= Used );
+		const int32 Start = (Head + Offset) & Mask();
+		OutFirst = Data.GetData() + Start;
+		OutFirstNum = FMath::Min( Count, Capacity() - Start );
+		OutSecond = Data.GetData();
+		OutSecondNum = Count - OutFirstNum;
+	}
+
+	/** drop Count bytes from the head */
+	void Consume( int32 Count )
+	{
+		check( Count >= 0 && Count <= Used );
+		Head = (Head + Count) & Mask();
+		Used -= Count;
+		if( Used == 0 )
+		{
+			Head = 0; // keep following writes contiguous as long as possible
+		}
+	}
+
+private:
+
+	int32 Mask() const
+	{
+		return Capacity() - 1;
+	}
+
+	void Grow( int32 MinCapacity )
+	{
+		int32 NewCapacity = Capacity();
+		while( NewCapacity < MinCapacity )
+			NewCapacity <<= 1;
+
+		TArray<uint8> NewData;
+		NewData.SetNumUninitialized( NewCapacity );
+		if( Used > 0 )
+		{
+			Peek( 0, NewData.GetData(), Used );
+		}
+		Data = MoveTemp( NewData );
+		Head = 0;
+	}
+
+	TArray<uint8> Data;
+	int32 Head;
+	int32 Used;
+};
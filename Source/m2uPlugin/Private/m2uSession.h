@@ -0,0 +1,147 @@
+#pragma once
+// Resumable sessions for framed connections
+
+#include "m2uRingBuffer.h"
+
+// the most bytes of unacknowledged responses a session keeps for replaying
+#define M2U_SESSION_REPLAY_SIZE (16*1024*1024)
+// how long a session waits for its client to come back, in seconds
+#define M2U_SESSION_TIMEOUT 120.0
+
+/**
+   A framed client can ask for a session with the "Session" control command.
+   From then on, every response frame sent to it is also kept in the session's
+   replay buffer, until the client acknowledges it with "Ack <RequestId>".
+
+   When the connection drops, the session keeps the connection alive for
+   M2U_SESSION_TIMEOUT seconds without a socket: its commands are still
+   executed and their responses collected. A client that reconnects sends
+   "Resume <Token> <LastAckedRequestId>" as its first frame and continues the
+   old connection, getting all responses after the acknowledged one sent again.
+
+   The buffer is bounded, when the client doesn't acknowledge for too long the
+   oldest responses are dropped and a resume can't be complete anymore.
+ */
+class Fm2uSession
+{
+public:
+
+	explicit Fm2uSession( const FString& InToken )
+		:Token(InToken),
+		 DetachedTime(0.0),
+		 FirstEntry(0),
+		 bLost(false)
+	{}
+
+	const FString Token;
+	// when the connection lost its client, to let the session expire
+	double DetachedTime;
+
+	/** keep a copy of a response frame that is being sent */
+	void Record( uint32 RequestId, const uint8* Header, int32 HeaderSize, const uint8* Payload, int32 PayloadLength )
+	{
+		Replay.Write(Header, HeaderSize);
+		Replay.Write(Payload, PayloadLength);
+		Entries.Add(FEntry(RequestId, HeaderSize + PayloadLength));
+		while( Replay.Num() > M2U_SESSION_REPLAY_SIZE && Entries.Num() - FirstEntry > 1 )
+		{
+			DropFirst();
+			bLost = true;
+		}
+	}
+
+	/**
+	 * The client received the response to RequestId, forget it and everything
+	 * sent before. A request with several response frames (async operations)
+	 * is acknowledged one frame at a time, the oldest first.
+	 */
+	void Acknowledge( uint32 RequestId )
+	{
+		const int32 Index = FindFirst(RequestId);
+		if( Index == INDEX_NONE )
+			return;
+		while( FirstEntry <= Index )
+		{
+			DropFirst();
+		}
+		// whatever was lost came before this
+		bLost = false;
+	}
+
+	/**
+	 * false if frames sent after the one acknowledged by LastRequestId had to
+	 * be dropped, a resume can't be complete then
+	 */
+	bool CanReplayAfter( uint32 LastRequestId ) const
+	{
+		return FindFirst(LastRequestId) != INDEX_NONE || ! bLost;
+	}
+
+	/**
+	 * Append all frames sent after the one acknowledged by LastRequestId to
+	 * Out, or all frames if it isn't buffered anymore.
+	 */
+	void ReplayAfter( uint32 LastRequestId, Fm2uRingBuffer& Out ) const
+	{
+		int32 Offset = 0;
+		const int32 Index = FindFirst(LastRequestId);
+		if( Index != INDEX_NONE )
+		{
+			for( int32 Idx = FirstEntry; Idx <= Index; ++Idx )
+				Offset += Entries[Idx].Size;
+		}
+
+		const uint8* First;
+		const uint8* Second;
+		int32 FirstNum, SecondNum;
+		Replay.GetReadSpans(Offset, Replay.Num() - Offset, First, FirstNum, Second, SecondNum);
+		Out.Write(First, FirstNum);
+		Out.Write(Second, SecondNum);
+	}
+
+private:
+
+	struct FEntry
+	{
+		uint32 RequestId;
+		int32 Size;
+
+		FEntry( uint32 InRequestId, int32 InSize )
+			:RequestId(InRequestId),
+			 Size(InSize)
+		{}
+	};
+
+	int32 FindFirst( uint32 RequestId ) const
+	{
+		for( int32 Idx = FirstEntry; Idx < Entries.Num(); ++Idx )
+		{
+			if( Entries[Idx].RequestId == RequestId )
+				return Idx;
+		}
+		return INDEX_NONE;
+	}
+
+	void DropFirst()
+	{
+		Replay.Consume(Entries[FirstEntry].Size);
+		++FirstEntry;
+		// compact once the dropped entries are the larger part
+		if( FirstEntry == Entries.Num() )
+		{
+			Entries.Reset();
+			FirstEntry = 0;
+		}
+		else if( FirstEntry > 64 && FirstEntry * 2 > Entries.Num() )
+		{
+			Entries.RemoveAt(0, FirstEntry, false);
+			FirstEntry = 0;
+		}
+	}
+
+	Fm2uRingBuffer Replay;
+	TArray<FEntry> Entries;
+	int32 FirstEntry;
+	// frames were dropped before the client acknowledged them
+	bool bLost;
+};
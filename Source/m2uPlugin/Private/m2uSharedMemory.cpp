@@ -0,0 +1,228 @@
+#include "m2uPluginPrivatePCH.h"
+#include "m2uSharedMemory.h"
+
+namespace
+{
+	const uint32 SharedMemoryAccess = FPlatformMemory::ESharedMemoryAccess::Read | FPlatformMemory::ESharedMemoryAccess::Write;
+
+	FString GetSignalName( uint16 Port, const TCHAR* Side )
+	{
+		return FString::Printf(TEXT("m2u_%i_%s"), Port, Side);
+	}
+}
+
+
+Fm2uSharedMemoryTransport* Fm2uSharedMemoryTransport::Open( uint16 Port )
+{
+	FPlatformMemory::FSharedMemoryRegion* Region = FPlatformMemory::MapNamedSharedMemoryRegion(
+		m2uSharedMemory::GetRegionName(Port), false, SharedMemoryAccess, m2uSharedMemory::GetRegionSize());
+	if( Region == NULL )
+		return NULL;
+	FSemaphore* EditorSignal = FPlatformProcess::NewInterprocessSynchObject(GetSignalName(Port, TEXT("editor")), false);
+	FSemaphore* ClientSignal = FPlatformProcess::NewInterprocessSynchObject(GetSignalName(Port, TEXT("client")), false);
+	return new Fm2uSharedMemoryTransport(Port, Region, EditorSignal, ClientSignal);
+}
+
+Fm2uSharedMemoryTransport::Fm2uSharedMemoryTransport( uint16 InPort, FPlatformMemory::FSharedMemoryRegion* InRegion, FSemaphore* InEditorSignal, FSemaphore* InClientSignal )
+	:Port(InPort),
+	 Region(InRegion),
+	 EditorSignal(InEditorSignal),
+	 ClientSignal(InClientSignal),
+	 bCorrupt(false)
+{
+	uint8* Base = (uint8*)Region->GetAddress();
+	Header = (Fm2uSharedMemoryHeader*)Base;
+	ToEditorData = Base + M2U_SHM_HEADER_SIZE;
+	ToClientData = ToEditorData + M2U_SHM_RING_SIZE;
+}
+
+Fm2uSharedMemoryTransport::~Fm2uSharedMemoryTransport()
+{
+	// let the client know and make room for the next one
+	FPlatformAtomics::InterlockedExchange(&Header->State, (int32)Em2uSharedMemoryState::Free);
+	if( ClientSignal != NULL )
+	{
+		ClientSignal->Unlock();
+		FPlatformProcess::DeleteInterprocessSynchObject(ClientSignal);
+	}
+	if( EditorSignal != NULL )
+	{
+		FPlatformProcess::DeleteInterprocessSynchObject(EditorSignal);
+	}
+	FPlatformMemory::UnmapNamedSharedMemoryRegion(Region);
+}
+
+bool Fm2uSharedMemoryTransport::IsConnected()
+{
+	return ! bCorrupt && Header->State == Em2uSharedMemoryState::Connected;
+}
+
+int32 Fm2uSharedMemoryTransport::GetPendingData()
+{
+	const int32 Num = m2uSharedMemory::Readable(Header->ToEditor);
+	if( Num < 0 )
+	{
+		SetCorrupt(TEXT("receive"));
+		return 0;
+	}
+	return Num;
+}
+
+bool Fm2uSharedMemoryTransport::Recv( uint8* Dest, int32 MaxBytes, int32& BytesRead )
+{
+	BytesRead = m2uSharedMemory::Read(Header->ToEditor, ToEditorData, Dest, MaxBytes);
+	if( BytesRead < 0 )
+	{
+		BytesRead = 0;
+		SetCorrupt(TEXT("receive"));
+		return false;
+	}
+	return true;
+}
+
+bool Fm2uSharedMemoryTransport::Send( const uint8* Data, int32 Count, int32& BytesSent )
+{
+	BytesSent = m2uSharedMemory::Write(Header->ToClient, ToClientData, Data, Count);
+	if( BytesSent < 0 )
+	{
+		BytesSent = 0;
+		SetCorrupt(TEXT("send"));
+		return false;
+	}
+	if( BytesSent > 0 && Header->ToClient.ReaderWaiting && ClientSignal != NULL )
+	{
+		ClientSignal->Unlock();
+	}
+	return true;
+}
+
+void Fm2uSharedMemoryTransport::WaitForData( double Seconds )
+{
+	// announce that we are going to sleep before the last look at the ring, so
+	// a write that comes in between is sure to signal us
+	Header->ToEditor.ReaderWaiting = 1;
+	FPlatformMisc::MemoryBarrier();
+	if( m2uSharedMemory::Readable(Header->ToEditor) == 0 && IsConnected() )
+	{
+		if( EditorSignal != NULL )
+		{
+			EditorSignal->TryLock((uint64)(Seconds * 1000000000.0));
+		}
+		else
+		{
+			FPlatformProcess::Sleep(Seconds);
+		}
+	}
+	Header->ToEditor.ReaderWaiting = 0;
+}
+
+void Fm2uSharedMemoryTransport::SetCorrupt( const TCHAR* Ring )
+{
+	if( ! bCorrupt )
+	{
+		UE_LOG(LogM2U, Error, TEXT("The %s ring of %s is corrupt, closing the connection."), Ring, *Describe());
+		bCorrupt = true;
+	}
+}
+
+FString Fm2uSharedMemoryTransport::Describe() const
+{
+	return FString::Printf(TEXT("Shared Memory %s"), *m2uSharedMemory::GetRegionName(Port));
+}
+
+
+Fm2uSharedMemoryListener::Fm2uSharedMemoryListener( uint16 InPort, Fm2uNetworkThread* InNetworkThread )
+	:Port(InPort),
+	 NetworkThread(InNetworkThread),
+	 Region(NULL),
+	 Header(NULL),
+	 EditorSignal(NULL),
+	 ClientSignal(NULL),
+	 Thread(NULL)
+{
+	Region = FPlatformMemory::MapNamedSharedMemoryRegion(
+		m2uSharedMemory::GetRegionName(Port), true, SharedMemoryAccess, m2uSharedMemory::GetRegionSize());
+	if( Region == NULL )
+	{
+		UE_LOG(LogM2U, Error, TEXT("Could not create shared memory %s."), *m2uSharedMemory::GetRegionName(Port));
+		return;
+	}
+	EditorSignal = FPlatformProcess::NewInterprocessSynchObject(GetSignalName(Port, TEXT("editor")), true);
+	ClientSignal = FPlatformProcess::NewInterprocessSynchObject(GetSignalName(Port, TEXT("client")), true);
+
+	Header = (Fm2uSharedMemoryHeader*)Region->GetAddress();
+	FMemory::Memzero(Header, M2U_SHM_HEADER_SIZE);
+	Header->Magic = M2U_SHM_MAGIC;
+	Header->Version = M2U_SHM_VERSION;
+	Header->RingSize = M2U_SHM_RING_SIZE;
+	FPlatformMisc::MemoryBarrier();
+
+	UE_LOG(LogM2U, Log, TEXT("Listening on shared memory %s"), *m2uSharedMemory::GetRegionName(Port));
+	Thread = FRunnableThread::Create(this, TEXT("m2uSharedMemoryListener"), 0, TPri_BelowNormal);
+}
+
+Fm2uSharedMemoryListener::~Fm2uSharedMemoryListener()
+{
+	if( Thread != NULL )
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = NULL;
+	}
+	// a connected transport has its own mapping and keeps working
+	if( ClientSignal != NULL )
+	{
+		FPlatformProcess::DeleteInterprocessSynchObject(ClientSignal);
+	}
+	if( EditorSignal != NULL )
+	{
+		FPlatformProcess::DeleteInterprocessSynchObject(EditorSignal);
+	}
+	if( Region != NULL )
+	{
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(Region);
+	}
+}
+
+void Fm2uSharedMemoryListener::Stop()
+{
+	StopTaskCounter.Increment();
+}
+
+uint32 Fm2uSharedMemoryListener::Run()
+{
+	while( StopTaskCounter.GetValue() == 0 )
+	{
+		if( Header->State == Em2uSharedMemoryState::Requested )
+		{
+			Accept();
+		}
+		FPlatformProcess::Sleep(0.01f);
+	}
+	return 0;
+}
+
+void Fm2uSharedMemoryListener::Accept()
+{
+	// the client only touches the rings once it sees Connected
+	Header->ToEditor.WriteIndex = 0;
+	Header->ToEditor.ReadIndex = 0;
+	Header->ToEditor.ReaderWaiting = 0;
+	Header->ToClient.WriteIndex = 0;
+	Header->ToClient.ReadIndex = 0;
+	Header->ToClient.ReaderWaiting = 0;
+
+	Fm2uSharedMemoryTransport* Transport = Fm2uSharedMemoryTransport::Open(Port);
+	if( Transport == NULL )
+	{
+		UE_LOG(LogM2U, Error, TEXT("Could not open shared memory %s for a client."), *m2uSharedMemory::GetRegionName(Port));
+		FPlatformAtomics::InterlockedExchange(&Header->State, (int32)Em2uSharedMemoryState::Free);
+		return;
+	}
+	FPlatformAtomics::InterlockedExchange(&Header->State, (int32)Em2uSharedMemoryState::Connected);
+	if( ! NetworkThread->AddClient(Transport) )
+	{
+		UE_LOG(LogM2U, Log, TEXT("Connection declined"));
+		delete Transport; // sets the state back to Free
+	}
+}
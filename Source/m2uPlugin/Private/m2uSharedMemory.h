@@ -0,0 +1,234 @@
+#pragma once
+// Shared memory transport for clients on the same machine
+
+#include "m2uTransport.h"
+
+/**
+   When the client runs on the same machine, the command stream doesn't need to
+   go through the network stack at all. The editor creates a named shared memory
+   region "m2u_<Port>" holding a header and two byte rings, one for each
+   direction. The bytes going through the rings are exactly what would be sent
+   over TCP, so legacy and framed clients work the same way.
+
+   Layout, all values little-endian, every field group on its own cache line:
+
+   offset   0: uint32 Magic "m2uS", uint32 Version, uint32 RingSize
+   offset  64: int32 State, see Em2uSharedMemoryState
+   offset 128: ring client -> editor: uint32 WriteIndex (128), uint32 ReadIndex
+               (192), uint32 ReaderWaiting (256)
+   offset 320: ring editor -> client, same layout
+   offset 512: RingSize bytes of client -> editor data, then RingSize bytes of
+               editor -> client data
+
+   The indices are free-running byte counters, the position in the ring is
+   Index % RingSize. Only the writer advances WriteIndex and only the reader
+   advances ReadIndex, after copying the data.
+
+   Connecting: the client changes State from Free to Requested. The editor
+   resets the rings and sets it to Connected (or back to Free if it declines),
+   from then on both sides may use the rings. Whoever closes the connection
+   sets Closed, the editor sets it to Free again when it let go of it.
+
+   Waking up: a reader that goes to sleep sets its ReaderWaiting, checks the
+   ring once more and then waits on a named semaphore, "m2u_<Port>_editor" for
+   the editor and "m2u_<Port>_client" for the client. A writer that sees the
+   flag set after advancing WriteIndex signals that semaphore. A client should
+   also signal the editor semaphore after setting State to Closed.
+ */
+
+#define M2U_SHM_MAGIC 0x5375326D // "m2uS"
+#define M2U_SHM_VERSION 1
+#define M2U_SHM_HEADER_SIZE 512
+// bytes of buffer for each direction, must be a power of two
+#define M2U_SHM_RING_SIZE (4*1024*1024)
+
+namespace Em2uSharedMemoryState
+{
+	enum Type
+	{
+		Free = 0,      // waiting for a client
+		Requested = 1, // a client wants to connect
+		Connected = 2,
+		Closed = 3     // one side is done, the editor will free it
+	};
+}
+
+/** the control block of one direction */
+struct Fm2uSharedMemoryRing
+{
+	volatile uint32 WriteIndex;
+	uint8 Pad0[60];
+	volatile uint32 ReadIndex;
+	uint8 Pad1[60];
+	volatile uint32 ReaderWaiting;
+	uint8 Pad2[60];
+};
+
+struct Fm2uSharedMemoryHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 RingSize;
+	uint8 Pad0[52];
+	volatile int32 State;
+	uint8 Pad1[60];
+	Fm2uSharedMemoryRing ToEditor;
+	Fm2uSharedMemoryRing ToClient;
+};
+
+static_assert(sizeof(Fm2uSharedMemoryHeader) == M2U_SHM_HEADER_SIZE, "shared memory header layout changed");
+
+
+namespace m2uSharedMemory
+{
+	inline FString GetRegionName( uint16 Port )
+	{
+		return FString::Printf(TEXT("m2u_%i"), Port);
+	}
+
+	inline SIZE_T GetRegionSize()
+	{
+		return M2U_SHM_HEADER_SIZE + 2 * (SIZE_T)M2U_SHM_RING_SIZE;
+	}
+
+	/**
+	 * The bytes in the ring. The other process moves one of the indices, if
+	 * they are more than a ring apart it is broken or hostile.
+	 * @return -1 then
+	 */
+	inline int32 GetUsed( uint32 WriteIndex, uint32 ReadIndex )
+	{
+		const uint32 Used = WriteIndex - ReadIndex;
+		return Used <= M2U_SHM_RING_SIZE ? (int32)Used : -1;
+	}
+
+	/** @return -1 if the ring is corrupt, see GetUsed */
+	inline int32 Readable( const Fm2uSharedMemoryRing& Ring )
+	{
+		return GetUsed(Ring.WriteIndex, Ring.ReadIndex);
+	}
+
+	/**
+	 * copy up to MaxBytes out of the ring
+	 * @return the number of bytes read, -1 if the ring is corrupt
+	 */
+	inline int32 Read( Fm2uSharedMemoryRing& Ring, const uint8* Data, uint8* Dest, int32 MaxBytes )
+	{
+		const uint32 WriteIndex = Ring.WriteIndex;
+		FPlatformMisc::MemoryBarrier(); // see the data that was written before the index
+		const uint32 ReadIndex = Ring.ReadIndex;
+		const int32 Used = GetUsed(WriteIndex, ReadIndex);
+		if( Used < 0 )
+			return -1;
+		const int32 Count = FMath::Min<int32>(Used, MaxBytes);
+		const uint32 Start = ReadIndex & (M2U_SHM_RING_SIZE - 1);
+		const int32 FirstNum = FMath::Min<int32>(Count, M2U_SHM_RING_SIZE - Start);
+		FMemory::Memcpy(Dest, Data + Start, FirstNum);
+		FMemory::Memcpy(Dest + FirstNum, Data, Count - FirstNum);
+		FPlatformMisc::MemoryBarrier(); // done reading before the space is given back
+		Ring.ReadIndex = ReadIndex + Count;
+		return Count;
+	}
+
+	/**
+	 * copy up to Count bytes into the ring
+	 * @return the number of bytes written, -1 if the ring is corrupt
+	 */
+	inline int32 Write( Fm2uSharedMemoryRing& Ring, uint8* Data, const uint8* Src, int32 Count )
+	{
+		const uint32 ReadIndex = Ring.ReadIndex;
+		FPlatformMisc::MemoryBarrier();
+		const uint32 WriteIndex = Ring.WriteIndex;
+		const int32 Used = GetUsed(WriteIndex, ReadIndex);
+		if( Used < 0 )
+			return -1;
+		Count = FMath::Min<int32>(Count, M2U_SHM_RING_SIZE - Used);
+		const uint32 Start = WriteIndex & (M2U_SHM_RING_SIZE - 1);
+		const int32 FirstNum = FMath::Min<int32>(Count, M2U_SHM_RING_SIZE - Start);
+		FMemory::Memcpy(Data + Start, Src, FirstNum);
+		FMemory::Memcpy(Data, Src + FirstNum, Count - FirstNum);
+		FPlatformMisc::MemoryBarrier(); // the data must be visible before the index
+		Ring.WriteIndex = WriteIndex + Count;
+		FPlatformMisc::MemoryBarrier(); // and the index before we look at ReaderWaiting
+		return Count;
+	}
+}
+
+
+/**
+ * The editor side of a connected shared memory client. It maps the region on
+ * its own, so it stays valid even if the listener is gone before it.
+ */
+class Fm2uSharedMemoryTransport : public Fm2uTransport
+{
+public:
+
+	/** @return NULL if the region or the semaphores can't be opened */
+	static Fm2uSharedMemoryTransport* Open( uint16 Port );
+
+	virtual ~Fm2uSharedMemoryTransport();
+
+	virtual bool IsConnected() override;
+	virtual int32 GetPendingData() override;
+	virtual bool Recv( uint8* Dest, int32 MaxBytes, int32& BytesRead ) override;
+	virtual bool Send( const uint8* Data, int32 Count, int32& BytesSent ) override;
+	virtual void WaitForData( double Seconds ) override;
+	virtual FString Describe() const override;
+
+private:
+
+	Fm2uSharedMemoryTransport( uint16 InPort, FPlatformMemory::FSharedMemoryRegion* InRegion, FSemaphore* InEditorSignal, FSemaphore* InClientSignal );
+
+	/** log a protocol error once, the connection counts as closed then */
+	void SetCorrupt( const TCHAR* Ring );
+
+	uint16 Port;
+	FPlatformMemory::FSharedMemoryRegion* Region;
+	Fm2uSharedMemoryHeader* Header;
+	uint8* ToEditorData;
+	uint8* ToClientData;
+	// may be NULL if the platform has no named semaphores, we poll then
+	FSemaphore* EditorSignal;
+	FSemaphore* ClientSignal;
+	// the client moved an index of a ring out of range
+	bool bCorrupt;
+};
+
+
+/**
+ * Creates the shared memory region for a port and waits for clients to
+ * request a connection, which are then handed to the network thread. Works
+ * like the FTcpListener, only one shared memory client can be connected at a
+ * time though.
+ */
+class Fm2uSharedMemoryListener : public FRunnable
+{
+public:
+
+	Fm2uSharedMemoryListener( uint16 InPort, class Fm2uNetworkThread* InNetworkThread );
+	virtual ~Fm2uSharedMemoryListener();
+
+	/* FRunnable implementation */
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	/** false if the region could not be created */
+	bool IsListening() const
+	{
+		return Header != NULL;
+	}
+
+private:
+
+	void Accept();
+
+	uint16 Port;
+	Fm2uNetworkThread* NetworkThread;
+	FPlatformMemory::FSharedMemoryRegion* Region;
+	Fm2uSharedMemoryHeader* Header;
+	// created here so they exist as long as the region does
+	FSemaphore* EditorSignal;
+	FSemaphore* ClientSignal;
+	FRunnableThread* Thread;
+	FThreadSafeCounter StopTaskCounter;
+};
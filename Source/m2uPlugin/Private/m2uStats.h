@@ -0,0 +1,222 @@
+#pragma once
+// Execution time statistics of the commands
+
+#include "m2uOperation.h"
+
+/**
+   "stat m2u" in the editor shows what m2u costs per frame, in total and for
+   every command keyword that was executed. Which commands are slow over a
+   whole session can be seen with the "GetStats" command, or "m2uStats" in
+   the editor console: every executed command is timed and collected per
+   keyword, with count, total time, percentiles and the maximum.
+ */
+DECLARE_STATS_GROUP(TEXT("m2u"), STATGROUP_m2u, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Execute Commands"), STAT_m2uExecuteCommands, STATGROUP_m2u, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Step Async Tasks"), STAT_m2uStepRunningTasks, STATGROUP_m2u, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply Transform Stream"), STAT_m2uApplyTransformStream, STATGROUP_m2u, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flush Invalidation"), STAT_m2uFlushInvalidation, STATGROUP_m2u, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Commands Executed"), STAT_m2uCommandsExecuted, STATGROUP_m2u, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Async Tasks Running"), STAT_m2uRunningTasks, STATGROUP_m2u, );
+
+// the histogram has this many buckets per doubling of the time, so a
+// percentile is off by at most 2^(1/4), about 19%
+#define M2U_STATS_BUCKETS_PER_OCTAVE 4
+// from 1 microsecond up to 2^32 microseconds, over an hour
+#define M2U_STATS_NUM_BUCKETS 128
+
+/**
+ * Execution times of one command on a logarithmic scale.
+ */
+class Fm2uLatencyHistogram
+{
+public:
+
+	Fm2uLatencyHistogram()
+		:Count(0),
+		 TotalSeconds(0.0),
+		 MaxSeconds(0.0)
+	{
+		FMemory::Memzero(Buckets, sizeof(Buckets));
+	}
+
+	void Add( double Seconds )
+	{
+		++Count;
+		TotalSeconds += Seconds;
+		MaxSeconds = FMath::Max(MaxSeconds, Seconds);
+		++Buckets[GetBucket(Seconds)];
+	}
+
+	uint32 GetCount() const
+	{
+		return Count;
+	}
+
+	double GetTotalSeconds() const
+	{
+		return TotalSeconds;
+	}
+
+	double GetMaxSeconds() const
+	{
+		return MaxSeconds;
+	}
+
+	/** the time Fraction (0 to 1) of all executions stayed below */
+	double GetPercentile( double Fraction ) const
+	{
+		if( Count == 0 )
+			return 0.0;
+		uint64 Needed = (uint64)(Fraction * Count);
+		if( Needed < Fraction * Count || Needed == 0 )
+		{
+			++Needed; // round up
+		}
+		uint64 Seen = 0;
+		for( int32 Idx = 0; Idx < M2U_STATS_NUM_BUCKETS; ++Idx )
+		{
+			Seen += Buckets[Idx];
+			if( Seen >= Needed )
+			{
+				// the upper end of the bucket, but never more than really happened
+				return FMath::Min(MaxSeconds, GetBucketLimit(Idx));
+			}
+		}
+		return MaxSeconds;
+	}
+
+private:
+
+	/** bucket Idx holds times up to 2^(Idx/BUCKETS_PER_OCTAVE) microseconds */
+	static int32 GetBucket( double Seconds )
+	{
+		const double Microseconds = Seconds * 1000000.0;
+		if( Microseconds <= 1.0 )
+			return 0;
+		// in double, FMath only has float, which puts times right at a bucket
+		// limit into the next bucket
+		const double Idx = ceil(log2(Microseconds) * M2U_STATS_BUCKETS_PER_OCTAVE);
+		return (int32)FMath::Min(Idx, (double)(M2U_STATS_NUM_BUCKETS - 1));
+	}
+
+	static double GetBucketLimit( int32 Idx )
+	{
+		return pow(2.0, (double)Idx / M2U_STATS_BUCKETS_PER_OCTAVE) / 1000000.0;
+	}
+
+	uint32 Count;
+	double TotalSeconds;
+	double MaxSeconds;
+	uint32 Buckets[M2U_STATS_NUM_BUCKETS];
+};
+
+
+/**
+ * The execution times of all commands, by keyword. Only used on the game
+ * thread.
+ */
+class Fm2uCommandStats
+{
+public:
+
+	Fm2uCommandStats()
+		:StartTime(FPlatformTime::Seconds())
+	{}
+
+	/** remember that the command Cmd took Seconds to execute */
+	void Add( const TCHAR* Cmd, double Seconds )
+	{
+		Add(Fm2uOperationManager::GetKeyword(Cmd), Seconds);
+	}
+
+	void Add( FName Keyword, double Seconds )
+	{
+		Histograms.FindOrAdd(Keyword).Add(Seconds);
+	}
+
+	void Reset()
+	{
+		Histograms.Reset();
+		StartTime = FPlatformTime::Seconds();
+	}
+
+	/**
+	 * One line per keyword, the one that took the most time in total first,
+	 * all times in milliseconds:
+	 * "AddActor count=12 total=35.100 p50=2.378 p95=4.000 p99=4.000 max=4.210"
+	 * The last line is the time since the stats were reset and the commands
+	 * per second in that time.
+	 */
+	FString ToString() const
+	{
+		TArray<FName> Keywords;
+		Histograms.GetKeys(Keywords);
+		Keywords.Sort([this]( const FName& A, const FName& B )
+		{
+			return Histograms.FindChecked(A).GetTotalSeconds() > Histograms.FindChecked(B).GetTotalSeconds();
+		});
+
+		FString Result;
+		uint32 NumCommands = 0;
+		for( const FName& Keyword : Keywords )
+		{
+			const Fm2uLatencyHistogram& Histogram = Histograms.FindChecked(Keyword);
+			NumCommands += Histogram.GetCount();
+			Result += FString::Printf(TEXT("%s count=%u total=%.3f p50=%.3f p95=%.3f p99=%.3f max=%.3f\n"),
+				Keyword == NAME_None ? TEXT("Unknown") : *Keyword.ToString(),
+				Histogram.GetCount(),
+				Histogram.GetTotalSeconds() * 1000.0,
+				Histogram.GetPercentile(0.50) * 1000.0,
+				Histogram.GetPercentile(0.95) * 1000.0,
+				Histogram.GetPercentile(0.99) * 1000.0,
+				Histogram.GetMaxSeconds() * 1000.0);
+		}
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+		Result += FString::Printf(TEXT("elapsed=%.1f commands/s=%.1f"), Elapsed, Elapsed > 0.0 ? NumCommands / Elapsed : 0.0);
+		return Result;
+	}
+
+	void Report( FOutputDevice& Ar ) const
+	{
+		TArray<FString> Lines;
+		ToString().ParseIntoArrayLines(Lines);
+		for( const FString& Line : Lines )
+		{
+			Ar.Logf(TEXT("m2u %s"), *Line);
+		}
+	}
+
+private:
+
+	// commands that aren't known are collected under NAME_None
+	TMap<FName, Fm2uLatencyHistogram> Histograms;
+	double StartTime;
+};
+
+
+namespace m2uStats
+{
+	/** the stats of all commands from all clients */
+	inline Fm2uCommandStats& Get()
+	{
+		static Fm2uCommandStats Stats;
+		return Stats;
+	}
+
+	/** the cycle stat of a keyword in "stat m2u", created when first used */
+	inline TStatId GetStatId( FName Keyword )
+	{
+#if STATS
+		static TMap<FName, TStatId> StatIds;
+		const TStatId* Existing = StatIds.Find(Keyword);
+		if( Existing != NULL )
+			return *Existing;
+		const TStatId StatId = FDynamicStats::CreateStatId<FStatGroup_STATGROUP_m2u>(Keyword == NAME_None ? FString(TEXT("Unknown")) : Keyword.ToString());
+		StatIds.Add(Keyword, StatId);
+		return StatId;
+#else
+		return TStatId();
+#endif
+	}
+}
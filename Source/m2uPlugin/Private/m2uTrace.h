@@ -0,0 +1,230 @@
+#pragma once
+// Timeline of what m2u does, for chrome://tracing
+
+// how many spans are kept by default, later ones are dropped
+#define M2U_TRACE_DEFAULT_CAPACITY (1024*1024)
+
+/**
+   "m2uTrace start" in the editor console starts recording spans of the work
+   m2u does on the game thread and the network thread: receiving and decoding
+   frames, executing commands, and encoding and sending responses, together
+   with the editor ticks. "m2uTrace dump" writes them as Chrome trace-event
+   JSON, which chrome://tracing or https://ui.perfetto.dev can show.
+
+   Recording only costs anything while it is started. The spans go into a
+   buffer allocated when recording starts, every thread reserves a slot with
+   an atomic increment, so nothing locks or allocates on the way.
+ */
+struct Fm2uTraceEvent
+{
+	// a string literal, NULL until the event is completely written
+	const TCHAR* volatile Name;
+	double StartTime;
+	double EndTime;
+	uint32 ThreadId;
+	// a request or connection id
+	uint32 Id;
+	// the command keyword, if any
+	FName Detail;
+};
+
+
+class Fm2uTracer
+{
+public:
+
+	Fm2uTracer()
+		:Events(NULL),
+		 Capacity(0),
+		 NextEvent(0),
+		 NumDropped(0),
+		 NumWriters(0),
+		 bEnabled(false),
+		 StartTime(0.0)
+	{}
+
+	~Fm2uTracer()
+	{
+		FMemory::Free(Events);
+	}
+
+	bool IsEnabled() const
+	{
+		return bEnabled;
+	}
+
+	/**
+	 * Forget all spans and start recording. Only call this on the game thread,
+	 * the buffer is replaced.
+	 */
+	void Start( int32 InCapacity = M2U_TRACE_DEFAULT_CAPACITY )
+	{
+		bEnabled = false;
+		FPlatformMisc::MemoryBarrier();
+		// a span that is just being written by another thread saw bEnabled
+		// before it was cleared, wait until it is done with the buffer. Every
+		// later Add sees it cleared and leaves the buffer alone.
+		while( NumWriters != 0 )
+		{
+			FPlatformProcess::YieldThread();
+		}
+		if( Events == NULL || InCapacity != Capacity )
+		{
+			FMemory::Free(Events);
+			Capacity = FMath::Max(1, InCapacity);
+			Events = (Fm2uTraceEvent*)FMemory::Malloc(Capacity * sizeof(Fm2uTraceEvent));
+		}
+		FMemory::Memzero(Events, Capacity * sizeof(Fm2uTraceEvent));
+		NextEvent = 0;
+		NumDropped = 0;
+		StartTime = FPlatformTime::Seconds();
+		FPlatformMisc::MemoryBarrier();
+		bEnabled = true;
+	}
+
+	/** stop recording, the spans are kept for dumping */
+	void Stop()
+	{
+		bEnabled = false;
+	}
+
+	/** add a finished span, Name has to be a string literal */
+	void Add( const TCHAR* Name, double InStartTime, double InEndTime, uint32 Id, FName Detail )
+	{
+		if( ! bEnabled )
+			return;
+		// counted before bEnabled is looked at again, so Start can't miss us
+		FPlatformAtomics::InterlockedIncrement(&NumWriters);
+		if( bEnabled )
+		{
+			// reserve a slot, NextEvent never goes beyond Capacity so it can't
+			// overflow however long the trace runs
+			int32 Index = NextEvent;
+			while( Index < Capacity )
+			{
+				const int32 Seen = FPlatformAtomics::InterlockedCompareExchange(&NextEvent, Index + 1, Index);
+				if( Seen == Index )
+					break;
+				Index = Seen;
+			}
+			if( Index < Capacity )
+			{
+				Fm2uTraceEvent& Event = Events[Index];
+				Event.StartTime = InStartTime;
+				Event.EndTime = InEndTime;
+				Event.ThreadId = FPlatformTLS::GetCurrentThreadId();
+				Event.Id = Id;
+				Event.Detail = Detail;
+				FPlatformMisc::MemoryBarrier();
+				Event.Name = Name;
+			}
+			else
+			{
+				// 64 bits, a trace would have to run for centuries to overflow it
+				FPlatformAtomics::InterlockedIncrement(&NumDropped);
+			}
+		}
+		FPlatformAtomics::InterlockedDecrement(&NumWriters);
+	}
+
+	/** how many spans were recorded and how many didn't fit */
+	void GetCounts( int32& OutRecorded, int64& OutDropped ) const
+	{
+		OutRecorded = NextEvent;
+		OutDropped = NumDropped;
+	}
+
+	/** write all complete spans as Chrome trace-event JSON */
+	bool Dump( const FString& Filename ) const
+	{
+		int32 NumEvents;
+		int64 NumSpansDropped;
+		GetCounts(NumEvents, NumSpansDropped);
+
+		FString Json = TEXT("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		Json += FString::Printf(TEXT("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Game Thread\"}}"), GGameThreadId);
+		for( int32 Idx = 0; Idx < NumEvents; ++Idx )
+		{
+			const Fm2uTraceEvent& Event = Events[Idx];
+			const TCHAR* Name = Event.Name;
+			if( Name == NULL )
+				continue; // still being written
+			Json += FString::Printf(TEXT(",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"id\":%u"),
+				Name, Event.ThreadId, (Event.StartTime - StartTime) * 1000000.0, (Event.EndTime - Event.StartTime) * 1000000.0, Event.Id);
+			if( Event.Detail != NAME_None )
+			{
+				Json += FString::Printf(TEXT(",\"command\":\"%s\""), *Event.Detail.ToString());
+			}
+			Json += TEXT("}}");
+		}
+		Json += FString::Printf(TEXT("\n],\"otherData\":{\"dropped\":%lld}}\n"), NumSpansDropped);
+		return FFileHelper::SaveStringToFile(Json, *Filename);
+	}
+
+private:
+
+	Fm2uTraceEvent* Events;
+	int32 Capacity;
+	// the next free slot, at most Capacity
+	volatile int32 NextEvent;
+	// spans that came when the buffer was full
+	volatile int64 NumDropped;
+	// threads that are inside Add, see Start
+	volatile int32 NumWriters;
+	volatile bool bEnabled;
+	double StartTime;
+};
+
+
+namespace m2uTrace
+{
+	/** the tracer shared by all threads */
+	inline Fm2uTracer& Get()
+	{
+		static Fm2uTracer Tracer;
+		return Tracer;
+	}
+}
+
+
+/**
+ * Records a span from its construction to its destruction, if the tracer is
+ * recording.
+ */
+class Fm2uTraceScope
+{
+public:
+
+	Fm2uTraceScope( const TCHAR* InName, uint32 InId = 0, FName InDetail = NAME_None )
+		:Name(m2uTrace::Get().IsEnabled() ? InName : NULL),
+		 Id(InId),
+		 Detail(InDetail),
+		 StartTime(Name != NULL ? FPlatformTime::Seconds() : 0.0)
+	{}
+
+	~Fm2uTraceScope()
+	{
+		if( Name != NULL )
+		{
+			m2uTrace::Get().Add(Name, StartTime, FPlatformTime::Seconds(), Id, Detail);
+		}
+	}
+
+	/** don't record this span, e.g. when there was nothing to do after all */
+	void Cancel()
+	{
+		Name = NULL;
+	}
+
+	void SetDetail( FName InDetail )
+	{
+		Detail = InDetail;
+	}
+
+private:
+
+	const TCHAR* Name;
+	uint32 Id;
+	FName Detail;
+	double StartTime;
+};
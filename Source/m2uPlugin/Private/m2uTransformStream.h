@@ -0,0 +1,227 @@
+#pragma once
+// Binary stream of actor transforms for interactive manipulation
+
+#include "m2uFraming.h"
+
+/**
+   While the user drags objects around, the client sends a flood of transform
+   updates. Instead of one "TransformObject Name T=(..) R=(..) S=(..)" text
+   command per object, a framed client can send binary frames with the
+   M2U_FRAME_FLAG_TRANSFORMS flag. They are not answered, all records received
+   until the end of an editor tick are applied together, every actor only once
+   with its newest transform. The expensive final editor notifications for a
+   moved actor are only done once it stopped receiving updates.
+
+   The frames keep their place among the commands of the same connection: a
+   frame is applied only after the commands the client sent before it were
+   executed, and the commands sent after it wait for the end of the tick it
+   was applied in. A text TransformObject sent before a frame thus never
+   undoes what the frame did, and one sent after it always wins. Frames that
+   follow each other directly are merged in the command queue.
+
+   Actors are addressed by handles, which the client gets with the text command
+   "GetActorHandles [Name1,Name2,...]". The answer is the list of handles in
+   the same order, 0 for names that weren't found. Handles stay valid as long
+   as the actor exists.
+
+   Payload, little-endian:
+
+   | uint16 FloatsPerRecord | uint16 Reserved | Record ... |
+
+   with every record being a uint32 handle followed by FloatsPerRecord floats:
+   9:  T(x y z) R(pitch yaw roll in degrees) S(x y z), like the text commands
+   10: T(x y z) Q(x y z w) S(x y z), rotation as quaternion
+ */
+
+#define M2U_TRANSFORM_STREAM_HEADER_SIZE 4
+
+struct Fm2uTransformRecord
+{
+	uint32 Handle;
+	FTransform Transform;
+};
+
+
+namespace m2uTransformStream
+{
+	inline float ReadFloat( const uint8* Data )
+	{
+		const uint32 Bits = m2uFraming::ReadUInt32( Data );
+		float Value;
+		FMemory::Memcpy( &Value, &Bits, sizeof(Value) );
+		return Value;
+	}
+
+	/**
+	   Decode a transform stream payload into Out, replacing its contents.
+	   @return false if the payload is malformed
+	 */
+	inline bool Decode( const uint8* Data, int32 Num, TArray<Fm2uTransformRecord>& Out )
+	{
+		Out.Reset();
+		if( Num < M2U_TRANSFORM_STREAM_HEADER_SIZE )
+			return false;
+		const int32 FloatsPerRecord = Data[0] | (Data[1] << 8);
+		if( FloatsPerRecord != 9 && FloatsPerRecord != 10 )
+			return false;
+		const int32 RecordSize = 4 + FloatsPerRecord * 4;
+		Data += M2U_TRANSFORM_STREAM_HEADER_SIZE;
+		Num -= M2U_TRANSFORM_STREAM_HEADER_SIZE;
+		if( Num % RecordSize != 0 )
+			return false;
+
+		const int32 NumRecords = Num / RecordSize;
+		Out.AddUninitialized( NumRecords );
+		for( int32 Idx = 0; Idx < NumRecords; ++Idx, Data += RecordSize )
+		{
+			Fm2uTransformRecord& Record = Out[Idx];
+			Record.Handle = m2uFraming::ReadUInt32( Data );
+			const uint8* Values = Data + 4;
+			const FVector Location( ReadFloat(Values), ReadFloat(Values + 4), ReadFloat(Values + 8) );
+			Values += 12;
+			FQuat Rotation;
+			if( FloatsPerRecord == 9 )
+			{
+				Rotation = FRotator( ReadFloat(Values), ReadFloat(Values + 4), ReadFloat(Values + 8) ).Quaternion();
+				Values += 12;
+			}
+			else
+			{
+				Rotation = FQuat( ReadFloat(Values), ReadFloat(Values + 4), ReadFloat(Values + 8), ReadFloat(Values + 12) );
+				Rotation.Normalize();
+				Values += 16;
+			}
+			const FVector Scale( ReadFloat(Values), ReadFloat(Values + 4), ReadFloat(Values + 8) );
+			Record.Transform = FTransform( Rotation, Location, Scale );
+		}
+		return true;
+	}
+}
+
+
+/**
+ * Hands out small integer handles for actors, so the transform stream doesn't
+ * need to carry and look up names. Only used on the game thread.
+ */
+class Fm2uActorHandleTable
+{
+public:
+
+	/** get the handle of an actor, it gets one if it has none yet */
+	uint32 GetHandle( AActor* Actor )
+	{
+		const uint32* Existing = HandlesByActor.Find( Actor );
+		if( Existing != NULL && Resolve(*Existing) == Actor )
+			return *Existing;
+		Actors.Add( Actor );
+		const uint32 Handle = Actors.Num(); // 0 is never a valid handle
+		HandlesByActor.Add( Actor, Handle );
+		return Handle;
+	}
+
+	/** @return NULL if the handle is invalid or its actor is gone */
+	AActor* Resolve( uint32 Handle ) const
+	{
+		if( Handle == 0 || Handle > (uint32)Actors.Num() )
+			return NULL;
+		return Actors[Handle - 1].Get();
+	}
+
+	int32 Num() const
+	{
+		return Actors.Num();
+	}
+
+private:
+
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TMap<AActor*, uint32> HandlesByActor;
+};
+
+
+namespace m2uTransformStream
+{
+	/** the handles shared by all connections */
+	inline Fm2uActorHandleTable& GetActorHandles()
+	{
+		static Fm2uActorHandleTable Handles;
+		return Handles;
+	}
+}
+
+
+/**
+ * Collects the received transform records and applies them once per tick.
+ * Only used on the game thread.
+ */
+class Fm2uTransformApplier
+{
+public:
+
+	/** remember the records, newer ones replace older ones of the same actor */
+	void Add( const TArray<Fm2uTransformRecord>& Records )
+	{
+		for( const Fm2uTransformRecord& Record : Records )
+		{
+			const int32* Index = PendingIndex.Find( Record.Handle );
+			if( Index != NULL )
+			{
+				Pending[*Index] = Record;
+			}
+			else
+			{
+				PendingIndex.Add( Record.Handle, Pending.Add(Record) );
+			}
+		}
+	}
+
+	/**
+	   Move all actors with pending records.
+	   @return true if any actor changed, the viewports need a redraw then
+	 */
+	bool Apply()
+	{
+		const Fm2uActorHandleTable& Handles = m2uTransformStream::GetActorHandles();
+		bool bChanged = false;
+
+		// actors that were moving but got no update anymore are done, now
+		// the editor may do all the work it skips while an actor is dragged
+		for( uint32 Handle : Moving )
+		{
+			if( PendingIndex.Contains(Handle) )
+				continue;
+			AActor* Actor = Handles.Resolve( Handle );
+			if( Actor != NULL )
+			{
+				Actor->PostEditMove( true );
+				bChanged = true;
+			}
+		}
+		Moving.Reset();
+
+		for( const Fm2uTransformRecord& Record : Pending )
+		{
+			AActor* Actor = Handles.Resolve( Record.Handle );
+			if( Actor == NULL )
+				continue;
+			// like m2uHelper::SetActorTransformRelativeFromText, but the
+			// finishing PostEditMove waits until the actor stops moving
+			Actor->SetActorRelativeTransform( Record.Transform, false );
+			Actor->InvalidateLightingCache();
+			Actor->PostEditMove( false );
+			Actor->MarkPackageDirty();
+			Moving.Add( Record.Handle );
+			bChanged = true;
+		}
+		Pending.Reset();
+		PendingIndex.Reset();
+		return bChanged;
+	}
+
+private:
+
+	TArray<Fm2uTransformRecord> Pending;
+	TMap<uint32, int32> PendingIndex;
+	// handles of the actors moved in the last tick
+	TArray<uint32> Moving;
+};
@@ -0,0 +1,110 @@
+#pragma once
+// The byte streams a client connection can run over
+
+/**
+ * A bidirectional byte stream to one client. The network thread only ever
+ * uses it non-blocking, except for WaitForData when it has nothing else to do.
+ * Everything above it (protocol detection, framing, compression) is the same
+ * for every kind of transport.
+ */
+class Fm2uTransport
+{
+public:
+
+	virtual ~Fm2uTransport() {}
+
+	/** false once the client is gone */
+	virtual bool IsConnected() = 0;
+
+	/** the number of bytes that can be read right now */
+	virtual int32 GetPendingData() = 0;
+
+	/**
+	 * read at most MaxBytes without blocking
+	 * @return false if the connection broke
+	 */
+	virtual bool Recv( uint8* Dest, int32 MaxBytes, int32& BytesRead ) = 0;
+
+	/**
+	 * write as much of Data as possible without blocking, BytesSent may be
+	 * less than Count when the transport is full.
+	 * @return false if the connection broke
+	 */
+	virtual bool Send( const uint8* Data, int32 Count, int32& BytesSent ) = 0;
+
+	/** sleep until there may be something to read, but at most Seconds */
+	virtual void WaitForData( double Seconds ) = 0;
+
+	/** a short description for the log */
+	virtual FString Describe() const = 0;
+};
+
+
+/**
+ * A client connected through a socket accepted by a listener.
+ */
+class Fm2uSocketTransport : public Fm2uTransport
+{
+public:
+
+	explicit Fm2uSocketTransport( FSocket* InSocket )
+		:Socket(InSocket)
+	{
+		// never block the thread on a client that doesn't read
+		Socket->SetNonBlocking(true);
+		int32 NewSize;
+		Socket->SetReceiveBufferSize(4000000, NewSize);
+	}
+
+	virtual ~Fm2uSocketTransport()
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+	}
+
+	virtual bool IsConnected() override
+	{
+		return Socket->GetConnectionState() == SCS_Connected;
+	}
+
+	virtual int32 GetPendingData() override
+	{
+		uint32 DataSize = 0;
+		if( ! Socket->HasPendingData(DataSize) )
+			return 0;
+		return (int32)FMath::Min<uint32>(DataSize, MAX_int32);
+	}
+
+	virtual bool Recv( uint8* Dest, int32 MaxBytes, int32& BytesRead ) override
+	{
+		BytesRead = 0;
+		if( Socket->Recv(Dest, MaxBytes, BytesRead) )
+			return true;
+		BytesRead = 0;
+		return ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode() == SE_EWOULDBLOCK;
+	}
+
+	virtual bool Send( const uint8* Data, int32 Count, int32& BytesSent ) override
+	{
+		BytesSent = 0;
+		if( Socket->Send(Data, Count, BytesSent) )
+			return true;
+		// the socket buffer is full, that is no error
+		BytesSent = 0;
+		return ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode() == SE_EWOULDBLOCK;
+	}
+
+	virtual void WaitForData( double Seconds ) override
+	{
+		Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(Seconds));
+	}
+
+	virtual FString Describe() const override
+	{
+		return FString::Printf(TEXT("Port %i"), Socket->GetPortNo());
+	}
+
+private:
+
+	FSocket* Socket;
+};
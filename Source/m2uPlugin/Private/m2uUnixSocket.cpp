@@ -0,0 +1,250 @@
+#include "m2uPluginPrivatePCH.h"
+#include "m2uUnixSocket.h"
+
+#if M2U_WITH_UNIX_SOCKETS
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/ioctl.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+// don't get killed by SIGPIPE when a client went away
+#ifdef MSG_NOSIGNAL
+#define M2U_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define M2U_SEND_FLAGS 0
+#endif
+
+namespace
+{
+	/** create the directory if needed, @return false if others may access it */
+	bool MakePrivateDirectory( const FString& Directory )
+	{
+		const FTCHARToUTF8 DirectoryUtf8(*Directory);
+		if( mkdir(DirectoryUtf8.Get(), 0700) != 0 && errno != EEXIST )
+			return false;
+		// somebody else may have created it first, or a link to somewhere else
+		struct stat Status;
+		if( lstat(DirectoryUtf8.Get(), &Status) != 0 )
+			return false;
+		return S_ISDIR(Status.st_mode) && Status.st_uid == getuid() && (Status.st_mode & 0077) == 0;
+	}
+
+	/** @return true if something still accepts connections on the socket */
+	bool IsSocketInUse( const sockaddr_un& Address )
+	{
+		const int Probe = socket(AF_UNIX, SOCK_STREAM, 0);
+		if( Probe < 0 )
+			return false;
+		const int Result = connect(Probe, (const sockaddr*)&Address, sizeof(Address));
+		const int Error = errno;
+		close(Probe);
+		// refused means nobody listens on the file anymore
+		return Result == 0 || (Error != ECONNREFUSED && Error != ENOENT);
+	}
+}
+
+
+FString m2uUnixSocket::GetSocketDirectory()
+{
+	// it is private to the user by definition
+	const char* RuntimeDirectory = getenv("XDG_RUNTIME_DIR");
+	if( RuntimeDirectory != NULL && RuntimeDirectory[0] == '/' )
+		return UTF8_TO_TCHAR(RuntimeDirectory);
+	return FString::Printf(TEXT("/tmp/m2u-%u"), (uint32)getuid());
+}
+
+FString m2uUnixSocket::GetSocketPath( uint16 Port )
+{
+	return GetSocketDirectory() / FString::Printf(TEXT("m2u_%i.sock"), Port);
+}
+
+
+Fm2uUnixSocketTransport::Fm2uUnixSocketTransport( int InFileDescriptor )
+	:FileDescriptor(InFileDescriptor),
+	 bClosed(false)
+{
+	// never block the thread on a client that doesn't read
+	fcntl(FileDescriptor, F_SETFL, fcntl(FileDescriptor, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+	int NoSigPipe = 1;
+	setsockopt(FileDescriptor, SOL_SOCKET, SO_NOSIGPIPE, &NoSigPipe, sizeof(NoSigPipe));
+#endif
+	int BufferSize = 4000000;
+	setsockopt(FileDescriptor, SOL_SOCKET, SO_RCVBUF, &BufferSize, sizeof(BufferSize));
+}
+
+Fm2uUnixSocketTransport::~Fm2uUnixSocketTransport()
+{
+	close(FileDescriptor);
+}
+
+bool Fm2uUnixSocketTransport::IsConnected()
+{
+	if( bClosed )
+		return false;
+	// a readable socket without data means the client hung up
+	uint8 Byte;
+	const ssize_t Result = recv(FileDescriptor, &Byte, 1, MSG_PEEK | MSG_DONTWAIT);
+	if( Result == 0 || (Result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) )
+	{
+		bClosed = true;
+	}
+	return ! bClosed;
+}
+
+int32 Fm2uUnixSocketTransport::GetPendingData()
+{
+	int Pending = 0;
+	if( ioctl(FileDescriptor, FIONREAD, &Pending) != 0 )
+		return 0;
+	return Pending;
+}
+
+bool Fm2uUnixSocketTransport::Recv( uint8* Dest, int32 MaxBytes, int32& BytesRead )
+{
+	BytesRead = 0;
+	const ssize_t Result = recv(FileDescriptor, Dest, MaxBytes, MSG_DONTWAIT);
+	if( Result > 0 )
+	{
+		BytesRead = (int32)Result;
+		return true;
+	}
+	if( Result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) )
+		return true;
+	bClosed = true;
+	return false;
+}
+
+bool Fm2uUnixSocketTransport::Send( const uint8* Data, int32 Count, int32& BytesSent )
+{
+	BytesSent = 0;
+	const ssize_t Result = send(FileDescriptor, Data, Count, MSG_DONTWAIT | M2U_SEND_FLAGS);
+	if( Result >= 0 )
+	{
+		BytesSent = (int32)Result;
+		return true;
+	}
+	// the socket buffer is full, that is no error
+	if( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR )
+		return true;
+	bClosed = true;
+	return false;
+}
+
+void Fm2uUnixSocketTransport::WaitForData( double Seconds )
+{
+	pollfd Poll;
+	Poll.fd = FileDescriptor;
+	Poll.events = POLLIN;
+	Poll.revents = 0;
+	poll(&Poll, 1, FMath::Max(1, (int32)(Seconds * 1000.0)));
+}
+
+FString Fm2uUnixSocketTransport::Describe() const
+{
+	return FString::Printf(TEXT("Unix Socket %i"), FileDescriptor);
+}
+
+
+Fm2uUnixSocketListener::Fm2uUnixSocketListener( uint16 InPort, Fm2uNetworkThread* InNetworkThread )
+	:Path(m2uUnixSocket::GetSocketPath(InPort)),
+	 NetworkThread(InNetworkThread),
+	 ListenDescriptor(-1),
+	 Thread(NULL)
+{
+	// only the user running the editor may connect
+	if( ! MakePrivateDirectory(FPaths::GetPath(Path)) )
+	{
+		UE_LOG(LogM2U, Error, TEXT("Could not listen on %s, its directory is missing or accessible by others"), *Path);
+		return;
+	}
+	sockaddr_un Address;
+	FMemory::Memzero(&Address, sizeof(Address));
+	Address.sun_family = AF_UNIX;
+	const FTCHARToUTF8 PathUtf8(*Path);
+	if( PathUtf8.Length() >= (int32)sizeof(Address.sun_path) )
+	{
+		UE_LOG(LogM2U, Error, TEXT("Could not listen on %s, the path is too long"), *Path);
+		return;
+	}
+	FMemory::Memcpy(Address.sun_path, PathUtf8.Get(), PathUtf8.Length());
+
+	ListenDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+	if( ListenDescriptor < 0 )
+	{
+		UE_LOG(LogM2U, Error, TEXT("Could not create unix socket: %i"), errno);
+		return;
+	}
+	// another editor may be listening on the same port, but a previous session
+	// that crashed may also have left its socket file behind
+	if( IsSocketInUse(Address) )
+	{
+		UE_LOG(LogM2U, Error, TEXT("Could not listen on %s, it is already in use"), *Path);
+		close(ListenDescriptor);
+		ListenDescriptor = -1;
+		return;
+	}
+	unlink(Address.sun_path);
+	if( bind(ListenDescriptor, (sockaddr*)&Address, sizeof(Address)) != 0 || listen(ListenDescriptor, 8) != 0 )
+	{
+		UE_LOG(LogM2U, Error, TEXT("Could not listen on %s: %i"), *Path, errno);
+		close(ListenDescriptor);
+		ListenDescriptor = -1;
+		return;
+	}
+
+	UE_LOG(LogM2U, Log, TEXT("Hosting on %s"), *Path);
+	Thread = FRunnableThread::Create(this, TEXT("m2uUnixSocketListener"), 0, TPri_BelowNormal);
+}
+
+Fm2uUnixSocketListener::~Fm2uUnixSocketListener()
+{
+	if( Thread != NULL )
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = NULL;
+	}
+	if( ListenDescriptor >= 0 )
+	{
+		close(ListenDescriptor);
+		unlink(TCHAR_TO_UTF8(*Path));
+	}
+}
+
+void Fm2uUnixSocketListener::Stop()
+{
+	StopTaskCounter.Increment();
+}
+
+uint32 Fm2uUnixSocketListener::Run()
+{
+	while( StopTaskCounter.GetValue() == 0 )
+	{
+		// wake up regularly to notice Stop
+		pollfd Poll;
+		Poll.fd = ListenDescriptor;
+		Poll.events = POLLIN;
+		Poll.revents = 0;
+		if( poll(&Poll, 1, 100) <= 0 )
+			continue;
+
+		const int ClientDescriptor = accept(ListenDescriptor, NULL, NULL);
+		if( ClientDescriptor < 0 )
+			continue;
+		Fm2uUnixSocketTransport* Transport = new Fm2uUnixSocketTransport(ClientDescriptor);
+		if( ! NetworkThread->AddClient(Transport) )
+		{
+			UE_LOG(LogM2U, Log, TEXT("Connection declined"));
+			delete Transport;
+		}
+	}
+	return 0;
+}
+
+#endif // M2U_WITH_UNIX_SOCKETS
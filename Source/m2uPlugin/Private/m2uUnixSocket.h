@@ -0,0 +1,87 @@
+#pragma once
+// Unix domain socket transport for local clients
+
+#include "m2uTransport.h"
+
+// AF_UNIX stream sockets are only used where they are native
+#define M2U_WITH_UNIX_SOCKETS (PLATFORM_LINUX || PLATFORM_MAC)
+
+#if M2U_WITH_UNIX_SOCKETS
+
+/**
+   Instead of the TCP port on all interfaces, the plugin can listen on a unix
+   domain socket "m2u_<Port>.sock" in $XDG_RUNTIME_DIR, or "/tmp/m2u-<uid>/"
+   where that isn't set. The directory must only be accessible by the user, so
+   only processes on the same machine of the same user can connect then, and
+   the data doesn't go through the TCP stack (no Nagle, no checksums, no
+   loopback routing).
+
+   The stream is exactly what would be sent over TCP, so legacy and framed
+   clients work the same way, e.g. in python:
+     socket.socket(socket.AF_UNIX, socket.SOCK_STREAM).connect("/run/user/1000/m2u_3939.sock")
+ */
+
+namespace m2uUnixSocket
+{
+	/** the private directory of the user the socket files go to */
+	FString GetSocketDirectory();
+
+	FString GetSocketPath( uint16 Port );
+}
+
+
+/**
+ * A connected client socket, owned and closed by this.
+ */
+class Fm2uUnixSocketTransport : public Fm2uTransport
+{
+public:
+
+	explicit Fm2uUnixSocketTransport( int InFileDescriptor );
+	virtual ~Fm2uUnixSocketTransport();
+
+	virtual bool IsConnected() override;
+	virtual int32 GetPendingData() override;
+	virtual bool Recv( uint8* Dest, int32 MaxBytes, int32& BytesRead ) override;
+	virtual bool Send( const uint8* Data, int32 Count, int32& BytesSent ) override;
+	virtual void WaitForData( double Seconds ) override;
+	virtual FString Describe() const override;
+
+private:
+
+	int FileDescriptor;
+	bool bClosed;
+};
+
+
+/**
+ * Accepts clients on the unix domain socket of a port and hands them to the
+ * network thread, like the FTcpListener does for TCP.
+ */
+class Fm2uUnixSocketListener : public FRunnable
+{
+public:
+
+	Fm2uUnixSocketListener( uint16 InPort, class Fm2uNetworkThread* InNetworkThread );
+	virtual ~Fm2uUnixSocketListener();
+
+	/* FRunnable implementation */
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	/** false if the socket could not be created */
+	bool IsListening() const
+	{
+		return ListenDescriptor >= 0;
+	}
+
+private:
+
+	FString Path;
+	Fm2uNetworkThread* NetworkThread;
+	int ListenDescriptor;
+	FRunnableThread* Thread;
+	FThreadSafeCounter StopTaskCounter;
+};
+
+#endif // M2U_WITH_UNIX_SOCKETS
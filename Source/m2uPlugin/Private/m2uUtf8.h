@@ -0,0 +1,214 @@
+#pragma once
+// Streaming UTF-8 conversion for the wire protocol
+
+/**
+ * Decodes UTF-8 into TCHARs incrementally. A multibyte sequence may be split
+ * across calls to Decode (a socket read or the wrap-around of a ring buffer),
+ * the decoder remembers the partial sequence and finishes it with the next
+ * bytes. Malformed input is replaced by U+FFFD instead of failing.
+ */
+class Fm2uUtf8Decoder
+{
+public:
+
+	Fm2uUtf8Decoder()
+		:CodePoint(0),
+		 Remaining(0),
+		 MinCodePoint(0)
+	{}
+
+	void Reset()
+	{
+		CodePoint = 0;
+		Remaining = 0;
+		MinCodePoint = 0;
+	}
+
+	/**
+	 * Decode Num bytes and append the characters to Out. Out should have enough
+	 * slack reserved (at most one TCHAR per byte plus one is needed) to not
+	 * reallocate.
+	 */
+	void Decode( const uint8* Data, int32 Num, TArray<TCHAR>& Out )
+	{
+		const uint8* End = Data + Num;
+		while( Data < End )
+		{
+			// fast path for runs of plain ASCII
+			if( Remaining == 0 )
+			{
+				const uint8* Start = Data;
+				while( Data < End && *Data < 0x80 )
+					++Data;
+				const int32 NumAscii = Data - Start;
+				if( NumAscii > 0 )
+				{
+					const int32 Offset = Out.AddUninitialized(NumAscii);
+					TCHAR* Dest = Out.GetData() + Offset;
+					for( int32 Idx = 0; Idx < NumAscii; ++Idx )
+						Dest[Idx] = (TCHAR)Start[Idx];
+				}
+				if( Data == End )
+					break;
+			}
+
+			const uint8 Byte = *Data++;
+			if( Remaining > 0 )
+			{
+				if( (Byte & 0xC0) == 0x80 )
+				{
+					CodePoint = (CodePoint << 6) | (Byte & 0x3F);
+					if( --Remaining == 0 )
+					{
+						if( CodePoint < MinCodePoint || CodePoint > 0x10FFFF || (CodePoint >= 0xD800 && CodePoint <= 0xDFFF) )
+							CodePoint = 0xFFFD; // overlong or invalid
+						Append( CodePoint, Out );
+					}
+					continue;
+				}
+				// sequence was cut short, then handle this byte as a new start
+				Append( 0xFFFD, Out );
+				Remaining = 0;
+				if( Byte < 0x80 )
+				{
+					Out.Add( (TCHAR)Byte );
+					continue;
+				}
+			}
+
+			if( (Byte & 0xE0) == 0xC0 )
+			{
+				CodePoint = Byte & 0x1F; Remaining = 1; MinCodePoint = 0x80;
+			}
+			else if( (Byte & 0xF0) == 0xE0 )
+			{
+				CodePoint = Byte & 0x0F; Remaining = 2; MinCodePoint = 0x800;
+			}
+			else if( (Byte & 0xF8) == 0xF0 )
+			{
+				CodePoint = Byte & 0x07; Remaining = 3; MinCodePoint = 0x10000;
+			}
+			else
+			{
+				Append( 0xFFFD, Out ); // stray continuation or invalid lead byte
+			}
+		}
+	}
+
+	/** finish the input, a dangling partial sequence becomes U+FFFD */
+	void Flush( TArray<TCHAR>& Out )
+	{
+		if( Remaining > 0 )
+		{
+			Append( 0xFFFD, Out );
+			Remaining = 0;
+		}
+	}
+
+private:
+
+	static void Append( uint32 Code, TArray<TCHAR>& Out )
+	{
+		if( sizeof(TCHAR) >= 4 || Code < 0x10000 )
+		{
+			Out.Add( (TCHAR)Code );
+		}
+		else
+		{
+			// UTF-16 surrogate pair
+			Code -= 0x10000;
+			Out.Add( (TCHAR)(0xD800 + (Code >> 10)) );
+			Out.Add( (TCHAR)(0xDC00 + (Code & 0x3FF)) );
+		}
+	}
+
+	uint32 CodePoint;
+	int32 Remaining;
+	uint32 MinCodePoint;
+};
+
+
+namespace m2uUtf8
+{
+	/** decode a complete UTF-8 buffer into Out, replacing its contents */
+	inline void DecodeToString( const uint8* Data, int32 Num, FString& Out )
+	{
+		TArray<TCHAR>& Chars = Out.GetCharArray();
+		Chars.Reset();
+		if( Num <= 0 )
+			return;
+		Chars.Reserve( Num + 1 );
+		Fm2uUtf8Decoder Decoder;
+		Decoder.Decode( Data, Num, Chars );
+		Decoder.Flush( Chars );
+		Chars.Add( '\0' );
+	}
+
+	/** read one code point from TCHARs, combining UTF-16 surrogate pairs */
+	inline uint32 NextCodePoint( const TCHAR*& Str, const TCHAR* End )
+	{
+		uint32 Code = (uint32)*Str++;
+		if( sizeof(TCHAR) == 2 && Code >= 0xD800 && Code <= 0xDBFF && Str < End )
+		{
+			const uint32 Low = (uint32)*Str;
+			if( Low >= 0xDC00 && Low <= 0xDFFF )
+			{
+				++Str;
+				Code = 0x10000 + ((Code - 0xD800) << 10) + (Low - 0xDC00);
+			}
+		}
+		if( (Code >= 0xD800 && Code <= 0xDFFF) || Code > 0x10FFFF )
+			Code = 0xFFFD; // lone surrogate
+		return Code;
+	}
+
+	/** the number of bytes Encode will produce */
+	inline int32 EncodedLength( const TCHAR* Str, int32 Len )
+	{
+		const TCHAR* End = Str + Len;
+		int32 Length = 0;
+		while( Str < End )
+		{
+			const uint32 Code = NextCodePoint( Str, End );
+			Length += (Code < 0x80) ? 1 : (Code < 0x800) ? 2 : (Code < 0x10000) ? 3 : 4;
+		}
+		return Length;
+	}
+
+	/**
+	 * Encode Len TCHARs as UTF-8 into Dest, which must hold EncodedLength bytes.
+	 * @return the number of bytes written
+	 */
+	inline int32 Encode( const TCHAR* Str, int32 Len, uint8* Dest )
+	{
+		const TCHAR* End = Str + Len;
+		uint8* Start = Dest;
+		while( Str < End )
+		{
+			const uint32 Code = NextCodePoint( Str, End );
+			if( Code < 0x80 )
+			{
+				*Dest++ = (uint8)Code;
+			}
+			else if( Code < 0x800 )
+			{
+				*Dest++ = (uint8)(0xC0 | (Code >> 6));
+				*Dest++ = (uint8)(0x80 | (Code & 0x3F));
+			}
+			else if( Code < 0x10000 )
+			{
+				*Dest++ = (uint8)(0xE0 | (Code >> 12));
+				*Dest++ = (uint8)(0x80 | ((Code >> 6) & 0x3F));
+				*Dest++ = (uint8)(0x80 | (Code & 0x3F));
+			}
+			else
+			{
+				*Dest++ = (uint8)(0xF0 | (Code >> 18));
+				*Dest++ = (uint8)(0x80 | ((Code >> 12) & 0x3F));
+				*Dest++ = (uint8)(0x80 | ((Code >> 6) & 0x3F));
+				*Dest++ = (uint8)(0x80 | (Code & 0x3F));
+			}
+		}
+		return Dest - Start;
+	}
+}
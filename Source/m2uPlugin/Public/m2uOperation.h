@@ -1,6 +1,37 @@
 
 #pragma once
 
+#include "m2uCoreKeywordTable.h"
+#include "m2uCoreTokenizer.h"
+
+// the tokens of a command, see m2uCoreTokenizer.h
+typedef Tm2uTokenTable<TCHAR> Fm2uTokenTable;
+// the items of a "[name1,name2]" list, see m2uCoreParse.h
+typedef Tm2uListParser<TCHAR> Fm2uListParser;
+
+/**
+ * A long-running command that was started by an Operation. It is not run in one
+ * go but advanced by calling Step once in a while on the game thread, so other
+ * commands can be executed in between. Every Step should only do a small
+ * amount of work, like importing one file.
+ */
+class Fm2uAsyncTask
+{
+public:
+
+	virtual ~Fm2uAsyncTask() {}
+
+	/**
+	 * Do the next part of the work. Return true when everything is done, Result
+	 * is the answer for the client then.
+	 */
+	virtual bool Step( FString& Result ) = 0;
+
+	/** how much of the work is done, from 0 to 1 */
+	virtual float GetProgress() const = 0;
+};
+
+
 /**
  * Base class for all executable operations of m2u in UE4
  */
@@ -9,30 +40,95 @@ class Fm2uOperation
 protected:
 
 	Fm2uOperationManager* Manager;
+	// the first words of the commands this handles
+	TArray<FString> Keywords;
 
 public:
 
-	Fm2uOperation( Fm2uOperationManager* Manager = NULL );
+	/**
+	 * Keywords are the commands the Operation handles, like "TransformObject".
+	 * The Manager only asks the Operation for commands starting with one of
+	 * them. An Operation without keywords is asked for every command no other
+	 * one took.
+	 */
+	Fm2uOperation( Fm2uOperationManager* Manager = NULL, const TArray<FString>& InKeywords = TArray<FString>() );
 	virtual ~Fm2uOperation();
 
+	const TArray<FString>& GetKeywords() const
+	{
+		return Keywords;
+	}
+
 	/**
 	 * Try to execute the command. Return false early if not able to execute.
+	 * Cmd is only valid during the call, parse names into TCHAR buffers with
+	 * FParse::Token and only create FStrings or FNames where an API needs them.
+	 */
+	virtual bool Execute( const TCHAR* Cmd, FString& Result ) = 0;
+
+	/**
+	 * Execute the command the Manager already split into tokens, the first
+	 * one is the keyword. Operations on the hot path override this to read
+	 * names and values straight from the tokens instead of searching the text
+	 * again, the others just get the text.
+	 */
+	virtual bool ExecuteTokens( const Fm2uTokenTable& Tokens, FString& Result )
+	{
+		return Execute(Tokens.GetText(), Result);
+	}
+
+	/**
+	 * Whether ExecuteTokens reads more than the keyword token for commands
+	 * with this Keyword. If not, the Manager doesn't split the rest of the
+	 * text, a batch command can then do the only pass over its lines.
+	 */
+	virtual bool NeedsAllTokens( const Tm2uTextView<TCHAR>& Keyword ) const
+	{
+		return true;
+	}
+
+	/**
+	 * Try to execute a command that came with binary data, see
+	 * M2U_FRAME_FLAG_BINARY. Cmd is only the text in front of the data. Return
+	 * false if not able to, most Operations only take text.
+	 */
+	virtual bool ExecuteBinary( const TCHAR* Cmd, const uint8* Data, int32 Num, FString& Result )
+	{
+		return false;
+	}
+
+	/**
+	 * Try to start the command as a long-running task. Return NULL if not able
+	 * to, Execute will be used for the command then. Only Operations with
+	 * commands that may take seconds need to implement this.
 	 */
-	virtual bool Execute( FString Cmd, FString& Result ) = 0;
+	virtual Fm2uAsyncTask* ExecuteAsync( const TCHAR* Cmd )
+	{
+		return NULL;
+	}
 };
 
 
 /**
  * The Manager holds all instances of available operations and decides which one
  * to use for operating on a certain command.
- * Every Operation has to register one instance in the Manager. The last registered
- * Operation will be the first to be asked to execute a command.
+ * Every Operation has to register one instance in the Manager. The first word
+ * of a command is looked up in a table of the keywords the Operations declared,
+ * so only the Operation for that command is asked to execute it. If several
+ * declare the same keyword, the last registered one wins. Operations without
+ * keywords are asked in turn, the last registered first.
  */
 class Fm2uOperationManager
 {
 protected:
 
 	TArray<Fm2uOperation*> RegisteredOperations;
+	// compared like FParse::Command does, ignoring case
+	Tm2uKeywordTable<Fm2uOperation*> OperationsByKeyword;
+	TArray<Fm2uOperation*> UnindexedOperations;
+
+	/** the Operation declaring the first word of Cmd as keyword, or NULL */
+	Fm2uOperation* FindOperation( const TCHAR* Cmd ) const;
 
 public:
 
@@ -44,7 +140,28 @@ public:
 
 	/**
 	 * let the first able of the registered Operations handle the Cmd string */
-	FString Execute( FString Cmd );
+	FString Execute( const TCHAR* Cmd );
+
+	/**
+	 * let the Operation of the keyword of Cmd handle the command with the binary
+	 * Data */
+	FString ExecuteBinary( const TCHAR* Cmd, const TArray<uint8>& Data );
+
+	/**
+	 * let the first able of the registered Operations start the Cmd string as
+	 * a long-running task. Returns NULL if none can, the caller owns the task. */
+	Fm2uAsyncTask* ExecuteAsync( const TCHAR* Cmd );
+
+	/**
+	 * the FName of the first word of Cmd, NAME_None if that can't be the
+	 * keyword of any Operation */
+	static FName GetKeyword( const TCHAR* Cmd );
+
+	/**
+	 * measure the time it takes to find the Operation for every keyword and an
+	 * unknown command, through the keyword table and by comparing the keywords
+	 * one after the other like the Operations themselves do */
+	void BenchmarkDispatch( int32 Iterations, FOutputDevice& Ar ) const;
 };
 
 // TODO: i want the operations to be able to internally ask for further input
@@ -1,5 +1,7 @@
 // Copyright 1998-2014 Epic Games, Inc. All Rights Reserved.
 
+using System.IO;
+
 namespace UnrealBuildTool.Rules
 {
 	public class m2uPlugin : ModuleRules
@@ -12,6 +14,8 @@ namespace UnrealBuildTool.Rules
 					"Developer/AssetTools/Public",
 					"Editor/UnrealEd/Public",
 					"Editor/UnrealEd/Classes",					  
+					// the engine independent core, header only
+					Path.Combine(ModuleDirectory, "../m2uCore"),
 					// ... add public include paths required here ...
 				}
 				);